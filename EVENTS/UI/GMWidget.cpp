@@ -37,6 +37,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 // Written by: Stevan Gavrilovic, Frank McKenna
 
 #include "CSVReaderWriter.h"
+#include "CSVTable.h"
 #include "GMPEWidget.h"
 #include "GMWidget.h"
 #include "GmAppConfig.h"
@@ -90,6 +91,8 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QStringList>
 #include <QString>
 
+#include <cmath>
+
 using namespace Esri::ArcGISRuntime;
 
 GMWidget::GMWidget(QWidget *parent, VisualizationWidget* visWidget) : SimCenterAppWidget(parent), theVisualizationWidget(visWidget)
@@ -862,20 +865,31 @@ int GMWidget::processDownloadedRecords(QString& errorMessage)
 
     QString fileName = inputFile.fileName();
 
-    CSVReaderWriter csvTool;
+    CSVTable stationsTable;
+
+    // The station file names are kept as strings even if they look like numbers
+    stationsTable.setColumnType("GP_file", CSVColumn::Text);
+    stationsTable.setColumnType("Longitude", CSVColumn::Double);
+    stationsTable.setColumnType("Latitude", CSVColumn::Double);
 
     QString err;
-    QVector<QStringList> data = csvTool.parseCSVFile(pathToOutputDirectory,err);
+    auto res = stationsTable.load(pathToOutputDirectory,err);
 
-    if(!err.isEmpty())
+    if(res != 0)
     {
         errorMessage = err;
         return -1;
     }
 
-    if(data.empty())
+    if(stationsTable.numRows() == 0)
         return -1;
 
+    if(stationsTable.numColumns() < 3)
+    {
+        errorMessage = "Error in importing ground motions, the file " + pathToOutputDirectory + " should have at least 3 columns";
+        return -1;
+    }
+
 
     QApplication::processEvents();
 
@@ -912,11 +926,9 @@ int GMWidget::processDownloadedRecords(QString& errorMessage)
     // Set the scale at which the layer will become visible - if scale is too high, then the entire view will be filled with symbols
     // gridLayer->setMinScale(80000);
 
-    auto headers = data.front();
-
-    auto indexFile = headers.indexOf("GP_file");
-    auto indexLon = headers.indexOf("Longitude");
-    auto indexLat = headers.indexOf("Latitude");
+    auto indexFile = stationsTable.columnIndex("GP_file");
+    auto indexLon = stationsTable.columnIndex("Longitude");
+    auto indexLat = stationsTable.columnIndex("Latitude");
 
     if(indexLon == -1 || indexLat == -1 || indexFile == -1)
     {
@@ -924,42 +936,34 @@ int GMWidget::processDownloadedRecords(QString& errorMessage)
         return -1;
     }
 
-    // Pop off the row that contains the header information
-    data.pop_front();
+    const auto& stationNames = stationsTable.column(indexFile);
+    const auto& longitudes = stationsTable.column(indexLon);
+    const auto& latitudes = stationsTable.column(indexLat);
 
-    auto numRows = data.size();
+    auto numRows = stationsTable.numRows();
 
     // Get the data
     for(int i = 0; i<numRows; ++i)
     {
         this->getProgressDialog()->setProgressBarValue(i+1);
 
-        auto vecValues = data.at(i);
-
-        if(vecValues.size() < 3)
-        {
-            errorMessage = "Error in importing ground motions";
-            return -1;
-        }
-
-        bool ok;
-        auto lon = vecValues[indexLon].toDouble(&ok);
+        auto lon = longitudes.toDouble(i);
 
-        if(!ok)
+        if(std::isnan(lon))
         {
-            errorMessage = "Error converting longitude object " + vecValues[1] + " to a double";
+            errorMessage = "Error, missing the longitude in row " + QString::number(i+2);
             return -1;
         }
 
-        auto lat = vecValues[indexLat].toDouble(&ok);
+        auto lat = latitudes.toDouble(i);
 
-        if(!ok)
+        if(std::isnan(lat))
         {
-            errorMessage = "Error converting latitude object " + vecValues[2] + " to a double";
+            errorMessage = "Error, missing the latitude in row " + QString::number(i+2);
             return -1;
         }
 
-        auto stationName = vecValues[indexFile];
+        auto stationName = stationNames.toString(i);
 
         auto stationPath = inputFile.dir().absolutePath() + QDir::separator() + stationName;
 
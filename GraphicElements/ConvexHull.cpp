@@ -1,10 +1,17 @@
 #include "ConvexHull.h"
+#include "RTree.h"
 #include "SimCenterMapGraphicsView.h"
 
 #include "GeometryEngine.h"
 #include "MultipointBuilder.h"
 #include "MapGraphicsView.h"
+#include "Envelope.h"
 #include "Geometry.h"
+#include "ImmutablePart.h"
+#include "ImmutablePartCollection.h"
+#include "Point.h"
+#include "Polygon.h"
+#include "SpatialReference.h"
 #include "GroupLayer.h"
 #include "Graphic.h"
 #include "Map.h"
@@ -62,6 +69,48 @@ void ConvexHull::getItemsInConvexHull()
     const Geometry normalizedPoints = GeometryEngine::normalizeCentralMeridian(m_inputsGraphic->geometry());
     const Geometry convexHull = GeometryEngine::convexHull(normalizedPoints);
 
+    // Asset selections are resolved synchronously from the spatial index of the asset databases, which is in longitude and latitude
+    bool selected = false;
+
+    if(selectionShape == Rectangle)
+    {
+        const Envelope extent = GeometryEngine::project(normalizedPoints, SpatialReference::wgs84()).extent();
+
+        selected = theVisualizationWidget->selectComponentsInEnvelope(RTreeEnvelope{extent.xMin(), extent.yMin(), extent.xMax(), extent.yMax()});
+    }
+    else if(selectionShape == Radius || convexHull.geometryType() == GeometryType::Polygon)
+    {
+        // The circle is drawn in the projected coordinates of the map, where a degree of longitude is shorter than a degree of latitude
+        // Select with the drawn geometry itself so that the selection matches what is on the map
+        const Geometry selectionGeometry = selectionShape == Radius ? this->getSelectionGeometry() : convexHull;
+
+        if(selectionGeometry.isEmpty())
+        {
+            resetConvexHull();
+            return;
+        }
+
+        const Polygon polygonLatLong(GeometryEngine::project(selectionGeometry, SpatialReference::wgs84()));
+        const auto part = polygonLatLong.parts().part(0);
+
+        QVector<QPointF> polygonPoints;
+        for(int i = 0; i<part.pointCount(); ++i)
+        {
+            const auto point = part.point(i);
+            polygonPoints.append(QPointF(point.x(), point.y()));
+        }
+
+        selected = theVisualizationWidget->selectComponentsInPolygon(polygonPoints);
+    }
+
+    if(selected)
+    {
+        // Clear the graphics
+        resetConvexHull();
+
+        return;
+    }
+
     // Set the envelope of the convex hull as the search parameter
     QueryParameters queryParams;
     auto envelope = Polygon(convexHull);
@@ -146,15 +195,50 @@ void ConvexHull::setSelectingPoints(bool value)
 }
 
 
+void ConvexHull::setSelectionShape(const SelectionShape shape)
+{
+    selectionShape = shape;
+}
+
+
+Geometry ConvexHull::getSelectionGeometry(void) const
+{
+    // normalizing the geometry before performing geometric operations
+    const Geometry normalizedPoints = GeometryEngine::normalizeCentralMeridian(m_inputsGraphic->geometry());
+
+    if(selectionShape == Rectangle)
+        return normalizedPoints.extent();
+
+    if(selectionShape == Radius)
+    {
+        auto points = m_multipointBuilder->points();
+
+        if(points->size() < 2)
+            return Geometry();
+
+        const Point center = points->point(0);
+
+        return GeometryEngine::buffer(center, GeometryEngine::distance(center, points->point(points->size()-1)));
+    }
+
+    return GeometryEngine::convexHull(normalizedPoints);
+}
+
+
 // Convex hull stuff
 void ConvexHull::plotConvexHull()
 {
     if (m_inputsGraphic->geometry().isEmpty())
         return;
 
-    // normalizing the geometry before performing geometric operations
-    const Geometry normalizedPoints = GeometryEngine::normalizeCentralMeridian(m_inputsGraphic->geometry());
-    const Geometry convexHull = GeometryEngine::convexHull(normalizedPoints);
+    const Geometry convexHull = this->getSelectionGeometry();
+
+    // A radius needs a second point
+    if (convexHull.isEmpty())
+    {
+        m_convexHullGraphic->setGeometry(Geometry());
+        return;
+    }
 
     // change the symbol based on the returned geometry type
     if (convexHull.geometryType() == GeometryType::Point)
@@ -165,7 +249,7 @@ void ConvexHull::plotConvexHull()
     {
         m_convexHullGraphic->setSymbol(m_lineSymbol);
     }
-    else if (convexHull.geometryType() == GeometryType::Polygon)
+    else if (convexHull.geometryType() == GeometryType::Polygon || convexHull.geometryType() == GeometryType::Envelope)
     {
         m_convexHullGraphic->setSymbol(m_fillSymbol);
     }
@@ -67,8 +67,13 @@ class ConvexHull : public QObject
 public:
     ConvexHull(VisualizationWidget* visualizationWidget);
 
+    // The shape made from the clicked points: their convex hull, their extent, or a circle centered on the first point that passes through the last point
+    enum SelectionShape {Hull, Rectangle, Radius};
+
     void setupConvexHullObjects();
 
+    void setSelectionShape(const SelectionShape shape);
+
     bool getSelectingPoints() const;
     void setSelectingPoints(bool value);
 
@@ -94,6 +99,10 @@ private:
     Esri::ArcGISRuntime::SimpleFillSymbol* m_fillSymbol = nullptr;
     Esri::ArcGISRuntime::MultipointBuilder* m_multipointBuilder = nullptr;
     bool selectingConvexHull;
+    SelectionShape selectionShape = Hull;
+
+    // Returns the shape to plot from the clicked points in the spatial reference of the map
+    Esri::ArcGISRuntime::Geometry getSelectionGeometry(void) const;
 
     Esri::ArcGISRuntime::Map *mapGIS = nullptr;
     VisualizationWidget* theVisualizationWidget = nullptr;
@@ -54,6 +54,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "FeatureCollectionLayer.h"
 #include "SimpleMarkerSymbol.h"
 #include "SimpleFillSymbol.h"
+#include "SpatialReference.h"
 
 using namespace Esri::ArcGISRuntime;
 
@@ -112,6 +113,22 @@ void PolygonBoundary::getItemsInPolygonBoundary()
     if(polygonGeom.isEmpty())
         return;
 
+    // Asset selections are resolved synchronously from the spatial index of the asset databases, which is in longitude and latitude
+    QVector<QPointF> polygonLatLong;
+    for(auto&& it : *normalizedPoints)
+    {
+        const Point point(GeometryEngine::project(it, SpatialReference::wgs84()));
+        polygonLatLong.append(QPointF(point.x(), point.y()));
+    }
+
+    if(theVisualizationWidget->selectComponentsInPolygon(polygonLatLong))
+    {
+        // Clear the graphics
+        resetPolygonBoundary();
+
+        return;
+    }
+
     // Set the envelope of the convex hull as the search parameter
     QueryParameters queryParams;
     auto envelope = Polygon(polygonGeom);
@@ -0,0 +1,168 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "ComponentSelectionProxyModel.h"
+#include "ComponentDatabase.h"
+
+ComponentSelectionProxyModel::ComponentSelectionProxyModel(ComponentDatabase* database, QObject *parent) : QAbstractProxyModel(parent), theDatabase(database)
+{
+
+}
+
+
+void ComponentSelectionProxyModel::setSourceModel(QAbstractItemModel *newSourceModel)
+{
+    this->beginResetModel();
+
+    if(this->sourceModel() != nullptr)
+        this->sourceModel()->disconnect(this);
+
+    QAbstractProxyModel::setSourceModel(newSourceModel);
+
+    // The proxy does not keep any state about the rows of the source, so it only has to pass on the changes
+    if(newSourceModel != nullptr)
+    {
+        connect(newSourceModel, &QAbstractItemModel::modelAboutToBeReset, this, &ComponentSelectionProxyModel::beginResetModel);
+        connect(newSourceModel, &QAbstractItemModel::modelReset, this, &ComponentSelectionProxyModel::endResetModel);
+        connect(newSourceModel, &QAbstractItemModel::dataChanged, this, &ComponentSelectionProxyModel::handleSourceDataChanged);
+        connect(newSourceModel, &QAbstractItemModel::headerDataChanged, this, &ComponentSelectionProxyModel::headerDataChanged);
+    }
+
+    this->endResetModel();
+}
+
+
+void ComponentSelectionProxyModel::setSelection(const ComponentSelection& selection)
+{
+    this->beginResetModel();
+
+    this->selection = selection;
+
+    this->endResetModel();
+}
+
+
+void ComponentSelectionProxyModel::clearSelection(void)
+{
+    this->setSelection(ComponentSelection());
+}
+
+
+QModelIndex ComponentSelectionProxyModel::mapToSource(const QModelIndex &proxyIndex) const
+{
+    if (!proxyIndex.isValid() || this->sourceModel() == nullptr)
+        return QModelIndex();
+
+    if(selection.isEmpty())
+        return this->sourceModel()->index(proxyIndex.row(), proxyIndex.column());
+
+    auto ID = selection.at(proxyIndex.row());
+
+    auto row = theDatabase->getRow(ID);
+
+    if(row == -1)
+        return QModelIndex();
+
+    return this->sourceModel()->index(row, proxyIndex.column());
+}
+
+
+QModelIndex ComponentSelectionProxyModel::mapFromSource(const QModelIndex &sourceIndex) const
+{
+    if (!sourceIndex.isValid())
+        return QModelIndex();
+
+    if(selection.isEmpty())
+        return this->index(sourceIndex.row(), sourceIndex.column());
+
+    auto proxyRow = selection.indexOf(theDatabase->getID(sourceIndex.row()));
+
+    if(proxyRow == -1)
+        return QModelIndex();
+
+    return this->index(static_cast<int>(proxyRow), sourceIndex.column());
+}
+
+
+QModelIndex ComponentSelectionProxyModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (!this->hasIndex(row, column, parent))
+        return QModelIndex();
+
+    return this->createIndex(row, column);
+}
+
+
+QModelIndex ComponentSelectionProxyModel::parent(const QModelIndex &/*index*/) const
+{
+    return QModelIndex();
+}
+
+
+int ComponentSelectionProxyModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid() || this->sourceModel() == nullptr)
+        return 0;
+
+    if(selection.isEmpty())
+        return this->sourceModel()->rowCount();
+
+    return static_cast<int>(selection.size());
+}
+
+
+int ComponentSelectionProxyModel::columnCount(const QModelIndex &parent) const
+{
+    if (parent.isValid() || this->sourceModel() == nullptr)
+        return 0;
+
+    return this->sourceModel()->columnCount();
+}
+
+
+void ComponentSelectionProxyModel::handleSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles)
+{
+    // The table model changes one cell at a time, when the user edits it
+    auto proxyTopLeft = this->mapFromSource(topLeft);
+    auto proxyBottomRight = this->mapFromSource(bottomRight);
+
+    if(!proxyTopLeft.isValid() || !proxyBottomRight.isValid())
+        return;
+
+    emit dataChanged(proxyTopLeft, proxyBottomRight, roles);
+}
@@ -0,0 +1,164 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "ComponentTableModel.h"
+#include "ComponentDatabase.h"
+
+ComponentTableModel::ComponentTableModel(ComponentDatabase* database, QObject *parent) : QAbstractTableModel(parent), theDatabase(database)
+{
+    numRows = 0;
+}
+
+
+QVariant ComponentTableModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid())
+        return QVariant();
+
+    if (role != Qt::DisplayRole && role != Qt::EditRole)
+        return QVariant();
+
+    // Give the text to the view, so that numbers are shown in full and edited as text
+    return ComponentDatabase::toText(this->getValue(index.row(), index.column()));
+}
+
+
+Qt::ItemFlags ComponentTableModel::flags(const QModelIndex &index) const
+{
+    if (!index.isValid())
+        return Qt::NoItemFlags;
+
+    if(index.column() < numLockedColumns)
+        return Qt::ItemIsSelectable;
+
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsEditable;
+}
+
+
+QVariant ComponentTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole && section >= 0 && section < headings.size())
+        return headings.at(section);
+
+    return QVariant();
+}
+
+
+int ComponentTableModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+
+    return numRows;
+}
+
+
+int ComponentTableModel::columnCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+
+    return headings.size();
+}
+
+
+bool ComponentTableModel::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+    if (!index.isValid() || role != Qt::EditRole || index.column() < numLockedColumns)
+        return false;
+
+    auto component = theDatabase->getComponentAtRow(index.row());
+
+    if(component.setAttributeValue(headings.at(index.column()), value) != 0)
+        return false;
+
+    emit dataChanged(index, index, {Qt::DisplayRole, Qt::EditRole});
+
+    return true;
+}
+
+
+void ComponentTableModel::setHeadings(const QStringList& headings)
+{
+    this->beginResetModel();
+
+    this->headings = headings;
+
+    attributeIndexes.fill(-1, headings.size());
+    for(int j = 1; j<headings.size(); ++j)
+        attributeIndexes[j] = theDatabase->getAttributeIndex(headings.at(j));
+
+    numRows = theDatabase->getNumberOfComponents();
+
+    this->endResetModel();
+}
+
+
+QStringList ComponentTableModel::getHeadings(void) const
+{
+    return headings;
+}
+
+
+QVariant ComponentTableModel::getValue(const int row, const int column) const
+{
+    if(row < 0 || row >= numRows || column < 0 || column >= headings.size())
+        return QVariant();
+
+    if(column == 0)
+        return theDatabase->getID(row);
+
+    auto attribute = attributeIndexes.at(column);
+
+    if(attribute == -1)
+        return QVariant();
+
+    return theDatabase->getAttributeValue(row, attribute);
+}
+
+
+void ComponentTableModel::clear(void)
+{
+    this->beginResetModel();
+
+    headings.clear();
+    attributeIndexes.clear();
+    numRows = 0;
+
+    this->endResetModel();
+}
@@ -0,0 +1,96 @@
+#ifndef ComponentTableModel_H
+#define ComponentTableModel_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include <QAbstractTableModel>
+#include <QStringList>
+#include <QVector>
+
+class ComponentDatabase;
+
+// Table model that shows the components directly from the component database, no copy of the table is made
+// The first column is the component ID, the other columns are attributes in the database; a cell is only formatted when the view asks for it
+class ComponentTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit ComponentTableModel(ComponentDatabase* database, QObject *parent = nullptr);
+
+    QVariant data(const QModelIndex &index, int role) const override;
+
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+
+    // Edits are written to the database and to the feature of the component
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
+
+    // Sets the columns of the table and resets the model, call once the components are in the database
+    // The first heading is the ID column, the other headings must be attributes in the database
+    void setHeadings(const QStringList& headings);
+
+    QStringList getHeadings(void) const;
+
+    // Value of the cell, the ID for the first column and the attribute value otherwise
+    QVariant getValue(const int row, const int column) const;
+
+    void clear(void);
+
+private:
+
+    // The ID, latitude, and longitude cannot be changed
+    static const int numLockedColumns = 3;
+
+    ComponentDatabase* theDatabase;
+
+    QStringList headings;
+
+    // Index of the attribute in the database for each column, -1 for the ID column
+    QVector<int> attributeIndexes;
+
+    // The number of rows is fixed when the headings are set, so that the view is not affected by components added afterwards
+    int numRows;
+};
+
+#endif // ComponentTableModel_H
@@ -143,17 +143,34 @@ SOURCES +=  Events/UI/EarthquakeRuptureForecast.cpp \
             GraphicElements/ConvexHull.cpp \
             GraphicElements/PolygonBoundary.cpp \
             ModelViewItems/CheckableTreeModel.cpp \
+            ModelViewItems/ComponentSelectionProxyModel.cpp \
+            ModelViewItems/ComponentTableModel.cpp \
             ModelViewItems/GISLegendView.cpp \
             ModelViewItems/SimCenterTreeView.cpp \
             Tools/AssetInputDelegate.cpp \
+            Tools/ComponentAggregator.cpp \
             Tools/ComponentDatabase.cpp \
+            Tools/ComponentFilter.cpp \
+            Tools/ComponentLoader.cpp \
+            Tools/ComponentSelection.cpp \
+            Tools/CSVIndexCache.cpp \
             Tools/CSVReaderWriter.cpp \
+            Tools/CSVScanner.cpp \
+            Tools/CSVTable.cpp \
+            Tools/CSVTokenizer.cpp \
+            Tools/CSVWriter.cpp \
             Tools/ExampleDownloader.cpp \
+            Tools/FootprintStore.cpp \
+            Tools/GeoJSONReader.cpp \
+            Tools/GeometrySimplifier.cpp \
+            Tools/GzipInputDevice.cpp \
             Tools/HurricanePreprocessor.cpp \
+            Tools/MappedCSVFile.cpp \
             Tools/NGAW2Converter.cpp \
             Tools/NetworkDownloadManager.cpp \
             Tools/PelicunPostProcessor.cpp \
             Tools/REmpiricalProbabilityDistribution.cpp \
+            Tools/RTree.cpp \
             Tools/TablePrinter.cpp \
             Tools/XMLAdaptor.cpp \
             Tools/ShakeMapClient.cpp \
@@ -270,17 +287,34 @@ HEADERS +=  Events/UI/EarthquakeRuptureForecast.h \
             GraphicElements/ConvexHull.h \
             GraphicElements/PolygonBoundary.h \
             ModelViewItems/CheckableTreeModel.h \
+            ModelViewItems/ComponentSelectionProxyModel.h \
+            ModelViewItems/ComponentTableModel.h \
             ModelViewItems/GISLegendView.h \
             ModelViewItems/SimCenterTreeView.h \
             Tools/AssetInputDelegate.h \
+            Tools/ComponentAggregator.h \
             Tools/ComponentDatabase.h \
+            Tools/ComponentFilter.h \
+            Tools/ComponentLoader.h \
+            Tools/ComponentSelection.h \
+            Tools/CSVIndexCache.h \
             Tools/CSVReaderWriter.h \
+            Tools/CSVScanner.h \
+            Tools/CSVTable.h \
+            Tools/CSVTokenizer.h \
+            Tools/CSVWriter.h \
             Tools/ExampleDownloader.h \
+            Tools/FootprintStore.h \
+            Tools/GeoJSONReader.h \
+            Tools/GeometrySimplifier.h \
+            Tools/GzipInputDevice.h \
             Tools/HurricanePreprocessor.h \
+            Tools/MappedCSVFile.h \
             Tools/NGAW2Converter.h \
             Tools/NetworkDownloadManager.h \
             Tools/PelicunPostProcessor.h \
             Tools/REmpiricalProbabilityDistribution.h \
+            Tools/RTree.h \
             Tools/TableNumberItem.h \
             Tools/TablePrinter.h \
             Tools/XMLAdaptor.h \
@@ -378,9 +412,9 @@ RESOURCES += \
 DISTFILES += \
     resources/docs/textAboutR2DT.html
 
-# External libraries
-macos:LIBS += -lcurl -llapack -lblas
-linux:LIBS += /usr/lib/x86_64-linux-gnu/libcurl.so
+# External libraries, zlib is provided by conan on Windows
+macos:LIBS += -lcurl -llapack -lblas -lz
+linux:LIBS += /usr/lib/x86_64-linux-gnu/libcurl.so -lz
 
 # Path to build directory
 win32 {
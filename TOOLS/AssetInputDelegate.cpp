@@ -40,8 +40,6 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 #include <QRegExpValidator>
 
-#include <sstream>
-
 AssetInputDelegate::AssetInputDelegate()
 {
     this->setMaximumWidth(1000);
@@ -58,7 +56,7 @@ AssetInputDelegate::AssetInputDelegate()
 
 int AssetInputDelegate::size()
 {
-    return selectedComponentIDs.size();
+    return static_cast<int>(selectedComponentIDs.size());
 }
 
 
@@ -69,7 +67,16 @@ void AssetInputDelegate::clear()
 }
 
 
-void AssetInputDelegate::insertSelectedCompoonent(const int id)
+void AssetInputDelegate::setSelectedComponentIDs(const ComponentSelection& selection)
+{
+    selectedComponentIDs = selection;
+
+    // Reset the text on the line edit
+    this->setText(this->getComponentAnalysisList());
+}
+
+
+void AssetInputDelegate::insertSelectedCompoonent(const qint64 id)
 {
     selectedComponentIDs.insert(id);
 
@@ -78,6 +85,15 @@ void AssetInputDelegate::insertSelectedCompoonent(const int id)
 }
 
 
+void AssetInputDelegate::insertSelectedComponents(const std::vector<qint64>& ids)
+{
+    selectedComponentIDs.insert(ids);
+
+    // Reset the text on the line edit
+    this->setText(this->getComponentAnalysisList());
+}
+
+
 void AssetInputDelegate::selectComponents()
 {
     auto inputText = this->text();
@@ -86,61 +102,10 @@ void AssetInputDelegate::selectComponents()
     if(inputText.isEmpty())
         return;
 
-    // Remove any white space from the string
-    inputText.remove(" ");
-
-    // Split the incoming text into the parts delimited by commas
-    std::vector<std::string> subStringVec;
-
-    // Create string stream from the string
-    std::stringstream s_stream(inputText.toStdString());
-
-    // Split the input string to substrings at the comma
-    while(s_stream.good()) {
-        std:: string subString;
-        getline(s_stream, subString, ',');
-
-        if(!subString.empty())
-            subStringVec.push_back(subString);
-    }
-
-
-    // Check for the case where the IDs are given as a range
-    std::string dashDelim = "-";
-
-    for(auto&& subStr : subStringVec)
-    {
-        // Handle the case where there is a range of assets separated by a '-'
-        if (subStr.find(dashDelim) != std::string::npos)
-        {
-            auto pos = subStr.find(dashDelim);
-            // Get the strings on either side of the '-' character
-            std::string intStart = subStr.substr(0, pos);
-            std::string intEnd = subStr.substr(pos + dashDelim.length());
-
-            // Convert them into integers
-            auto IDStart = std::stoi(intStart);
-            auto IDEnd = std::stoi(intEnd);
-
-            // Make sure that the end integer is greater than the first
-            if(IDStart>IDEnd)
-            {
-                QString err = "Error in the range of asset IDs provided in the Component asset selection box";
-                throw err;
-                continue;
-            }
-
-            // Add the IDs to the set
-            for(int ID = IDStart; ID<=IDEnd; ++ID)
-                selectedComponentIDs.insert(ID);
-        }
-        else // Asset ID is given individually
-        {
-            auto ID = std::stoi(subStr);
-
-            selectedComponentIDs.insert(ID);
-        }
-    }
+    // The IDs and ranges of IDs are added to the selection as ranges, without expanding them
+    QString err;
+    if(ComponentSelection::fromString(inputText, selectedComponentIDs, err) != 0)
+        throw err;
 
     // Reset the text on the line edit
     this->setText(this->getComponentAnalysisList());
@@ -149,7 +114,7 @@ void AssetInputDelegate::selectComponents()
 }
 
 
-std::set<int> AssetInputDelegate::getSelectedComponentIDs() const
+const ComponentSelection& AssetInputDelegate::getSelectedComponentIDs() const
 {
     return selectedComponentIDs;
 }
@@ -157,32 +122,5 @@ std::set<int> AssetInputDelegate::getSelectedComponentIDs() const
 
 QString AssetInputDelegate::getComponentAnalysisList()
 {
-    QString stringList;
-
-    std::set<int>::iterator it;
-    for (it = selectedComponentIDs.begin(); it != selectedComponentIDs.end(); ++it)
-    {
-        int first = *it;
-        int next = *it;
-        while(std::next(it, 1) != selectedComponentIDs.end() && *std::next(it, 1) == *it +1 )
-        {
-            next = *std::next(it, 1);
-            ++it;
-        }
-
-        if(next == first)
-        {
-            stringList.append(QString::number(*it)+",");
-        }
-        else
-        {
-            stringList.append(QString::number(first)+"-"+QString::number(next)+",");
-        }
-    }
-
-    // Remove the last comma
-    stringList.truncate(stringList.lastIndexOf(QChar(',')));
-
-    return stringList;
+    return selectedComponentIDs.toString();
 }
-
@@ -38,9 +38,11 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 // Written by: Stevan Gavrilovic
 
+#include "ComponentSelection.h"
+
 #include <QLineEdit>
 
-#include <set>
+#include <vector>
 
 class AssetInputDelegate : public QLineEdit
 {
@@ -49,9 +51,15 @@ class AssetInputDelegate : public QLineEdit
 public:
     AssetInputDelegate();
 
-    std::set<int> getSelectedComponentIDs() const;
+    const ComponentSelection& getSelectedComponentIDs() const;
+
+    // Replaces the selected components
+    void setSelectedComponentIDs(const ComponentSelection& selection);
+
+    void insertSelectedCompoonent(const qint64 id);
 
-    void insertSelectedCompoonent(const int id);
+    // Inserts many components at once, the text is only updated once at the end
+    void insertSelectedComponents(const std::vector<qint64>& ids);
 
     void clear();
 
@@ -68,7 +76,7 @@ signals:
 
 private:
 
-    std::set<int> selectedComponentIDs;
+    ComponentSelection selectedComponentIDs;
 };
 
 #endif // ASSETINPUTDELEGATE_H
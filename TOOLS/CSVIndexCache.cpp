@@ -0,0 +1,331 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "CSVIndexCache.h"
+#include "SimCenterPreferences.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include <cstring>
+
+namespace {
+
+const char cacheMagic[8] = {'R','2','D','C','S','V','I','X'};
+
+// Increment when the layout of the cache changes
+const quint32 cacheVersion = 1;
+
+struct CacheHeader
+{
+    char magic[8];
+    quint32 version;
+    quint32 pathLength;
+
+    // Key of the CSV file
+    qint64 fileSize;
+    qint64 lastModified;
+    quint64 contentHash;
+
+    qint64 numRows;
+    qint64 numFields;
+};
+
+// The header is followed by the path of the CSV file, padded so that the arrays of the index are aligned to 8 bytes
+qint64 alignTo8(const qint64 numBytes)
+{
+    return (numBytes + 7) & ~qint64(7);
+}
+
+
+// Expected size of a cache with the given contents. The arrays are the row starts, row ends, row field index (numRows+1 entries), and field offsets
+qint64 cacheSize(const qint64 pathLength, const qint64 numRows, const qint64 numFields)
+{
+    return qint64(sizeof(CacheHeader)) + alignTo8(pathLength) + 8*(3*numRows + 1) + 4*numFields;
+}
+
+}
+
+
+CSVIndexCache::CSVIndexCache()
+{
+    mappedData = nullptr;
+    indexOffset = 0;
+    nRows = 0;
+    nFields = 0;
+}
+
+
+CSVIndexCache::~CSVIndexCache()
+{
+    this->close();
+}
+
+
+bool CSVIndexCache::load(const QString& pathToFile, const char* data, const qint64 size)
+{
+    this->close();
+
+    QFileInfo fileInfo(pathToFile);
+
+    auto canonicalPath = fileInfo.canonicalFilePath().toUtf8();
+
+    if(canonicalPath.isEmpty())
+        return false;
+
+    auto lastModified = fileInfo.lastModified().toMSecsSinceEpoch();
+
+    // Only hash the contents if the rest of the key matches
+    quint64 hash = 0;
+    bool hashComputed = false;
+
+    for(auto&& cachePath : cachePaths(pathToFile))
+    {
+        file.setFileName(cachePath);
+
+        if(!file.open(QIODevice::ReadOnly))
+            continue;
+
+        auto cacheFileSize = file.size();
+
+        const uchar* cacheData = cacheFileSize >= qint64(sizeof(CacheHeader)) ? file.map(0, cacheFileSize) : nullptr;
+
+        if(cacheData == nullptr)
+        {
+            file.close();
+            continue;
+        }
+
+        CacheHeader header;
+        std::memcpy(&header, cacheData, sizeof(CacheHeader));
+
+        bool isValid = std::memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) == 0 &&
+                header.version == cacheVersion &&
+                header.fileSize == size &&
+                header.lastModified == lastModified &&
+                header.numRows >= 0 && header.numFields >= 0 &&
+                header.pathLength == quint32(canonicalPath.size()) &&
+                cacheFileSize == cacheSize(header.pathLength, header.numRows, header.numFields) &&
+                std::memcmp(cacheData + sizeof(CacheHeader), canonicalPath.constData(), header.pathLength) == 0;
+
+        if(isValid)
+        {
+            if(!hashComputed)
+            {
+                hash = contentHash(data, size);
+                hashComputed = true;
+            }
+
+            isValid = header.contentHash == hash;
+        }
+
+        // Closing the file also removes the memory mapping
+        if(!isValid)
+        {
+            file.close();
+            continue;
+        }
+
+        mappedData = cacheData;
+        indexOffset = qint64(sizeof(CacheHeader)) + alignTo8(header.pathLength);
+        nRows = header.numRows;
+        nFields = header.numFields;
+
+        return true;
+    }
+
+    return false;
+}
+
+
+bool CSVIndexCache::save(const QString& pathToFile, const char* data, const qint64 size, const qint64 numRows, const qint64* rowStarts, const qint64* rowEnds, const qint64* rowFieldIndex, const quint32* fieldOffsets)
+{
+    QFileInfo fileInfo(pathToFile);
+
+    auto canonicalPath = fileInfo.canonicalFilePath().toUtf8();
+
+    if(canonicalPath.isEmpty())
+        return false;
+
+    CacheHeader header;
+    std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+    header.version = cacheVersion;
+    header.pathLength = quint32(canonicalPath.size());
+    header.fileSize = size;
+    header.lastModified = fileInfo.lastModified().toMSecsSinceEpoch();
+    header.contentHash = contentHash(data, size);
+    header.numRows = numRows;
+    header.numFields = rowFieldIndex[numRows];
+
+    const QByteArray padding(int(alignTo8(header.pathLength) - header.pathLength), '\0');
+
+    for(auto&& cachePath : cachePaths(pathToFile))
+    {
+        QDir().mkpath(QFileInfo(cachePath).absolutePath());
+
+        // The cache only replaces an existing cache once it is written in full
+        QSaveFile cacheFile(cachePath);
+
+        if(!cacheFile.open(QIODevice::WriteOnly))
+            continue;
+
+        auto writeBytes = [&cacheFile](const void* bytes, const qint64 numBytes)
+        {
+            return cacheFile.write(reinterpret_cast<const char*>(bytes), numBytes) == numBytes;
+        };
+
+        bool OK = writeBytes(&header, sizeof(CacheHeader)) &&
+                writeBytes(canonicalPath.constData(), canonicalPath.size()) &&
+                writeBytes(padding.constData(), padding.size()) &&
+                writeBytes(rowStarts, 8*numRows) &&
+                writeBytes(rowEnds, 8*numRows) &&
+                writeBytes(rowFieldIndex, 8*(numRows+1)) &&
+                writeBytes(fieldOffsets, 4*header.numFields);
+
+        if(OK && cacheFile.commit())
+            return true;
+
+        cacheFile.cancelWriting();
+    }
+
+    return false;
+}
+
+
+void CSVIndexCache::close(void)
+{
+    mappedData = nullptr;
+    indexOffset = 0;
+    nRows = 0;
+    nFields = 0;
+
+    if(file.isOpen())
+        file.close();
+}
+
+
+qint64 CSVIndexCache::numRows(void) const
+{
+    return nRows;
+}
+
+
+const qint64* CSVIndexCache::rowStarts(void) const
+{
+    return reinterpret_cast<const qint64*>(mappedData + indexOffset);
+}
+
+
+const qint64* CSVIndexCache::rowEnds(void) const
+{
+    return this->rowStarts() + nRows;
+}
+
+
+const qint64* CSVIndexCache::rowFieldIndex(void) const
+{
+    return this->rowEnds() + nRows;
+}
+
+
+const quint32* CSVIndexCache::fieldOffsets(void) const
+{
+    return reinterpret_cast<const quint32*>(this->rowFieldIndex() + nRows + 1);
+}
+
+
+QStringList CSVIndexCache::cachePaths(const QString& pathToFile, const QString& extension)
+{
+    QStringList paths;
+
+    QFileInfo fileInfo(pathToFile);
+
+    // Next to the CSV file
+    paths.append(fileInfo.absolutePath() + QDir::separator() + "." + fileInfo.fileName() + "." + extension);
+
+    // In the work directory, named after a hash of the path of the CSV file
+    auto workDir = SimCenterPreferences::getInstance()->getLocalWorkDir();
+
+    if(!workDir.isEmpty())
+    {
+        auto key = QCryptographicHash::hash(fileInfo.canonicalFilePath().toUtf8(), QCryptographicHash::Md5).toHex();
+
+        paths.append(workDir + QDir::separator() + "CSVIndexCache" + QDir::separator() + QString::fromLatin1(key) + "." + extension);
+    }
+
+    return paths;
+}
+
+
+quint64 CSVIndexCache::contentHash(const char* data, const qint64 size)
+{
+    const qint64 blockSize = 4096;
+    const int numBlocks = 64;
+
+    // 64-bit FNV-1a
+    quint64 hash = 14695981039346656037ULL;
+
+    auto addBytes = [&hash](const char* bytes, const qint64 numBytes)
+    {
+        for(qint64 i = 0; i<numBytes; ++i)
+        {
+            hash ^= static_cast<uchar>(bytes[i]);
+            hash *= 1099511628211ULL;
+        }
+    };
+
+    addBytes(reinterpret_cast<const char*>(&size), sizeof(size));
+
+    if(size <= blockSize*numBlocks)
+    {
+        addBytes(data, size);
+        return hash;
+    }
+
+    // Blocks evenly spaced over the file, including the first and last blocks
+    for(int i = 0; i<numBlocks; ++i)
+    {
+        auto offset = (size - blockSize)*i/(numBlocks-1);
+        addBytes(data + offset, blockSize);
+    }
+
+    return hash;
+}
@@ -0,0 +1,94 @@
+#ifndef CSVINDEXCACHE_H
+#define CSVINDEXCACHE_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+
+// Written by: Stevan Gavrilovic
+
+#include <QFile>
+#include <QString>
+#include <QStringList>
+
+// Binary cache of the row and field index of a CSV file, so that a file that was opened before does not have to be tokenized again
+// The cache is written next to the CSV file, or in the local work directory if that location is not writable. It is memory-mapped when loaded
+// A cache is only used if the path, size, modification time, and a content hash of the CSV file match the values stored in the cache, so a cache is invalidated automatically when the file changes
+class CSVIndexCache
+{
+public:
+    CSVIndexCache();
+    ~CSVIndexCache();
+
+    // Maps the cache of the given CSV file, where data and size are the contents of the CSV file. Returns true if an up to date cache was found
+    bool load(const QString& pathToFile, const char* data, const qint64 size);
+
+    // Writes the index of the given CSV file to the cache, returns true on success
+    static bool save(const QString& pathToFile, const char* data, const qint64 size, const qint64 numRows, const qint64* rowStarts, const qint64* rowEnds, const qint64* rowFieldIndex, const quint32* fieldOffsets);
+
+    void close(void);
+
+    // The index stored in the cache, valid until the cache is closed
+    qint64 numRows(void) const;
+    const qint64* rowStarts(void) const;
+    const qint64* rowEnds(void) const;
+    const qint64* rowFieldIndex(void) const;
+    const quint32* fieldOffsets(void) const;
+
+    // Smallest CSV file that is worth caching, smaller files are tokenized faster than the cache can be checked
+    static const qint64 minFileSize = 8*1024*1024;
+
+    // Possible locations of a cache for the given CSV file, in the order that they are tried. The extension tells apart the caches of the same file
+    static QStringList cachePaths(const QString& pathToFile, const QString& extension = "r2dindex");
+
+    // Hash of a sample of blocks spread over the file, so that the hash does not cost a full pass over a large file
+    static quint64 contentHash(const char* data, const qint64 size);
+
+private:
+
+    Q_DISABLE_COPY(CSVIndexCache)
+
+    QFile file;
+
+    const uchar* mappedData;
+
+    // Position of the first array of the index within the cache
+    qint64 indexOffset;
+
+    qint64 nRows;
+    qint64 nFields;
+};
+
+#endif // CSVINDEXCACHE_H
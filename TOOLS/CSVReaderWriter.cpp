@@ -37,12 +37,17 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 // Written by: Stevan Gavrilovic
 
 #include "CSVReaderWriter.h"
+#include "MappedCSVFile.h"
+#include "CSVTokenizer.h"
+#include "CSVWriter.h"
+#include "GzipInputDevice.h"
 
 #include <QVector>
-#include <QTextStream>
 #include <QStringList>
 #include <QFile>
 
+#include <cstring>
+
 CSVReaderWriter::CSVReaderWriter()
 {
 
@@ -68,55 +73,25 @@ int CSVReaderWriter::saveCSVFile(const QVector<QStringList>& data, const QString
         return -1;
     }
 
+    CSVWriter csvWriter;
+
+    if(csvWriter.open(pathToFile, err) != 0)
+        return -1;
+
     for(auto&& row : data)
     {
+        // Nothing is saved if the number of items is not consistent
         if(row.size() != numCol)
         {
             err = "Inconsistency between the column sizes in the data.";
+            csvWriter.cancel();
             return -1;
         }
-    }
 
-    QFile file(pathToFile);
-
-    if (!file.open(QIODevice::WriteOnly))
-    {
-        err = "Cannot create the file: " + pathToFile + "\n" +"Check your directory and try again.";
-        return -1;
+        csvWriter.writeRow(row);
     }
 
-    QTextStream csvFileOut(&file);
-
-    // Function to handle the case where there are commas within a cell
-    auto strOutput = [](const QString& in)
-    {
-        auto newStr = in;
-
-        newStr = newStr.replace("\"","\"\"");
-
-        if(newStr.contains(','))
-            return "\"" + newStr.toUtf8() + "\"";
-        else
-         return newStr.toUtf8();
-    };
-
-
-    for(auto&& row : data)
-    {
-        for(int i = 0; i<numCol; ++i)
-        {
-            csvFileOut<<strOutput(row[i]);
-
-            // Add the terminating character
-            if(i != numCol-1)
-                csvFileOut<<",";
-            else
-                csvFileOut<<"\n";
-        }
-    }
-
-
-    return 0;
+    return csvWriter.close(err);
 }
 
 
@@ -124,23 +99,12 @@ QVector<QStringList> CSVReaderWriter::parseCSVFile(const QString &pathToFile, QS
 {
     QVector<QStringList> returnVec;
 
-    QFile geomFile(pathToFile);
+    MappedCSVFile csvFile;
 
-    if (!geomFile.open(QIODevice::ReadOnly))
-    {
-        err = "Cannot find the file: " + pathToFile + "\nCheck your directory and try again.";
+    if(csvFile.open(pathToFile, err) != 0)
         return returnVec;
-    }
-
-    QStringList rowLines;
-    while (!geomFile.atEnd())
-    {
-        QString line = geomFile.readLine();
 
-        rowLines << line;
-    }
-
-    auto numRows = rowLines.size();
+    auto numRows = csvFile.numRows();
     if(numRows == 0)
     {
         err = "Error in parsing the .csv file " + pathToFile + " in CVSReaderWriter::parseCSVFile";
@@ -149,92 +113,120 @@ QVector<QStringList> CSVReaderWriter::parseCSVFile(const QString &pathToFile, QS
 
     returnVec.reserve(numRows);
 
-    for(auto&& it: rowLines)
+    for(int i = 0; i<numRows; ++i)
+        returnVec.push_back(csvFile.rowStrings(i));
+
+    return returnVec;
+}
+
+
+int CSVReaderWriter::parseCSVFile(const QString &pathToFile, const CSVRowVisitor& visitor, QString& err)
+{
+    // Compressed files are inflated on a separate thread while the rows are parsed
+    if(GzipInputDevice::isCompressed(pathToFile))
     {
-        auto lineStr = this->parseLineCSV(it);
+        GzipInputDevice gzipFile(pathToFile);
+
+        if (!gzipFile.open(QIODevice::ReadOnly))
+        {
+            err = gzipFile.errorString();
+            return -1;
+        }
 
-        returnVec.push_back(lineStr);
+        return this->parseCSVStream(&gzipFile, visitor, err);
     }
 
-    return returnVec;
+    QFile csvFile(pathToFile);
+
+    if (!csvFile.open(QIODevice::ReadOnly))
+    {
+        err = "Cannot find the file: " + pathToFile + "\nCheck your directory and try again.";
+        return -1;
+    }
+
+    return this->parseCSVStream(&csvFile, visitor, err);
 }
 
 
-QStringList CSVReaderWriter::parseLineCSV(const QString &csvString)
+int CSVReaderWriter::parseCSVStream(QIODevice* device, const CSVRowVisitor& visitor, QString& err)
 {
-    QStringList fields;
-    QString value;
+    if(device == nullptr || !device->isOpen())
+    {
+        err = "The device to stream the .csv data from is not open";
+        return -1;
+    }
+
+    // Holds the rows of the current block, plus any partial row left over from the previous block
+    QByteArray buffer;
+    qint64 bufferFill = 0;
+
+    std::vector<quint32> fieldOffsets;
 
-    bool hasQuote = false;
+    int rowNumber = 0;
+    bool atEnd = false;
 
-    for (int i = 0; i < csvString.size(); ++i)
+    while(!atEnd)
     {
-        const QChar current = csvString.at(i);
+        // Grow the buffer if a row does not fit into a block
+        if(buffer.size() - bufferFill < streamBlockSize)
+            buffer.resize(static_cast<int>(bufferFill + streamBlockSize));
 
-        // Normal state
-        if (hasQuote == false)
+        auto numRead = device->read(buffer.data() + bufferFill, streamBlockSize);
+
+        if(numRead < 0)
         {
-            // Comma
-            if (current == ',')
-            {
-                // Save field
-                fields.append(value.trimmed());
-                value.clear();
-            }
+            err = "Error reading the .csv data: " + device->errorString();
+            return -1;
+        }
+
+        // No data is only the end if the device is at its end, a sequential device, e.g., a process, may not have written the next data yet
+        if(numRead == 0)
+        {
+            if(device->waitForReadyRead(streamWaitTimeout))
+                continue;
 
-            // Double-quote
-            else if (current == '"')
+            if(!device->atEnd())
             {
-                hasQuote = true;
-                value += current;
+                err = "Timed out waiting for the .csv data: " + device->errorString();
+                return -1;
             }
 
-            // Other character
-            else
-                value += current;
+            atEnd = true;
         }
-        else if (hasQuote)
+
+        bufferFill += numRead;
+
+        // Hand off all of the complete rows in the buffer
+        qint64 pos = 0;
+        while(true)
         {
-            // Check for another double-quote
-            if (current == '"')
-            {
-                if (i < csvString.size())
-                {
-                    // A double double-quote?
-                    if (i+1 < csvString.size() && csvString.at(i+1) == '"')
-                    {
-                        value += '"';
-
-                        // Skip a second quote character in a row
-                        i++;
-                    }
-                    else
-                    {
-                        hasQuote = false;
-                        value += '"';
-                    }
-                }
-            }
+            fieldOffsets.clear();
 
-            // Other character
-            else
-                value += current;
-        }
-    }
+            auto rowStart = pos;
+            qint64 rowEnd = 0;
 
-    if (!value.isEmpty())
-        fields.append(value.trimmed());
+            if(!CSVTokenizer::nextRow(buffer.constData(), bufferFill, pos, atEnd, fieldOffsets, rowEnd))
+                break;
 
+            CSVRow row(buffer.constData(), rowStart, rowEnd, fieldOffsets.data(), static_cast<int>(fieldOffsets.size()));
 
-    // Remove quotes and whitespace around quotes
-    for (int i=0; i<fields.size(); ++i)
-        if (fields[i].length()>=1 && fields[i].left(1)=='"')
+            if(!visitor(row, rowNumber++))
+                return 0;
+        }
+
+        // Move the partial row to the front of the buffer
+        if(pos > 0)
         {
-            fields[i]=fields[i].mid(1);
-            if (fields[i].length()>=1 && fields[i].right(1)=='"')
-                fields[i]=fields[i].left(fields[i].length()-1);
+            std::memmove(buffer.data(), buffer.constData() + pos, static_cast<size_t>(bufferFill - pos));
+            bufferFill -= pos;
         }
+    }
 
-    return fields;
-}
+    if(rowNumber == 0)
+    {
+        err = "The .csv data is empty";
+        return -1;
+    }
 
+    return 0;
+}
@@ -40,9 +40,17 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 #include <QVector>
 
+#include <functional>
+
+class CSVRow;
+class QIODevice;
 class QString;
 class QStringList;
 
+// Function that is called for each row when streaming a CSV file. The row number is zero-based and includes the header rows.
+// The row is only valid for the duration of the call. Return false to stop reading the file.
+typedef std::function<bool(const CSVRow& row, const int rowNumber)> CSVRowVisitor;
+
 class CSVReaderWriter
 {
 public:
@@ -54,11 +62,24 @@ public:
     // Parses a CSV file and returns the file as a vector of string lists
     // Each item in the vector (string list) corresponds to a row of the csv file that is parsed
     // The string list corresponds to the items within a row, i.e., the values in the cells. There are as many items in the string list as there are in the row of the CSV file
+    // Use MappedCSVFile directly to avoid creating a string for every cell of a large file
     QVector<QStringList> parseCSVFile(const QString &pathToFile, QString& err);
 
+    // Streams a CSV file and hands each row to the visitor as it is read, the file is never held in memory as a whole
+    // Gzip compressed files are inflated as they are read
+    // Only one row is kept at a time, so the memory use does not depend on the size of the file
+    int parseCSVFile(const QString &pathToFile, const CSVRowVisitor& visitor, QString& err);
+
+    // Streams the rows from an open device, e.g., a network reply or a decompressor
+    int parseCSVStream(QIODevice* device, const CSVRowVisitor& visitor, QString& err);
+
 private:
 
-    QStringList parseLineCSV(const QString &csvString);
+    // Number of bytes read from the device at a time when streaming
+    const qint64 streamBlockSize = 4*1024*1024;
+
+    // Milliseconds to wait for more data from a sequential device before giving up
+    const int streamWaitTimeout = 30000;
 
 };
 
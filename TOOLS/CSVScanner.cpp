@@ -0,0 +1,244 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "CSVScanner.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CSV_SCANNER_X86
+#include <immintrin.h>
+
+// SSE2 is part of the x86-64 baseline
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CSV_SCANNER_SSE2
+#endif
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define CSV_SCANNER_AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define CSV_SCANNER_AVX2_TARGET
+#endif
+
+namespace {
+
+#ifndef CSV_SCANNER_SSE2
+void scanBlockScalar(const char* data, CSVBlockMasks& masks)
+{
+    quint64 quotes = 0;
+    quint64 commas = 0;
+    quint64 newlines = 0;
+
+    for(int i = 0; i < CSVScanner::blockSize; ++i)
+    {
+        const quint64 bit = quint64(1) << i;
+
+        switch (data[i])
+        {
+        case '"' : quotes |= bit; break;
+        case ',' : commas |= bit; break;
+        case '\n' : newlines |= bit; break;
+        default: break;
+        }
+    }
+
+    masks.quotes = quotes;
+    masks.commas = commas;
+    masks.newlines = newlines;
+}
+#endif
+
+
+#ifdef CSV_SCANNER_X86
+
+#ifdef CSV_SCANNER_SSE2
+void scanBlockSSE2(const char* data, CSVBlockMasks& masks)
+{
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i newline = _mm_set1_epi8('\n');
+
+    quint64 quotes = 0;
+    quint64 commas = 0;
+    quint64 newlines = 0;
+
+    for(int i = 0; i < CSVScanner::blockSize; i += 16)
+    {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+
+        quotes |= quint64(quint32(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, quote)))) << i;
+        commas |= quint64(quint32(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, comma)))) << i;
+        newlines |= quint64(quint32(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, newline)))) << i;
+    }
+
+    masks.quotes = quotes;
+    masks.commas = commas;
+    masks.newlines = newlines;
+}
+#endif
+
+
+CSV_SCANNER_AVX2_TARGET void scanBlockAVX2(const char* data, CSVBlockMasks& masks)
+{
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i comma = _mm256_set1_epi8(',');
+    const __m256i newline = _mm256_set1_epi8('\n');
+
+    const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+    const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + 32));
+
+    // Low 32 bytes in the lower half of the mask, high 32 bytes in the upper half
+    masks.quotes = quint64(quint32(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, quote)))) | (quint64(quint32(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, quote)))) << 32);
+    masks.commas = quint64(quint32(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, comma)))) | (quint64(quint32(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, comma)))) << 32);
+    masks.newlines = quint64(quint32(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, newline)))) | (quint64(quint32(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, newline)))) << 32);
+}
+
+
+bool cpuSupportsAVX2(void)
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if(info[0] < 7)
+        return false;
+
+    // The OS must save the AVX registers on a context switch
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if(!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+        return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // CSV_SCANNER_X86
+
+
+typedef void (*ScanBlockFunction)(const char*, CSVBlockMasks&);
+
+// Picks the fastest implementation supported by the processor, the choice is made once on first use
+ScanBlockFunction selectScanBlock(const char** name)
+{
+#ifdef CSV_SCANNER_X86
+    if(cpuSupportsAVX2())
+    {
+        *name = "AVX2";
+        return scanBlockAVX2;
+    }
+#endif
+
+#ifdef CSV_SCANNER_SSE2
+    *name = "SSE2";
+    return scanBlockSSE2;
+#else
+    *name = "scalar";
+    return scanBlockScalar;
+#endif
+}
+
+
+struct ScanBlockDispatch
+{
+    ScanBlockDispatch()
+    {
+        function = selectScanBlock(&name);
+    }
+
+    ScanBlockFunction function;
+    const char* name;
+};
+
+
+const ScanBlockDispatch& dispatch(void)
+{
+    static const ScanBlockDispatch instance;
+    return instance;
+}
+
+}
+
+
+void CSVScanner::scanBlock(const char* data, CSVBlockMasks& masks)
+{
+    dispatch().function(data, masks);
+}
+
+
+quint64 CSVScanner::prefixXor(quint64 mask)
+{
+    mask ^= mask << 1;
+    mask ^= mask << 2;
+    mask ^= mask << 4;
+    mask ^= mask << 8;
+    mask ^= mask << 16;
+    mask ^= mask << 32;
+
+    return mask;
+}
+
+
+int CSVScanner::lowestBit(const quint64 mask)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(mask);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return static_cast<int>(index);
+#else
+    int index = 0;
+    while(((mask >> index) & 1) == 0)
+        ++index;
+    return index;
+#endif
+}
+
+
+const char* CSVScanner::instructionSet(void)
+{
+    return dispatch().name;
+}
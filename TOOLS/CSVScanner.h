@@ -0,0 +1,75 @@
+#ifndef CSVSCANNER_H
+#define CSVSCANNER_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+
+// Written by: Stevan Gavrilovic
+
+#include <QtGlobal>
+
+// Bitmasks of the characters of interest within a block of CSVScanner::blockSize bytes, bit i corresponds to byte i of the block
+struct CSVBlockMasks
+{
+    quint64 quotes;
+    quint64 commas;
+    quint64 newlines;
+};
+
+
+// Classifies the bytes of a CSV buffer a block at a time to find the double-quotes, commas, and newlines
+// Uses AVX2 or SSE2 when available on the processor, otherwise falls back to a scalar loop
+class CSVScanner
+{
+public:
+
+    static const int blockSize = 64;
+
+    // Fills the masks for the blockSize bytes beginning at data
+    static void scanBlock(const char* data, CSVBlockMasks& masks);
+
+    // Returns a mask where bit i is set if an odd number of bits at or below position i are set in the given mask
+    // Applied to the quote mask, this gives the bytes that are within a quoted section
+    static quint64 prefixXor(quint64 mask);
+
+    // Index of the lowest set bit, the mask must not be zero
+    static int lowestBit(const quint64 mask);
+
+    // Name of the instruction set used by scanBlock, e.g., for logging
+    static const char* instructionSet(void);
+};
+
+#endif // CSVSCANNER_H
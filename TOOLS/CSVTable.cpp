@@ -0,0 +1,478 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "CSVTable.h"
+#include "CSVTokenizer.h"
+#include "MappedCSVFile.h"
+
+#include <QByteArray>
+#include <QLocale>
+#include <QtConcurrent/QtConcurrentMap>
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+enum class CellType {Empty, Integer, Double, Invalid};
+
+// Maximum number of conversion errors listed per column, and of ragged rows listed per file
+const int maxErrorsPerColumn = 10;
+
+// Parses a number from the raw bytes of a cell, surrounding whitespace is ignored
+CellType parseCell(const char* begin, const char* end, qint64& intValue, double& doubleValue)
+{
+    while(begin != end && std::isspace(static_cast<unsigned char>(*begin)))
+        ++begin;
+
+    while(end != begin && std::isspace(static_cast<unsigned char>(*(end-1))))
+        --end;
+
+    if(begin == end)
+        return CellType::Empty;
+
+    // from_chars does not accept a leading plus sign
+    const char* first = begin;
+    if(*first == '+' && end - first > 1 && first[1] != '-')
+        ++first;
+
+    auto intRes = std::from_chars(first, end, intValue);
+    if(intRes.ec == std::errc() && intRes.ptr == end)
+    {
+        doubleValue = static_cast<double>(intValue);
+        return CellType::Integer;
+    }
+
+#if defined(__cpp_lib_to_chars)
+    auto doubleRes = std::from_chars(first, end, doubleValue);
+    if(doubleRes.ec == std::errc() && doubleRes.ptr == end)
+        return CellType::Double;
+#endif
+
+    // Slow path for the compilers without floating point from_chars and for the values that are out of range
+    bool OK = false;
+    doubleValue = QByteArray::fromRawData(begin, static_cast<int>(end - begin)).toDouble(&OK);
+
+    return OK ? CellType::Double : CellType::Invalid;
+}
+
+}
+
+
+CSVColumn::CSVColumn(const QString& name) : name(name), type(Text)
+{
+
+}
+
+
+QString CSVColumn::getName() const
+{
+    return name;
+}
+
+
+CSVColumn::Type CSVColumn::getType() const
+{
+    return type;
+}
+
+
+bool CSVColumn::isNumeric() const
+{
+    return type != Text;
+}
+
+
+int CSVColumn::size() const
+{
+    switch (type)
+    {
+    case Integer : return static_cast<int>(integers.size());
+    case Double : return static_cast<int>(doubles.size());
+    default : return static_cast<int>(codes.size());
+    }
+}
+
+
+double CSVColumn::toDouble(const int row) const
+{
+    switch (type)
+    {
+    case Integer : return static_cast<double>(integers[row]);
+    case Double : return doubles[row];
+    default : return std::numeric_limits<double>::quiet_NaN();
+    }
+}
+
+
+qint64 CSVColumn::toInt64(const int row) const
+{
+    switch (type)
+    {
+    case Integer : return integers[row];
+    case Double : return std::isfinite(doubles[row]) ? static_cast<qint64>(doubles[row]) : 0;
+    default : return 0;
+    }
+}
+
+
+QString CSVColumn::toString(const int row) const
+{
+    switch (type)
+    {
+    case Integer : return QString::number(integers[row]);
+    case Double : return std::isnan(doubles[row]) ? QString() : QString::number(doubles[row], 'g', QLocale::FloatingPointShortest);
+    default : return dictionary.at(static_cast<int>(codes[row]));
+    }
+}
+
+
+const std::vector<qint64>& CSVColumn::getIntegers() const
+{
+    return integers;
+}
+
+
+const std::vector<double>& CSVColumn::getDoubles() const
+{
+    return doubles;
+}
+
+
+const std::vector<quint32>& CSVColumn::getCodes() const
+{
+    return codes;
+}
+
+
+const QStringList& CSVColumn::getDictionary() const
+{
+    return dictionary;
+}
+
+
+CSVTable::CSVTable()
+{
+    nRows = 0;
+}
+
+
+int CSVTable::load(const QString& pathToFile, QString& err, const int sampleSize)
+{
+    MappedCSVFile csvFile;
+
+    if(csvFile.open(pathToFile, err) != 0)
+        return -1;
+
+    return this->load(csvFile, err, sampleSize);
+}
+
+
+int CSVTable::load(const MappedCSVFile& csvFile, QString& err, const int sampleSize)
+{
+    this->clear();
+
+    if(csvFile.numRows() == 0)
+    {
+        err = "Error in parsing the .csv file " + csvFile.getPathToFile() + " in CSVTable::load";
+        return -1;
+    }
+
+    auto headers = csvFile.rowStrings(0);
+
+    nRows = csvFile.numRows() - 1;
+
+    // Every row has to have a cell for each header, a ragged row is not filled in silently
+    QStringList rowErrors;
+    int numRowErrors = 0;
+
+    for(int i = 0; i<nRows; ++i)
+    {
+        auto numCells = csvFile.row(i+1).size();
+
+        if(numCells == headers.size())
+            continue;
+
+        if(numRowErrors < maxErrorsPerColumn)
+            rowErrors.append("Row " + QString::number(i+2) + " has " + QString::number(numCells) + " columns, the header has " + QString::number(headers.size()) + " columns");
+
+        ++numRowErrors;
+    }
+
+    if(numRowErrors != 0)
+    {
+        if(numRowErrors > maxErrorsPerColumn)
+            rowErrors.append("... and " + QString::number(numRowErrors - maxErrorsPerColumn) + " more rows with the wrong number of columns");
+
+        err = "Error loading the file " + csvFile.getPathToFile() + "\n" + rowErrors.join("\n");
+        nRows = 0;
+        return -1;
+    }
+
+    columns.reserve(headers.size());
+    for(int i = 0; i<headers.size(); ++i)
+    {
+        columns.push_back(CSVColumn(headers.at(i)));
+
+        if(!columnIndexes.contains(headers.at(i)))
+            columnIndexes.insert(headers.at(i), i);
+    }
+
+    // The columns are independent of each other, so convert them in parallel
+    std::vector<int> colIndexes(columns.size());
+    for(size_t i = 0; i<colIndexes.size(); ++i)
+        colIndexes[i] = static_cast<int>(i);
+
+    std::vector<QStringList> colErrors(columns.size());
+
+    QtConcurrent::blockingMap(colIndexes, [&](const int col)
+    {
+        colErrors[col] = this->loadColumn(csvFile, col, sampleSize);
+    });
+
+    QStringList errors;
+    for(auto&& it : colErrors)
+        errors.append(it);
+
+    if(!errors.isEmpty())
+    {
+        err = "Error loading the file " + csvFile.getPathToFile() + "\n" + errors.join("\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+
+QStringList CSVTable::loadColumn(const MappedCSVFile& csvFile, const int col, const int sampleSize)
+{
+    auto& column = columns[col];
+
+    const char* data = csvFile.data();
+
+    QByteArray unquoted;
+
+    // Raw bytes of the cell in the given data row. The quotes are removed from quoted cells, the rows were checked to have a cell in each column
+    auto getCell = [&](const int row, const char*& begin, const char*& end)
+    {
+        auto csvRow = csvFile.row(row+1);
+
+        if(col >= csvRow.size())
+        {
+            begin = end = data;
+        }
+        else if(csvRow.isQuoted(col))
+        {
+            unquoted = csvRow.at(col).toUtf8();
+            begin = unquoted.constData();
+            end = begin + unquoted.size();
+        }
+        else
+        {
+            begin = data + csvRow.fieldOffset(col);
+            end = begin + csvRow.fieldLength(col);
+        }
+    };
+
+    const char* begin = nullptr;
+    const char* end = nullptr;
+    qint64 intValue = 0;
+    double doubleValue = 0.0;
+
+    // Infer the type of the column from the sample
+    bool allIntegers = true;
+    bool hasEmpty = false;
+    bool hasValue = false;
+    bool isNumeric = true;
+
+    const auto numSample = columnTypes.contains(column.name) ? 0 : std::min(sampleSize, nRows);
+    for(int i = 0; i<numSample && isNumeric; ++i)
+    {
+        getCell(i, begin, end);
+
+        switch (parseCell(begin, end, intValue, doubleValue))
+        {
+        case CellType::Empty : hasEmpty = true; break;
+        case CellType::Integer : hasValue = true; break;
+        case CellType::Double : hasValue = true; allIntegers = false; break;
+        case CellType::Invalid : isNumeric = false; break;
+        }
+    }
+
+    if(columnTypes.contains(column.name))
+        column.type = columnTypes.value(column.name);
+    else if(!hasValue || !isNumeric)
+        column.type = CSVColumn::Text;
+    else if(allIntegers && !hasEmpty)
+        column.type = CSVColumn::Integer;
+    else
+        column.type = CSVColumn::Double;
+
+    QStringList errors;
+    int numErrors = 0;
+
+    // Dictionary-encode the text columns
+    if(column.type == CSVColumn::Text)
+    {
+        QHash<QString, quint32> dictionaryIndex;
+
+        column.codes.resize(nRows);
+
+        for(int i = 0; i<nRows; ++i)
+        {
+            auto csvRow = csvFile.row(i+1);
+            auto value = col < csvRow.size() ? csvRow.at(col) : QString();
+
+            auto it = dictionaryIndex.constFind(value);
+            if(it != dictionaryIndex.constEnd())
+            {
+                column.codes[i] = it.value();
+                continue;
+            }
+
+            auto code = static_cast<quint32>(column.dictionary.size());
+
+            dictionaryIndex.insert(value, code);
+            column.dictionary.append(value);
+
+            column.codes[i] = code;
+        }
+
+        return errors;
+    }
+
+    if(column.type == CSVColumn::Integer)
+        column.integers.resize(nRows);
+    else
+        column.doubles.resize(nRows);
+
+    for(int i = 0; i<nRows; ++i)
+    {
+        getCell(i, begin, end);
+
+        auto cellType = parseCell(begin, end, intValue, doubleValue);
+
+        if(cellType == CellType::Invalid)
+        {
+            if(numErrors < maxErrorsPerColumn)
+                errors.append("Could not convert the value \"" + QString::fromUtf8(begin, static_cast<int>(end - begin)).trimmed() + "\" in row " + QString::number(i+2) + ", column \"" + column.name + "\" to a number");
+
+            ++numErrors;
+
+            doubleValue = std::numeric_limits<double>::quiet_NaN();
+        }
+        else if(cellType == CellType::Empty)
+        {
+            doubleValue = std::numeric_limits<double>::quiet_NaN();
+        }
+
+        // Promote an integer column to a double column if a value outside of the sample is not an integer
+        if(column.type == CSVColumn::Integer && cellType != CellType::Integer)
+        {
+            column.doubles.resize(nRows);
+            std::copy(column.integers.begin(), column.integers.begin() + i, column.doubles.begin());
+
+            std::vector<qint64>().swap(column.integers);
+
+            column.type = CSVColumn::Double;
+        }
+
+        if(column.type == CSVColumn::Integer)
+            column.integers[i] = intValue;
+        else
+            column.doubles[i] = doubleValue;
+    }
+
+    if(numErrors > maxErrorsPerColumn)
+        errors.append("... and " + QString::number(numErrors - maxErrorsPerColumn) + " more errors in column \"" + column.name + "\"");
+
+    return errors;
+}
+
+
+void CSVTable::setColumnType(const QString& name, const CSVColumn::Type type)
+{
+    columnTypes.insert(name, type);
+}
+
+
+void CSVTable::clear(void)
+{
+    nRows = 0;
+    columns.clear();
+    columnIndexes.clear();
+}
+
+
+int CSVTable::numRows(void) const
+{
+    return nRows;
+}
+
+
+int CSVTable::numColumns(void) const
+{
+    return static_cast<int>(columns.size());
+}
+
+
+QStringList CSVTable::getHeaders(void) const
+{
+    QStringList headers;
+    headers.reserve(static_cast<int>(columns.size()));
+
+    for(auto&& it : columns)
+        headers.append(it.getName());
+
+    return headers;
+}
+
+
+int CSVTable::columnIndex(const QString& name) const
+{
+    return columnIndexes.value(name, -1);
+}
+
+
+const CSVColumn& CSVTable::column(const int col) const
+{
+    return columns[col];
+}
@@ -0,0 +1,142 @@
+#ifndef CSVTABLE_H
+#define CSVTABLE_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+
+// Written by: Stevan Gavrilovic
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+#include <vector>
+
+class MappedCSVFile;
+
+// A column of a CSVTable
+// Numeric columns are stored as contiguous arrays of integers or doubles, all other columns are dictionary-encoded, i.e., each unique string is stored once and the rows hold an index into the dictionary
+class CSVColumn
+{
+public:
+    enum Type {Integer, Double, Text};
+
+    CSVColumn(const QString& name = QString());
+
+    QString getName() const;
+
+    Type getType() const;
+
+    bool isNumeric() const;
+
+    int size() const;
+
+    // Value of the cell as a double. Empty cells in a double column are NaN, text columns return NaN
+    double toDouble(const int row) const;
+
+    // Value of the cell as an integer, double columns are truncated and text columns return 0
+    qint64 toInt64(const int row) const;
+
+    // Value of the cell as a string
+    QString toString(const int row) const;
+
+    // The underlying arrays, only the array that corresponds to the type of the column is populated
+    const std::vector<qint64>& getIntegers() const;
+    const std::vector<double>& getDoubles() const;
+
+    // Index of each row into the dictionary of a text column
+    const std::vector<quint32>& getCodes() const;
+    const QStringList& getDictionary() const;
+
+private:
+    friend class CSVTable;
+
+    QString name;
+    Type type;
+
+    std::vector<qint64> integers;
+    std::vector<double> doubles;
+
+    std::vector<quint32> codes;
+    QStringList dictionary;
+};
+
+
+// Loads a CSV file with a header row into typed columns
+// The type of each column is inferred from a sample of the rows and the cells are converted to numbers once when the file is loaded
+class CSVTable
+{
+public:
+    CSVTable();
+
+    // Loads the file, the first row of the file is the header. Returns 0 on success
+    // The types are inferred from the first sampleSize rows. A column that turns out to have non-integer values or empty cells beyond the sample is promoted from integer to double
+    // If a row does not have one cell per header, or a cell in a numeric column cannot be converted, the row and column are given in the error message
+    int load(const QString& pathToFile, QString& err, const int sampleSize = 1000);
+
+    // Loads the table from a file that is already open
+    int load(const MappedCSVFile& csvFile, QString& err, const int sampleSize = 1000);
+
+    // Overrides the type inference for the column with the given header, e.g., to keep IDs with leading zeros as text
+    void setColumnType(const QString& name, const CSVColumn::Type type);
+
+    void clear(void);
+
+    int numRows(void) const;
+    int numColumns(void) const;
+
+    QStringList getHeaders(void) const;
+
+    // Returns the index of the column with the given header, or -1 if there is no such column
+    int columnIndex(const QString& name) const;
+
+    const CSVColumn& column(const int col) const;
+
+private:
+
+    // Converts the cells of the column at index col in the file, returns the errors
+    QStringList loadColumn(const MappedCSVFile& csvFile, const int col, const int sampleSize);
+
+    int nRows;
+
+    std::vector<CSVColumn> columns;
+
+    QHash<QString, int> columnIndexes;
+
+    QHash<QString, CSVColumn::Type> columnTypes;
+};
+
+#endif // CSVTABLE_H
@@ -0,0 +1,301 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "CSVTokenizer.h"
+#include "CSVScanner.h"
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+#include <algorithm>
+
+CSVRow::CSVRow(const char* data, const qint64 rowStart, const qint64 rowEnd, const quint32* fieldOffsets, const int numFields)
+    : data(data), start(rowStart), end(rowEnd), offsets(fieldOffsets), numFields(numFields)
+{
+
+}
+
+
+int CSVRow::size() const
+{
+    return numFields;
+}
+
+
+bool CSVRow::isEmpty() const
+{
+    return numFields == 0;
+}
+
+
+QString CSVRow::at(const int i) const
+{
+    return CSVTokenizer::fieldToString(data + this->fieldOffset(i), this->fieldLength(i), this->isQuoted(i));
+}
+
+
+QStringList CSVRow::toStringList() const
+{
+    QStringList fields;
+    fields.reserve(numFields);
+
+    for(int i = 0; i<numFields; ++i)
+        fields.append(this->at(i));
+
+    return fields;
+}
+
+
+qint64 CSVRow::fieldOffset(const int i) const
+{
+    return start + (offsets[i] & CSVTokenizer::fieldOffsetMask);
+}
+
+
+int CSVRow::fieldLength(const int i) const
+{
+    auto fieldStart = offsets[i] & CSVTokenizer::fieldOffsetMask;
+
+    // The last field in the row ends at the row terminator, all others end at the comma before the next field
+    if(i == numFields-1)
+        return static_cast<int>(end - start - fieldStart);
+
+    return static_cast<int>((offsets[i+1] & CSVTokenizer::fieldOffsetMask) - 1 - fieldStart);
+}
+
+
+bool CSVRow::isQuoted(const int i) const
+{
+    return (offsets[i] & CSVTokenizer::quotedFieldFlag) != 0;
+}
+
+
+qint64 CSVRow::rowStart() const
+{
+    return start;
+}
+
+
+qint64 CSVRow::rowEnd() const
+{
+    return end;
+}
+
+
+QByteArray CSVRow::toByteArray() const
+{
+    return QByteArray(data + start, static_cast<int>(end - start));
+}
+
+
+bool CSVTokenizer::nextRow(const char* data, const qint64 size, qint64& pos, const bool atEnd, std::vector<quint32>& fieldOffsets, qint64& rowEnd)
+{
+    if(pos >= size)
+        return false;
+
+    const auto rowStart = pos;
+    const auto numFieldsIn = fieldOffsets.size();
+
+    qint64 fieldStart = pos;
+    bool inQuotes = false;
+    bool hasQuotes = false;
+
+    auto pushField = [&](void)
+    {
+        auto offset = static_cast<quint32>(fieldStart - rowStart);
+
+        if(hasQuotes)
+            offset |= quotedFieldFlag;
+
+        fieldOffsets.push_back(offset);
+    };
+
+    // Classify a block of bytes at a time and only visit the commas and newlines that are not in a quoted section
+    qint64 i = pos;
+    for(; i + CSVScanner::blockSize <= size; i += CSVScanner::blockSize)
+    {
+        CSVBlockMasks masks;
+        CSVScanner::scanBlock(data + i, masks);
+
+        // An escaped double-quote toggles twice, so the quote state is the parity of the double-quotes seen so far
+        quint64 inQuotesMask = CSVScanner::prefixXor(masks.quotes);
+        if(inQuotes)
+            inQuotesMask = ~inQuotesMask;
+
+        quint64 delimiters = (masks.commas | masks.newlines) & ~inQuotesMask;
+
+        while(delimiters != 0)
+        {
+            const int bit = CSVScanner::lowestBit(delimiters);
+
+            // Double-quotes in the field between the start of the field (or the block) and the delimiter
+            const int fieldBit = static_cast<int>(std::max(fieldStart - i, qint64(0)));
+            const quint64 fieldMask = (~quint64(0) << fieldBit) & ((quint64(1) << bit) - 1);
+            if((masks.quotes & fieldMask) != 0)
+                hasQuotes = true;
+
+            pushField();
+
+            if((masks.newlines >> bit) & 1)
+            {
+                rowEnd = i + bit;
+                pos = i + bit + 1;
+                return true;
+            }
+
+            fieldStart = i + bit + 1;
+            hasQuotes = false;
+
+            delimiters &= delimiters - 1;
+        }
+
+        // Double-quotes in the part of the field that is within this block
+        const int fieldBit = static_cast<int>(std::max(fieldStart - i, qint64(0)));
+        if(fieldBit < CSVScanner::blockSize && (masks.quotes >> fieldBit) != 0)
+            hasQuotes = true;
+
+        inQuotes = (inQuotesMask >> (CSVScanner::blockSize - 1)) & 1;
+    }
+
+    // Scalar loop over the remaining bytes that do not fill a block
+    for(; i < size; ++i)
+    {
+        const char current = data[i];
+
+        // An escaped double-quote toggles twice, so the quote state is the parity of the double-quotes seen so far
+        if(current == '"')
+        {
+            inQuotes = !inQuotes;
+            hasQuotes = true;
+        }
+        else if(inQuotes)
+        {
+            continue;
+        }
+        else if(current == ',' || current == '\n')
+        {
+            pushField();
+
+            if(current == '\n')
+            {
+                rowEnd = i;
+                pos = i + 1;
+                return true;
+            }
+
+            fieldStart = i + 1;
+            hasQuotes = false;
+        }
+    }
+
+    // Reached the end of the buffer in the middle of a row
+    if(!atEnd)
+    {
+        fieldOffsets.resize(numFieldsIn);
+        return false;
+    }
+
+    // The last row in the file is not terminated by a newline. An empty trailing field is dropped, consistent with the line parser
+    if(fieldStart < size)
+    {
+        pushField();
+
+        rowEnd = size;
+    }
+    else
+    {
+        // Terminate the row at the trailing comma
+        rowEnd = fieldStart - 1;
+    }
+
+    pos = size;
+
+    return true;
+}
+
+
+QString CSVTokenizer::fieldToString(const char* field, const int length, const bool quoted)
+{
+    // Fast path, no quotes to handle
+    if(!quoted)
+        return QString::fromUtf8(field, length).trimmed();
+
+    // Collapse the escaped double-quotes within the quoted sections
+    QByteArray value;
+    value.reserve(length);
+
+    bool inQuotes = false;
+
+    for(int i = 0; i < length; ++i)
+    {
+        const char current = field[i];
+
+        if(current == '"')
+        {
+            // A double double-quote?
+            if(inQuotes && i+1 < length && field[i+1] == '"')
+            {
+                value += '"';
+
+                // Skip a second quote character in a row
+                ++i;
+            }
+            else
+            {
+                inQuotes = !inQuotes;
+                value += '"';
+            }
+        }
+        else
+            value += current;
+    }
+
+    auto str = QString::fromUtf8(value).trimmed();
+
+    // Remove quotes and whitespace around quotes
+    if(str.startsWith('"'))
+    {
+        str.remove(0,1);
+
+        if(str.endsWith('"'))
+            str.chop(1);
+    }
+
+    return str;
+}
@@ -0,0 +1,111 @@
+#ifndef CSVTOKENIZER_H
+#define CSVTOKENIZER_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include <QtGlobal>
+
+#include <vector>
+
+class QByteArray;
+class QString;
+class QStringList;
+
+// Lightweight view of a row of comma separated values within a buffer, e.g., a memory-mapped file
+// The fields are stored as byte offsets relative to the start of the row. A QString is only created for a field when it is requested
+class CSVRow
+{
+public:
+    CSVRow(const char* data, const qint64 rowStart, const qint64 rowEnd, const quint32* fieldOffsets, const int numFields);
+
+    // Number of fields (cells) in the row
+    int size() const;
+
+    bool isEmpty() const;
+
+    // Returns the value of the field at index i as a string, with the quotes and surrounding whitespace removed
+    QString at(const int i) const;
+
+    // Returns all of the fields in the row as a string list
+    QStringList toStringList() const;
+
+    // Position and size in bytes of the raw field at index i within the buffer, including any quotes
+    qint64 fieldOffset(const int i) const;
+    int fieldLength(const int i) const;
+
+    // Returns true if the raw field contains double-quote characters
+    bool isQuoted(const int i) const;
+
+    // Position of the first byte of the row and the terminating character of the row within the buffer
+    qint64 rowStart() const;
+    qint64 rowEnd() const;
+
+    // The raw text of the row without its terminating newline, e.g., to keep a row of a streamed file and tokenize it again later
+    QByteArray toByteArray() const;
+
+private:
+
+    const char* data;
+    qint64 start;
+    qint64 end;
+    const quint32* offsets;
+    int numFields;
+};
+
+
+// Splits a buffer of comma separated values into rows and fields without creating any strings
+// Follows the quoting rules of the CSVReaderWriter line parser: a double-quote toggles a quoted section, two consecutive double-quotes within a quoted section are an escaped double-quote.
+// Commas and newlines within a quoted section are part of the field.
+class CSVTokenizer
+{
+public:
+
+    // The top bit of a field offset is set if the field contains double-quote characters
+    static const quint32 quotedFieldFlag = 0x80000000u;
+    static const quint32 fieldOffsetMask = 0x7FFFFFFFu;
+
+    // Tokenizes the row that begins at pos.
+    // The offsets of the fields relative to pos are appended to fieldOffsets, the position of the terminating newline is given in rowEnd, and pos is advanced to the start of the next row.
+    // Returns false if there is no complete row in the buffer. If atEnd is true, the remainder of the buffer is treated as the last row even without a terminating newline.
+    static bool nextRow(const char* data, const qint64 size, qint64& pos, const bool atEnd, std::vector<quint32>& fieldOffsets, qint64& rowEnd);
+
+    // Creates a string from the raw field with the quotes and surrounding whitespace removed
+    static QString fieldToString(const char* field, const int length, const bool quoted);
+};
+
+#endif // CSVTOKENIZER_H
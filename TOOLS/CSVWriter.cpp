@@ -0,0 +1,394 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "CSVTable.h"
+#include "CSVWriter.h"
+
+#include <QByteArray>
+#include <QLocale>
+#include <QStringList>
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// Initial size of the output buffer
+const size_t initialBufferSize = 64*1024;
+
+bool isSpace(const char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+}
+
+
+CSVWriter::CSVWriter(const int bufferSize) : maxBufferSize(static_cast<size_t>(std::max(bufferSize, 1024)))
+{
+    bufferPos = 0;
+    rowStarted = false;
+}
+
+
+int CSVWriter::open(const QString& pathToFile, QString& err)
+{
+    bufferPos = 0;
+    rowStarted = false;
+    errorMessage.clear();
+
+    file.setFileName(pathToFile);
+
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        err = "Cannot create the file: " + pathToFile + "\n" +"Check your directory and try again.";
+        return -1;
+    }
+
+    return 0;
+}
+
+
+void CSVWriter::writeField(const QString& value)
+{
+    this->beginField();
+
+    const auto length = value.size();
+
+    if(length == 0)
+        return;
+
+    const QChar* chars = value.constData();
+
+    // The reader trims the fields, so surrounding whitespace is only kept within quotes
+    bool needsQuotes = chars[0].isSpace() || chars[length-1].isSpace();
+    bool isAscii = true;
+    int numQuotes = 0;
+
+    for(int i = 0; i<length; ++i)
+    {
+        const auto c = chars[i].unicode();
+
+        if(c >= 0x80)
+            isAscii = false;
+        else if(c == '"')
+            ++numQuotes;
+        else if(c == ',' || c == '\n' || c == '\r')
+            needsQuotes = true;
+    }
+
+    if(numQuotes > 0)
+        needsQuotes = true;
+
+    if(!isAscii)
+    {
+        auto utf8 = value.toUtf8();
+        this->writeEscaped(utf8.constData(), utf8.size(), needsQuotes);
+        return;
+    }
+
+    // Fast path, convert the characters directly into the buffer
+    char* out = this->reserve(length + numQuotes + 2);
+    char* pos = out;
+
+    if(needsQuotes)
+        *pos++ = '"';
+
+    for(int i = 0; i<length; ++i)
+    {
+        const char c = static_cast<char>(chars[i].unicode());
+
+        *pos++ = c;
+
+        // Escape a double-quote with another double-quote
+        if(c == '"')
+            *pos++ = '"';
+    }
+
+    if(needsQuotes)
+        *pos++ = '"';
+
+    bufferPos += pos - out;
+}
+
+
+void CSVWriter::writeField(const char* value, const int length)
+{
+    this->beginField();
+
+    if(length <= 0)
+        return;
+
+    bool needsQuotes = isSpace(value[0]) || isSpace(value[length-1]);
+
+    for(int i = 0; i<length && !needsQuotes; ++i)
+    {
+        const char c = value[i];
+        needsQuotes = c == '"' || c == ',' || c == '\n' || c == '\r';
+    }
+
+    this->writeEscaped(value, length, needsQuotes);
+}
+
+
+void CSVWriter::writeField(const double value)
+{
+    this->beginField();
+
+    // Missing values are left empty
+    if(std::isnan(value))
+        return;
+
+#if defined(__cpp_lib_to_chars)
+    const size_t maxLength = 32;
+
+    char* out = this->reserve(maxLength);
+    auto res = std::to_chars(out, out + maxLength, value);
+
+    bufferPos += res.ptr - out;
+#else
+    auto str = QByteArray::number(value, 'g', QLocale::FloatingPointShortest);
+
+    char* out = this->reserve(str.size());
+    std::memcpy(out, str.constData(), str.size());
+
+    bufferPos += str.size();
+#endif
+}
+
+
+void CSVWriter::writeField(const qint64 value)
+{
+    this->beginField();
+
+    const size_t maxLength = 24;
+
+    char* out = this->reserve(maxLength);
+    auto res = std::to_chars(out, out + maxLength, value);
+
+    bufferPos += res.ptr - out;
+}
+
+
+void CSVWriter::writeField(const int value)
+{
+    this->writeField(static_cast<qint64>(value));
+}
+
+
+void CSVWriter::endRow(void)
+{
+    *this->reserve(1) = '\n';
+    ++bufferPos;
+
+    rowStarted = false;
+}
+
+
+void CSVWriter::writeRow(const QStringList& row)
+{
+    for(auto&& it : row)
+        this->writeField(it);
+
+    this->endRow();
+}
+
+
+void CSVWriter::writeRawRow(const char* data, const qint64 length)
+{
+    auto numBytes = static_cast<size_t>(length);
+
+    if(numBytes > 0 && data[numBytes-1] == '\r')
+        --numBytes;
+
+    auto out = this->reserve(numBytes + 1);
+
+    std::memcpy(out, data, numBytes);
+    out[numBytes] = '\n';
+
+    bufferPos += numBytes + 1;
+
+    rowStarted = false;
+}
+
+
+void CSVWriter::writeTable(const CSVTable& table)
+{
+    this->writeRow(table.getHeaders());
+
+    const auto numRows = table.numRows();
+    const auto numCols = table.numColumns();
+
+    for(int i = 0; i<numRows; ++i)
+    {
+        for(int j = 0; j<numCols; ++j)
+        {
+            const auto& column = table.column(j);
+
+            switch (column.getType())
+            {
+            case CSVColumn::Integer : this->writeField(column.getIntegers()[i]); break;
+            case CSVColumn::Double : this->writeField(column.getDoubles()[i]); break;
+            default : this->writeField(column.getDictionary().at(static_cast<int>(column.getCodes()[i]))); break;
+            }
+        }
+
+        this->endRow();
+    }
+}
+
+
+int CSVWriter::close(QString& err)
+{
+    this->flush();
+
+    if(!errorMessage.isEmpty())
+    {
+        err = errorMessage;
+        this->cancel();
+        return -1;
+    }
+
+    if(!file.commit())
+    {
+        err = "Error saving the file: " + file.fileName() + "\n" + file.errorString();
+        return -1;
+    }
+
+    return 0;
+}
+
+
+void CSVWriter::cancel(void)
+{
+    bufferPos = 0;
+    rowStarted = false;
+
+    if(file.isOpen())
+    {
+        // Committing a cancelled file closes it and removes the temporary file
+        file.cancelWriting();
+        file.commit();
+    }
+}
+
+
+bool CSVWriter::hasError(void) const
+{
+    return !errorMessage.isEmpty();
+}
+
+
+char* CSVWriter::reserve(const size_t numBytes)
+{
+    if(bufferPos + numBytes > buffer.size())
+    {
+        // Grow the buffer up to its maximum size before writing it out
+        if(buffer.size() < maxBufferSize)
+            buffer.resize(std::min(std::max(2*buffer.size(), initialBufferSize), maxBufferSize));
+
+        if(bufferPos + numBytes > buffer.size())
+            this->flush();
+
+        // A single field that is larger than the buffer
+        if(numBytes > buffer.size())
+            buffer.resize(numBytes);
+    }
+
+    return buffer.data() + bufferPos;
+}
+
+
+void CSVWriter::flush(void)
+{
+    if(bufferPos == 0)
+        return;
+
+    auto numBytes = static_cast<qint64>(bufferPos);
+
+    if(file.write(buffer.data(), numBytes) != numBytes && errorMessage.isEmpty())
+        errorMessage = "Error writing to the file: " + file.fileName() + "\n" + file.errorString();
+
+    bufferPos = 0;
+}
+
+
+void CSVWriter::beginField(void)
+{
+    if(rowStarted)
+    {
+        *this->reserve(1) = ',';
+        ++bufferPos;
+    }
+
+    rowStarted = true;
+}
+
+
+void CSVWriter::writeEscaped(const char* value, const int length, const bool needsQuotes)
+{
+    if(!needsQuotes)
+    {
+        char* out = this->reserve(length);
+        std::memcpy(out, value, length);
+        bufferPos += length;
+        return;
+    }
+
+    const auto numQuotes = std::count(value, value + length, '"');
+
+    char* out = this->reserve(length + numQuotes + 2);
+    char* pos = out;
+
+    *pos++ = '"';
+
+    for(int i = 0; i<length; ++i)
+    {
+        *pos++ = value[i];
+
+        // Escape a double-quote with another double-quote
+        if(value[i] == '"')
+            *pos++ = '"';
+    }
+
+    *pos++ = '"';
+
+    bufferPos += pos - out;
+}
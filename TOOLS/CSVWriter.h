@@ -0,0 +1,116 @@
+#ifndef CSVWRITER_H
+#define CSVWRITER_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+
+// Written by: Stevan Gavrilovic
+
+#include <QSaveFile>
+#include <QString>
+
+#include <vector>
+
+class CSVTable;
+class QStringList;
+
+// Writes a CSV file row by row through a large output buffer
+// The values are formatted directly into the buffer. A field is only quoted if it contains a comma, double-quote, newline, or surrounding whitespace, and doubles are written with the shortest representation that reads back to the same value
+// The output goes to a temporary file that only replaces the destination when the writer is closed without errors
+class CSVWriter
+{
+public:
+    // The buffer grows as required up to the given size, after which it is written out whenever it is full
+    CSVWriter(const int bufferSize = 8*1024*1024);
+
+    // Returns 0 on success. Fails if the temporary file cannot be created in the directory of the destination, the destination is never written in place
+    int open(const QString& pathToFile, QString& err);
+
+    // Appends a field to the current row
+    void writeField(const QString& value);
+    void writeField(const char* value, const int length);
+    void writeField(const double value);
+    void writeField(const qint64 value);
+    void writeField(const int value);
+
+    // Terminates the current row
+    void endRow(void);
+
+    // Writes all of the items in the list as a row
+    void writeRow(const QStringList& row);
+
+    // Copies a row that is already formatted as CSV, e.g., a row of an existing file, without parsing it
+    // The row must not contain the terminating newline, a trailing carriage return is dropped
+    void writeRawRow(const char* data, const qint64 length);
+
+    // Writes the header and the rows of a table, numbers are written from the typed columns without creating strings
+    void writeTable(const CSVTable& table);
+
+    // Flushes the buffer and commits the file, returns 0 on success
+    int close(QString& err);
+
+    // Discards everything that was written, the destination file is left untouched
+    void cancel(void);
+
+    bool hasError(void) const;
+
+private:
+
+    Q_DISABLE_COPY(CSVWriter)
+
+    // Makes room for at least numBytes in the buffer, writing out the buffer if required
+    char* reserve(const size_t numBytes);
+
+    // Copies the field into the buffer, adding the quotes and escaping the double-quotes if required
+    void writeEscaped(const char* value, const int length, const bool needsQuotes);
+
+    void flush(void);
+
+    // Adds the comma that separates the field from the previous field in the row
+    void beginField(void);
+
+    QSaveFile file;
+
+    std::vector<char> buffer;
+    size_t bufferPos;
+    size_t maxBufferSize;
+
+    bool rowStarted;
+
+    QString errorMessage;
+};
+
+#endif // CSVWRITER_H
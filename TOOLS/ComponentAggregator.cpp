@@ -0,0 +1,374 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "ComponentAggregator.h"
+#include "ComponentDatabase.h"
+
+#include <QHash>
+#include <QThread>
+#include <QtConcurrent/QtConcurrentMap>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Radius of the sphere of the Web Mercator projection, in meters
+const double earthRadius = 6378137.0;
+
+// Web Mercator does not reach the poles
+const double maxLatitude = 85.0511287798;
+
+const double pi = 3.14159265358979323846;
+
+const double degreesToRadians = pi/180.0;
+
+// Number of components given to a thread at a time when binning the components
+const size_t chunkSize = 16384;
+
+quint64 cellKey(const qint32 i, const qint32 j)
+{
+    return (static_cast<quint64>(static_cast<quint32>(i)) << 32) | static_cast<quint32>(j);
+}
+
+}
+
+
+ComponentAggregator::ComponentAggregator(const CellShape shape) : shape(shape)
+{
+
+}
+
+
+void ComponentAggregator::addField(const QString& name, const Statistic statistic, const QString& column)
+{
+    fieldNames.append(name);
+    fieldStatistics.append(statistic);
+    fieldColumns.append(column);
+}
+
+
+QStringList ComponentAggregator::getFieldNames(void) const
+{
+    return fieldNames;
+}
+
+
+int ComponentAggregator::setDatabase(const ComponentDatabase& database, QString& err)
+{
+    pointsX.clear();
+    pointsY.clear();
+    fieldValues.assign(fieldNames.size(), std::vector<double>());
+
+    auto numRows = database.getNumberOfComponents();
+
+    std::vector<int> rows;
+    rows.reserve(numRows);
+
+    pointsX.reserve(numRows);
+    pointsY.reserve(numRows);
+
+    for(int row = 0; row<numRows; ++row)
+    {
+        auto envelope = database.getEnvelope(row);
+
+        if(std::isnan(envelope.xMin))
+            continue;
+
+        auto lon = 0.5*(envelope.xMin + envelope.xMax);
+        auto lat = std::max(-maxLatitude, std::min(maxLatitude, 0.5*(envelope.yMin + envelope.yMax)));
+
+        pointsX.push_back(earthRadius*lon*degreesToRadians);
+        pointsY.push_back(earthRadius*std::log(std::tan(pi/4.0 + 0.5*lat*degreesToRadians)));
+
+        rows.push_back(row);
+    }
+
+    // The columns are read straight from the database where they are stored as numbers
+    for(int k = 0; k<fieldNames.size(); ++k)
+    {
+        if(fieldStatistics.at(k) == Count)
+            continue;
+
+        auto&& column = fieldColumns.at(k);
+
+        auto attribute = database.getAttributeIndex(column);
+        auto result = database.getResultIndex(column);
+
+        if(attribute == -1 && result == -1)
+        {
+            err = "Could not find the column " + column + " of the field " + fieldNames.at(k);
+            return -1;
+        }
+
+        const double* values = attribute != -1 ? database.getAttributeColumn(attribute) : database.getResultColumn(result);
+
+        auto& fieldColumn = fieldValues[k];
+        fieldColumn.resize(rows.size());
+
+        for(size_t i = 0; i<rows.size(); ++i)
+        {
+            if(values != nullptr)
+            {
+                fieldColumn[i] = values[rows[i]];
+                continue;
+            }
+
+            // Columns of text or mixed values are converted one value at a time
+            bool OK = false;
+            auto value = database.getAttributeValue(rows[i], attribute).toDouble(&OK);
+
+            fieldColumn[i] = OK ? value : std::numeric_limits<double>::quiet_NaN();
+        }
+    }
+
+    return 0;
+}
+
+
+int ComponentAggregator::getNumberOfComponents(void) const
+{
+    return static_cast<int>(pointsX.size());
+}
+
+
+std::vector<ComponentAggregator::Cell> ComponentAggregator::aggregate(const double cellSize) const
+{
+    const size_t numFields = fieldNames.size();
+
+    // The sums and the number of values of each field, for each cell
+    struct Accumulator
+    {
+        qint32 i;
+        qint32 j;
+        int count;
+        std::vector<double> sums;
+        std::vector<int> numValues;
+    };
+
+    // Each chunk of components is binned into its own cells, then the cells of the chunks are merged
+    struct Chunk
+    {
+        size_t start;
+        size_t end;
+        QHash<quint64, int> cellIndex;
+        std::vector<Accumulator> cells;
+    };
+
+    std::vector<Chunk> chunks;
+    for(size_t start = 0; start<pointsX.size(); start += chunkSize)
+        chunks.push_back(Chunk{start, std::min(start + chunkSize, pointsX.size()), QHash<quint64, int>(), std::vector<Accumulator>()});
+
+    QtConcurrent::blockingMap(chunks, [&](Chunk& chunk)
+    {
+        for(size_t p = chunk.start; p<chunk.end; ++p)
+        {
+            qint32 i = 0;
+            qint32 j = 0;
+            this->locate(pointsX[p], pointsY[p], cellSize, i, j);
+
+            auto key = cellKey(i, j);
+
+            auto it = chunk.cellIndex.constFind(key);
+
+            int index = 0;
+            if(it == chunk.cellIndex.constEnd())
+            {
+                index = static_cast<int>(chunk.cells.size());
+                chunk.cellIndex.insert(key, index);
+                chunk.cells.push_back(Accumulator{i, j, 0, std::vector<double>(numFields, 0.0), std::vector<int>(numFields, 0)});
+            }
+            else
+            {
+                index = it.value();
+            }
+
+            auto& cell = chunk.cells[index];
+
+            ++cell.count;
+
+            for(size_t k = 0; k<numFields; ++k)
+            {
+                if(fieldValues[k].empty())
+                    continue;
+
+                auto value = fieldValues[k][p];
+
+                if(std::isnan(value))
+                    continue;
+
+                cell.sums[k] += value;
+                ++cell.numValues[k];
+            }
+        }
+    });
+
+    QHash<quint64, int> cellIndex;
+    std::vector<Accumulator> accumulators;
+
+    for(auto&& chunk : chunks)
+    {
+        for(auto&& chunkCell : chunk.cells)
+        {
+            auto key = cellKey(chunkCell.i, chunkCell.j);
+
+            auto it = cellIndex.constFind(key);
+
+            if(it == cellIndex.constEnd())
+            {
+                cellIndex.insert(key, static_cast<int>(accumulators.size()));
+                accumulators.push_back(std::move(chunkCell));
+                continue;
+            }
+
+            auto& cell = accumulators[it.value()];
+            cell.count += chunkCell.count;
+
+            for(size_t k = 0; k<numFields; ++k)
+            {
+                cell.sums[k] += chunkCell.sums[k];
+                cell.numValues[k] += chunkCell.numValues[k];
+            }
+        }
+    }
+
+    std::vector<Cell> cells;
+    cells.reserve(accumulators.size());
+
+    for(auto&& accumulator : accumulators)
+    {
+        Cell cell{accumulator.i, accumulator.j, accumulator.count, std::vector<double>(numFields, 0.0)};
+
+        for(size_t k = 0; k<numFields; ++k)
+        {
+            switch (fieldStatistics.at(static_cast<int>(k)))
+            {
+            case Count :
+                cell.values[k] = accumulator.count;
+                break;
+            case Sum :
+                cell.values[k] = accumulator.sums[k];
+                break;
+            case Mean :
+                cell.values[k] = accumulator.numValues[k] > 0 ? accumulator.sums[k]/accumulator.numValues[k] : std::numeric_limits<double>::quiet_NaN();
+                break;
+            }
+        }
+
+        cells.push_back(std::move(cell));
+    }
+
+    return cells;
+}
+
+
+QVector<QPointF> ComponentAggregator::getCellCorners(const Cell& cell, const double cellSize) const
+{
+    auto center = this->getCellCenter(cell.i, cell.j, cellSize);
+
+    QVector<QPointF> corners;
+
+    if(shape == Square)
+    {
+        auto halfSize = 0.5*cellSize;
+
+        corners.append(QPointF(center.x() - halfSize, center.y() - halfSize));
+        corners.append(QPointF(center.x() + halfSize, center.y() - halfSize));
+        corners.append(QPointF(center.x() + halfSize, center.y() + halfSize));
+        corners.append(QPointF(center.x() - halfSize, center.y() + halfSize));
+
+        return corners;
+    }
+
+    // Pointy-top hexagons, the cell size is the distance between the centers of neighbouring cells
+    auto radius = cellSize/std::sqrt(3.0);
+
+    for(int k = 0; k<6; ++k)
+    {
+        auto angle = (30.0 + 60.0*k)*degreesToRadians;
+        corners.append(QPointF(center.x() + radius*std::cos(angle), center.y() + radius*std::sin(angle)));
+    }
+
+    return corners;
+}
+
+
+void ComponentAggregator::locate(const double x, const double y, const double cellSize, qint32& i, qint32& j) const
+{
+    if(shape == Square)
+    {
+        i = static_cast<qint32>(std::floor(x/cellSize));
+        j = static_cast<qint32>(std::floor(y/cellSize));
+        return;
+    }
+
+    // The axial coordinates of the point, rounded to the nearest hexagon through the cube coordinates
+    auto radius = cellSize/std::sqrt(3.0);
+
+    auto q = (std::sqrt(3.0)/3.0*x - y/3.0)/radius;
+    auto r = (2.0/3.0*y)/radius;
+    auto s = -q - r;
+
+    auto roundedQ = std::round(q);
+    auto roundedR = std::round(r);
+    auto roundedS = std::round(s);
+
+    auto diffQ = std::abs(roundedQ - q);
+    auto diffR = std::abs(roundedR - r);
+    auto diffS = std::abs(roundedS - s);
+
+    if(diffQ > diffR && diffQ > diffS)
+        roundedQ = -roundedR - roundedS;
+    else if(diffR > diffS)
+        roundedR = -roundedQ - roundedS;
+
+    i = static_cast<qint32>(roundedQ);
+    j = static_cast<qint32>(roundedR);
+}
+
+
+QPointF ComponentAggregator::getCellCenter(const qint32 i, const qint32 j, const double cellSize) const
+{
+    if(shape == Square)
+        return QPointF((i + 0.5)*cellSize, (j + 0.5)*cellSize);
+
+    auto radius = cellSize/std::sqrt(3.0);
+
+    return QPointF(radius*std::sqrt(3.0)*(i + 0.5*j), radius*1.5*j);
+}
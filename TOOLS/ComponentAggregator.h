@@ -0,0 +1,108 @@
+#ifndef COMPONENTAGGREGATOR_H
+#define COMPONENTAGGREGATOR_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include <QPointF>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <vector>
+
+class ComponentDatabase;
+
+// Bins the components of a component database into hexagonal or square cells and computes statistics of the components in each cell, e.g., the number of buildings, their summed replacement cost, or their mean loss ratio
+// The components are located by the center of their envelope, projected to Web Mercator so that the cells are regular on the map. The cell size is in meters
+class ComponentAggregator
+{
+public:
+    enum CellShape {Hexagon, Square};
+    enum Statistic {Count, Sum, Mean};
+
+    // A cell with at least one component, the values are in the same order as the fields. Missing values are skipped, a mean without any values is NaN
+    struct Cell
+    {
+        qint32 i;
+        qint32 j;
+        int count;
+        std::vector<double> values;
+    };
+
+    explicit ComponentAggregator(const CellShape shape = Hexagon);
+
+    // Adds a field to the statistics of each cell. Sums and means are taken over the given attribute or result of the database, the column is not needed for a count
+    void addField(const QString& name, const Statistic statistic, const QString& column = QString());
+
+    QStringList getFieldNames(void) const;
+
+    // Locates the components and gathers the values of the columns of the fields, call again once the database changes
+    // Returns -1 if the column of a field is neither an attribute nor a result of the database
+    int setDatabase(const ComponentDatabase& database, QString& err);
+
+    // Number of components that have a location
+    int getNumberOfComponents(void) const;
+
+    // Bins the components into cells of the given size, in parallel
+    std::vector<Cell> aggregate(const double cellSize) const;
+
+    // Corners of the cell in Web Mercator, six for a hexagon and four for a square
+    QVector<QPointF> getCellCorners(const Cell& cell, const double cellSize) const;
+
+private:
+
+    // Index of the cell that contains the point
+    void locate(const double x, const double y, const double cellSize, qint32& i, qint32& j) const;
+
+    QPointF getCellCenter(const qint32 i, const qint32 j, const double cellSize) const;
+
+    CellShape shape;
+
+    QStringList fieldNames;
+    QVector<Statistic> fieldStatistics;
+    QStringList fieldColumns;
+
+    // The Web Mercator x and y of each located component
+    std::vector<double> pointsX;
+    std::vector<double> pointsY;
+
+    // The values of the column of each field for the located components, empty for a count
+    std::vector<std::vector<double>> fieldValues;
+};
+
+#endif // COMPONENTAGGREGATOR_H
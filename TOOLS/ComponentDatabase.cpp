@@ -37,6 +37,686 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 // Written by: Stevan Gavrilovic
 
 #include "ComponentDatabase.h"
+#include "CSVIndexCache.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QLocale>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+const char cacheMagic[8] = {'R','2','D','C','O','M','P','S'};
+
+// Increment when the layout of the cache changes
+const quint32 cacheVersion = 2;
+
+struct CacheHeader
+{
+    char magic[8];
+    quint32 version;
+    quint32 pathLength;
+
+    // Key of the CSV file
+    qint64 fileSize;
+    qint64 lastModified;
+    quint64 contentHash;
+
+    qint64 numRows;
+    qint64 numAttributes;
+};
+
+// The header of each attribute column in the cache, followed by the values of the column
+// A column of numbers has numValues doubles, a column of text has numValues codes of codeWidth bytes and numUniqueValues unique values, stored as their lengths followed by their UTF-8 text
+struct ColumnHeader
+{
+    quint32 type;
+    quint32 categorical;
+    quint32 codeWidth;
+    quint32 reserved;
+
+    qint64 numValues;
+    qint64 numUniqueValues;
+    qint64 numTextBytes;
+};
+
+// True if the value is missing, i.e., invalid, an empty text, or the text "NA" used by the inventories
+bool isMissing(const QVariant& value)
+{
+    if(!value.isValid())
+        return true;
+
+    if(value.type() != QVariant::String)
+        return false;
+
+    auto str = value.toString().trimmed();
+
+    return str.isEmpty() || str == "NA";
+}
+
+
+// Converts the value to a number if it is numeric, or a text that holds a number
+// The text has to be written the same way the number is written back, e.g., "00123", "37.80", or "1e3" are kept as text so that they are not rewritten on output
+bool toNumber(const QVariant& value, double& number)
+{
+    switch (value.type())
+    {
+    case QVariant::Double :
+    case QVariant::Int :
+    case QVariant::UInt :
+    case QVariant::LongLong :
+    case QVariant::ULongLong :
+    {
+        number = value.toDouble();
+        return true;
+    }
+    case QVariant::String :
+    {
+        auto str = value.toString();
+
+        bool OK = false;
+        number = str.toDouble(&OK);
+
+        return OK && std::isfinite(number) && ComponentDatabase::toText(QVariant(number)) == str;
+    }
+    default :
+        return false;
+    }
+}
+
+
+// True if the value can be stored in a column of text, i.e., it is a single value that can be written as text, unlike a list or a map
+bool isText(const QVariant& value)
+{
+    switch (value.type())
+    {
+    case QVariant::List :
+    case QVariant::StringList :
+    case QVariant::Map :
+    case QVariant::Hash :
+        return false;
+    default :
+        return value.canConvert<QString>();
+    }
+}
+
+
+// Crossing number test of a point against a polygon given by its vertices
+bool isPointInPolygon(const double x, const double y, const QVector<QPointF>& polygon)
+{
+    bool inside = false;
+
+    for(int i = 0, j = polygon.size() - 1; i<polygon.size(); j = i++)
+    {
+        const auto& a = polygon.at(i);
+        const auto& b = polygon.at(j);
+
+        if((a.y() > y) != (b.y() > y) && x < (b.x() - a.x())*(y - a.y())/(b.y() - a.y()) + a.x())
+            inside = !inside;
+    }
+
+    return inside;
+}
+
+}
+
+
+Component::Component(ComponentDatabase* database, const int row) : theDatabase(database), row(row)
+{
+
+}
+
+
+void Component::addResult(const QString& key, const double res)
+{
+    if(theDatabase == nullptr || row == -1)
+        return;
+
+    theDatabase->setResultValue(row, theDatabase->addResult(key), res);
+}
+
+
+QVariant Component::getAttributeValue(const QString& key) const
+{
+    return this->getAttributeValue(key, QVariant());
+}
+
+
+QVariant Component::getAttributeValue(const QString& key, const QVariant& defaultValue) const
+{
+    if(theDatabase == nullptr || row == -1)
+        return defaultValue;
+
+    auto attribute = theDatabase->getAttributeIndex(key);
+
+    if(attribute == -1)
+        return defaultValue;
+
+    auto value = theDatabase->getAttributeValue(row, attribute);
+
+    return value.isValid() ? value : defaultValue;
+}
+
+
+double Component::getResultValue(const QString& key) const
+{
+    if(theDatabase == nullptr || row == -1)
+        return 0.0;
+
+    auto result = theDatabase->getResultIndex(key);
+
+    if(result == -1)
+        return 0.0;
+
+    return theDatabase->getResultValue(row, result);
+}
+
+
+int Component::setAttributeValue(const QString& attribute, const QVariant& value)
+{
+    if(theDatabase == nullptr || row == -1)
+        return -1;
+
+    auto attributeIndex = theDatabase->addAttribute(attribute);
+
+    theDatabase->setAttributeValue(row, attributeIndex, value);
+    theDatabase->setDirty(row, attributeIndex);
+
+    auto ComponentFeature = theDatabase->getFeature(row);
+
+    if(ComponentFeature != nullptr)
+    {
+        ComponentFeature->attributes()->replaceAttribute(attribute,value);
+        ComponentFeature->featureTable()->updateFeature(ComponentFeature);
+
+        if(ComponentFeature->attributes()->attributeValue(attribute).isNull())
+        {
+            qDebug()<<"Failed to update feature "<<attribute<<" in component "<<this->getID();
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+
+bool Component::isValid(void) const
+{
+    if(theDatabase == nullptr || row == -1)
+        return false;
+
+    return true;
+}
+
+
+int Component::getRow(void) const
+{
+    return row;
+}
+
+
+qint64 Component::getID(void) const
+{
+    if(theDatabase == nullptr || row == -1)
+        return -1;
+
+    return theDatabase->getID(row);
+}
+
+
+QString Component::getUID(void) const
+{
+    if(theDatabase == nullptr || row == -1)
+        return "NULL";
+
+    return theDatabase->getUID(row);
+}
+
+
+Esri::ArcGISRuntime::Feature* Component::getFeature(void) const
+{
+    if(theDatabase == nullptr || row == -1)
+        return nullptr;
+
+    return theDatabase->getFeature(row);
+}
+
+
+void ComponentDatabase::AttributeColumn::setValue(const int row, const QVariant& value)
+{
+    const bool missing = isMissing(value);
+
+    // The first value that is not missing decides the type of the column
+    if(type == Empty)
+    {
+        if(missing)
+            return;
+
+        double number = 0.0;
+        if(toNumber(value, number))
+            type = Double;
+        else if(value.type() == QVariant::String)
+            type = String;
+        else
+            type = Variant;
+    }
+
+    const size_t minSize = static_cast<size_t>(row) + 1;
+
+    if(type == Double)
+    {
+        double number = std::numeric_limits<double>::quiet_NaN();
+
+        if(missing || toNumber(value, number))
+        {
+            if(doubles.size() < minSize)
+                doubles.resize(minSize, std::numeric_limits<double>::quiet_NaN());
+
+            doubles[row] = number;
+            return;
+        }
+
+        // A value that is not written as a number, e.g., a zero padded ID, turns the numbers into text without changing how they are written
+        if(isText(value))
+            this->toText();
+        else
+            this->toVariant();
+    }
+
+    if(type == String)
+    {
+        if(missing)
+        {
+            codes.set(row, missingCode);
+            return;
+        }
+
+        // Numbers, dates, etc. are stored as text so that one value does not turn the whole column into QVariants
+        if(categorical || isText(value))
+        {
+            codes.set(row, this->getCode(ComponentDatabase::toText(value)));
+            return;
+        }
+
+        this->toVariant();
+    }
+
+    if(variants.size() < minSize)
+        variants.resize(minSize);
+
+    variants[row] = missing ? QVariant() : value;
+}
+
+
+void ComponentDatabase::AttributeColumn::resize(const size_t numRows)
+{
+    switch (type)
+    {
+    case Double :
+        if(doubles.size() < numRows)
+            doubles.resize(numRows, std::numeric_limits<double>::quiet_NaN());
+        break;
+    case String :
+        if(codes.size() < numRows)
+            codes.set(numRows - 1, missingCode);
+        break;
+    case Variant :
+        if(variants.size() < numRows)
+            variants.resize(numRows);
+        break;
+    default :
+        break;
+    }
+}
+
+
+quint32 ComponentDatabase::AttributeColumn::getCode(const QString& str)
+{
+    auto it = uniqueValueIndex.constFind(str);
+    if(it != uniqueValueIndex.constEnd())
+        return it.value();
+
+    auto code = static_cast<quint32>(uniqueValues.size());
+
+    uniqueValueIndex.insert(str, code);
+    uniqueValues.append(str);
+
+    return code;
+}
+
+
+QVariant ComponentDatabase::AttributeColumn::getValue(const int row) const
+{
+    const size_t index = static_cast<size_t>(row);
+
+    switch (type)
+    {
+    case Double :
+        if(index >= doubles.size() || std::isnan(doubles[index]))
+            return QVariant();
+        return QVariant(doubles[index]);
+    case String :
+    {
+        auto code = codes.get(index);
+        if(code == missingCode)
+            return QVariant();
+        return QVariant(uniqueValues.at(static_cast<int>(code)));
+    }
+    case Variant :
+        if(index >= variants.size())
+            return QVariant();
+        return variants[index];
+    default :
+        return QVariant();
+    }
+}
+
+
+void ComponentDatabase::AttributeColumn::toText(void)
+{
+    std::vector<double> numbers;
+    numbers.swap(doubles);
+
+    type = String;
+
+    for(size_t i = 0; i<numbers.size(); ++i)
+    {
+        if(std::isnan(numbers[i]))
+            codes.set(i, missingCode);
+        else
+            codes.set(i, this->getCode(ComponentDatabase::toText(QVariant(numbers[i]))));
+    }
+}
+
+
+void ComponentDatabase::AttributeColumn::toVariant(void)
+{
+    const auto numRows = std::max(doubles.size(), codes.size());
+
+    std::vector<QVariant> values(numRows);
+
+    for(size_t i = 0; i<numRows; ++i)
+        values[i] = this->getValue(static_cast<int>(i));
+
+    variants.swap(values);
+
+    std::vector<double>().swap(doubles);
+    codes.clear();
+    uniqueValues.clear();
+    uniqueValueIndex.clear();
+
+    type = Variant;
+}
+
+
+template <typename Writer>
+bool ComponentDatabase::AttributeColumn::write(Writer writeBytes) const
+{
+    if(type == Variant)
+        return false;
+
+    QByteArray text;
+    std::vector<qint32> textLengths;
+    textLengths.reserve(static_cast<size_t>(uniqueValues.size()));
+
+    for(auto&& value : uniqueValues)
+    {
+        auto utf8 = value.toUtf8();
+
+        textLengths.push_back(utf8.size());
+        text.append(utf8);
+    }
+
+    ColumnHeader header;
+    header.type = static_cast<quint32>(type);
+    header.categorical = categorical ? 1 : 0;
+    header.codeWidth = static_cast<quint32>(codes.getWidth());
+    header.reserved = 0;
+    header.numValues = static_cast<qint64>(type == Double ? doubles.size() : codes.size());
+    header.numUniqueValues = static_cast<qint64>(textLengths.size());
+    header.numTextBytes = text.size();
+
+    bool OK = writeBytes(&header, sizeof(ColumnHeader)) && writeBytes(doubles.data(), 8*static_cast<qint64>(doubles.size()));
+
+    codes.visit([&](const auto* values, const size_t numValues, const quint32 /*missing*/)
+    {
+        OK = OK && writeBytes(values, static_cast<qint64>(sizeof(*values)*numValues));
+    });
+
+    return OK && writeBytes(textLengths.data(), 4*static_cast<qint64>(textLengths.size())) && writeBytes(text.constData(), text.size());
+}
+
+
+template <typename Reader>
+bool ComponentDatabase::AttributeColumn::read(Reader readBytes, const qint64 numRows)
+{
+    const char* headerBytes = readBytes(sizeof(ColumnHeader));
+
+    if(headerBytes == nullptr)
+        return false;
+
+    ColumnHeader header;
+    std::memcpy(&header, headerBytes, sizeof(ColumnHeader));
+
+    const qint64 maxSize = std::numeric_limits<int>::max();
+
+    if(header.type > String || (header.codeWidth != 1 && header.codeWidth != 2 && header.codeWidth != 4) ||
+            header.numValues != (header.type == Empty ? 0 : numRows) ||
+            header.numUniqueValues < 0 || header.numUniqueValues > maxSize ||
+            header.numTextBytes < 0 || header.numTextBytes > maxSize)
+        return false;
+
+    type = static_cast<Type>(header.type);
+    categorical = header.categorical != 0;
+
+    const auto numDoubles = type == Double ? header.numValues : 0;
+    const auto numCodes = type == String ? header.numValues : 0;
+
+    // All of the bytes are checked to be there before anything is allocated
+    const char* doubleBytes = readBytes(8*numDoubles);
+    const char* codeBytes = readBytes(header.codeWidth*numCodes);
+    const char* lengthBytes = readBytes(4*header.numUniqueValues);
+    const char* text = readBytes(header.numTextBytes);
+
+    if(doubleBytes == nullptr || codeBytes == nullptr || lengthBytes == nullptr || text == nullptr)
+        return false;
+
+    doubles.resize(static_cast<size_t>(numDoubles));
+    if(numDoubles > 0)
+        std::memcpy(doubles.data(), doubleBytes, static_cast<size_t>(8*numDoubles));
+
+    codes.resize(static_cast<int>(header.codeWidth), static_cast<size_t>(numCodes));
+    if(numCodes > 0)
+        std::memcpy(codes.data(), codeBytes, static_cast<size_t>(header.codeWidth*numCodes));
+
+    // The unique values are only split out of the text, they are not parsed again
+    uniqueValues.reserve(static_cast<int>(header.numUniqueValues));
+    uniqueValueIndex.reserve(static_cast<int>(header.numUniqueValues));
+
+    qint64 offset = 0;
+    for(qint64 i = 0; i<header.numUniqueValues; ++i)
+    {
+        qint32 length = 0;
+        std::memcpy(&length, lengthBytes + 4*i, 4);
+
+        if(length < 0 || offset + length > header.numTextBytes)
+            return false;
+
+        auto value = QString::fromUtf8(text + offset, length);
+
+        uniqueValueIndex.insert(value, static_cast<quint32>(uniqueValues.size()));
+        uniqueValues.append(value);
+
+        offset += length;
+    }
+
+    if(offset != header.numTextBytes || uniqueValueIndex.size() != uniqueValues.size())
+        return false;
+
+    // Every code must be missing or refer to one of the unique values
+    const auto numUniqueValues = static_cast<quint32>(uniqueValues.size());
+    bool codesValid = true;
+
+    codes.visit([&](const auto* values, const size_t numValues, const quint32 missing)
+    {
+        for(size_t i = 0; codesValid && i<numValues; ++i)
+            codesValid = values[i] == missing || values[i] < numUniqueValues;
+    });
+
+    return codesValid;
+}
+
+
+size_t ComponentDatabase::CategoryCodes::size(void) const
+{
+    switch (width)
+    {
+    case 1 :
+        return codes8.size();
+    case 2 :
+        return codes16.size();
+    default :
+        return codes32.size();
+    }
+}
+
+
+quint32 ComponentDatabase::CategoryCodes::get(const size_t row) const
+{
+    if(row >= this->size())
+        return missingCode;
+
+    // Map the missing value of each width to the common missing code
+    switch (width)
+    {
+    case 1 :
+        return codes8[row] == 0xFF ? missingCode : codes8[row];
+    case 2 :
+        return codes16[row] == 0xFFFF ? missingCode : codes16[row];
+    default :
+        return codes32[row];
+    }
+}
+
+
+void ComponentDatabase::CategoryCodes::set(const size_t row, const quint32 code)
+{
+    if(code != missingCode)
+    {
+        while((width == 1 && code >= 0xFF) || (width == 2 && code >= 0xFFFF))
+            this->widen();
+    }
+
+    const size_t minSize = row + 1;
+
+    switch (width)
+    {
+    case 1 :
+        if(codes8.size() < minSize)
+            codes8.resize(minSize, 0xFF);
+        codes8[row] = static_cast<quint8>(code == missingCode ? 0xFF : code);
+        break;
+    case 2 :
+        if(codes16.size() < minSize)
+            codes16.resize(minSize, 0xFFFF);
+        codes16[row] = static_cast<quint16>(code == missingCode ? 0xFFFF : code);
+        break;
+    default :
+        if(codes32.size() < minSize)
+            codes32.resize(minSize, missingCode);
+        codes32[row] = code;
+        break;
+    }
+}
+
+
+int ComponentDatabase::CategoryCodes::getWidth(void) const
+{
+    return width;
+}
+
+
+void ComponentDatabase::CategoryCodes::resize(const int codeWidth, const size_t numCodes)
+{
+    this->clear();
+
+    width = codeWidth;
+
+    switch (width)
+    {
+    case 1 :
+        codes8.resize(numCodes, 0xFF);
+        break;
+    case 2 :
+        codes16.resize(numCodes, 0xFFFF);
+        break;
+    default :
+        codes32.resize(numCodes, missingCode);
+        break;
+    }
+}
+
+
+void* ComponentDatabase::CategoryCodes::data(void)
+{
+    switch (width)
+    {
+    case 1 :
+        return codes8.data();
+    case 2 :
+        return codes16.data();
+    default :
+        return codes32.data();
+    }
+}
+
+
+void ComponentDatabase::CategoryCodes::clear(void)
+{
+    width = 1;
+
+    std::vector<quint8>().swap(codes8);
+    std::vector<quint16>().swap(codes16);
+    std::vector<quint32>().swap(codes32);
+}
+
+
+void ComponentDatabase::CategoryCodes::widen(void)
+{
+    const auto numRows = this->size();
+
+    if(width == 1)
+    {
+        codes16.resize(numRows);
+
+        for(size_t i = 0; i<numRows; ++i)
+            codes16[i] = codes8[i] == 0xFF ? 0xFFFF : codes8[i];
+
+        std::vector<quint8>().swap(codes8);
+
+        width = 2;
+    }
+    else if(width == 2)
+    {
+        codes32.resize(numRows);
+
+        for(size_t i = 0; i<numRows; ++i)
+            codes32[i] = codes16[i] == 0xFFFF ? missingCode : codes16[i];
+
+        std::vector<quint16>().swap(codes16);
+
+        width = 4;
+    }
+}
+
 
 ComponentDatabase::ComponentDatabase()
 {
@@ -44,51 +724,877 @@ ComponentDatabase::ComponentDatabase()
 }
 
 
-int ComponentDatabase::getNumberOfComponents()
+int ComponentDatabase::getNumberOfComponents() const
+{
+    return static_cast<int>(IDs.size());
+}
+
+
+void ComponentDatabase::reserve(const int numComponents)
+{
+    IDs.reserve(numComponents);
+    UIDs.reserve(numComponents);
+    features.reserve(numComponents);
+
+    IDToRow.reserve(numComponents);
+    UIDToRow.reserve(numComponents);
+}
+
+
+int ComponentDatabase::addComponent(const qint64 ID, const QString& UID, Esri::ArcGISRuntime::Feature* feature)
+{
+    auto row = this->getRow(ID);
+
+    if(row != -1)
+    {
+        UIDToRow.remove(UIDs.at(row));
+        UIDToRow.insert(UID, row);
+
+        UIDs[row] = UID;
+        features[row] = feature;
+
+        return row;
+    }
+
+    row = static_cast<int>(IDs.size());
+
+    IDs.push_back(ID);
+    UIDs.append(UID);
+    features.push_back(feature);
+
+    IDToRow.insert(ID, row);
+    UIDToRow.insert(UID, row);
+
+    this->reserveResultRows(IDs.size());
+
+    // Every column holds one value per component
+    for(auto&& column : attributeColumns)
+        column.resize(IDs.size());
+
+    return row;
+}
+
+
+Component ComponentDatabase::getComponent(const qint64 ID)
+{
+    return Component(this, this->getRow(ID));
+}
+
+
+Component ComponentDatabase::getComponent(const QString UID)
+{
+    return Component(this, this->getRow(UID));
+}
+
+
+Component ComponentDatabase::getComponentAtRow(const int row)
+{
+    return Component(this, row);
+}
+
+
+ComponentDatabase::ComponentIterator ComponentDatabase::begin(void)
+{
+    return ComponentIterator(this, 0);
+}
+
+
+ComponentDatabase::ComponentIterator ComponentDatabase::end(void)
+{
+    return ComponentIterator(this, this->getNumberOfComponents());
+}
+
+
+void ComponentDatabase::clear(void)
+{
+    IDs.clear();
+    UIDs.clear();
+    features.clear();
+    IDToRow.clear();
+    UIDToRow.clear();
+
+    attributeNames.clear();
+    attributeIndex.clear();
+    attributeColumns.clear();
+
+    this->clearDirty();
+
+    resultNames.clear();
+    resultIndex.clear();
+    resultValues.clear();
+    resultStride = 0;
+
+    envelopes.clear();
+    footprints.clear();
+    spatialIndex.clear();
+    spatialIndexRows.clear();
+}
+
+
+void ComponentDatabase::updateComponentAttribute(const qint64 ID, const QString& attribute, const QVariant& value)
+{
+    auto component = this->getComponent(ID);
+
+    component.setAttributeValue(attribute,value);
+}
+
+
+int ComponentDatabase::updateAttributes(const QVector<qint64>& IDs, const QString& attribute, const QVector<QVariant>& values, QString& err)
+{
+    if(IDs.size() != values.size())
+    {
+        err = "The number of component IDs "+QString::number(IDs.size())+" does not match the number of values "+QString::number(values.size());
+        return -1;
+    }
+
+    auto attributeIndex = this->addAttribute(attribute);
+
+    // Features that belong to the same table are updated together
+    QHash<Esri::ArcGISRuntime::FeatureTable*, QList<Esri::ArcGISRuntime::Feature*>> updatedFeatures;
+
+    for(int i = 0; i<IDs.size(); ++i)
+    {
+        auto row = this->getRow(IDs.at(i));
+
+        if(row == -1)
+        {
+            err = "Could not find the component ID "+QString::number(IDs.at(i))+" in the database";
+            return -1;
+        }
+
+        auto value = values.at(i);
+
+        this->setAttributeValue(row, attributeIndex, value);
+        this->setDirty(row, attributeIndex);
+
+        auto feature = features[row];
+
+        if(feature == nullptr)
+            continue;
+
+        feature->attributes()->replaceAttribute(attribute,value);
+
+        updatedFeatures[feature->featureTable()].append(feature);
+    }
+
+    for(auto it = updatedFeatures.begin(); it != updatedFeatures.end(); ++it)
+        it.key()->updateFeatures(it.value());
+
+    return 0;
+}
+
+
+int ComponentDatabase::getRow(const qint64 ID) const
+{
+    return IDToRow.value(ID, -1);
+}
+
+
+int ComponentDatabase::getRow(const QString& UID) const
+{
+    return UIDToRow.value(UID, -1);
+}
+
+
+qint64 ComponentDatabase::getID(const int row) const
+{
+    return IDs[row];
+}
+
+
+ComponentSelection ComponentDatabase::getIDs(void) const
+{
+    ComponentSelection selection;
+    selection.insert(IDs);
+
+    return selection;
+}
+
+
+QString ComponentDatabase::getUID(const int row) const
+{
+    return UIDs.at(row);
+}
+
+
+Esri::ArcGISRuntime::Feature* ComponentDatabase::getFeature(const int row) const
+{
+    return features[row];
+}
+
+
+void ComponentDatabase::setFeature(const int row, Esri::ArcGISRuntime::Feature* feature)
+{
+    features[row] = feature;
+}
+
+
+int ComponentDatabase::addAttribute(const QString& name)
+{
+    auto it = attributeIndex.constFind(name);
+    if(it != attributeIndex.constEnd())
+        return it.value();
+
+    auto index = static_cast<int>(attributeColumns.size());
+
+    attributeNames.append(name);
+    attributeIndex.insert(name, index);
+    attributeColumns.push_back(AttributeColumn());
+
+    return index;
+}
+
+
+int ComponentDatabase::getAttributeIndex(const QString& name) const
+{
+    return attributeIndex.value(name, -1);
+}
+
+
+int ComponentDatabase::addCategoricalAttribute(const QString& name)
+{
+    auto index = this->addAttribute(name);
+
+    auto& column = attributeColumns[index];
+
+    // The type can only be set before the column holds any values
+    if(column.type == AttributeColumn::Empty)
+    {
+        column.type = AttributeColumn::String;
+        column.categorical = true;
+        column.resize(IDs.size());
+    }
+
+    return index;
+}
+
+
+bool ComponentDatabase::isCategoricalAttribute(const int attribute) const
+{
+    return attributeColumns[attribute].categorical;
+}
+
+
+QStringList ComponentDatabase::getCategories(const int attribute) const
+{
+    return attributeColumns[attribute].uniqueValues;
+}
+
+
+int ComponentDatabase::getCategoryCode(const int row, const int attribute) const
+{
+    const auto& column = attributeColumns[attribute];
+
+    if(column.type != AttributeColumn::String)
+        return -1;
+
+    auto code = column.codes.get(row);
+
+    return code == missingCode ? -1 : static_cast<int>(code);
+}
+
+
+QVector<QVector<int>> ComponentDatabase::groupBy(const int attribute) const
+{
+    const auto& column = attributeColumns[attribute];
+
+    QVector<QVector<int>> groups(column.uniqueValues.size());
+
+    if(column.type != AttributeColumn::String)
+        return groups;
+
+    const auto numRows = std::min(column.codes.size(), IDs.size());
+
+    for(size_t i = 0; i<numRows; ++i)
+    {
+        auto code = column.codes.get(i);
+
+        if(code != missingCode)
+            groups[static_cast<int>(code)].append(static_cast<int>(i));
+    }
+
+    return groups;
+}
+
+
+QStringList ComponentDatabase::getAttributeNames(void) const
 {
-    return ComponentMap.size();
+    return attributeNames;
 }
 
 
-void ComponentDatabase::addComponent(int ID, Component& asset)
+QVariant ComponentDatabase::getAttributeValue(const int row, const int attribute) const
 {
-    ComponentMap.insert(ID, asset);
+    return attributeColumns[attribute].getValue(row);
 }
 
 
-Component& ComponentDatabase::getComponent(const int ID)
+QString ComponentDatabase::getAttributeText(const int row, const int attribute) const
 {
-    return ComponentMap[ID];
+    return ComponentDatabase::toText(attributeColumns[attribute].getValue(row));
 }
 
 
-Component ComponentDatabase::getComponent(const QString UID)
+QString ComponentDatabase::toText(const QVariant& value)
+{
+    if(value.type() != QVariant::Double)
+        return value.toString();
+
+    // Write the numbers in full unless they are very large or very small, e.g., 1000000 and not 1e+06
+    auto number = value.toDouble();
+    auto magnitude = std::abs(number);
+
+    if(number == 0.0 || (magnitude >= 1.0e-5 && magnitude < 1.0e15))
+        return QString::number(number, 'f', QLocale::FloatingPointShortest);
+
+    return QString::number(number, 'g', QLocale::FloatingPointShortest);
+}
+
+
+const double* ComponentDatabase::getAttributeColumn(const int attribute) const
+{
+    if(attribute < 0 || static_cast<size_t>(attribute) >= attributeColumns.size())
+        return nullptr;
+
+    auto&& column = attributeColumns[attribute];
+
+    if(column.type != AttributeColumn::Double)
+        return nullptr;
+
+    return column.doubles.data();
+}
+
+
+void ComponentDatabase::setAttributeValue(const int row, const int attribute, const QVariant& value)
+{
+    auto& column = attributeColumns[attribute];
+
+    // The first value sets the type of the column, which is then filled to the number of components
+    column.setValue(row, value);
+    column.resize(IDs.size());
+}
+
+
+void ComponentDatabase::setDirty(const int row, const int attribute)
+{
+    if(dirtyRows.size() < attributeColumns.size())
+        dirtyRows.resize(attributeColumns.size());
+
+    auto& rows = dirtyRows[attribute];
+
+    if(rows.size() < IDs.size())
+        rows.resize(IDs.size(), 0);
+
+    rows[row] = 1;
+}
+
+
+bool ComponentDatabase::isDirty(void) const
 {
-    for(auto&& it: ComponentMap)
+    for(auto&& rows : dirtyRows)
     {
-        if(it.UID.compare(UID) == 0)
-            return it;
+        if(!rows.empty())
+            return true;
     }
 
-    return Component();
+    return false;
 }
 
 
-void ComponentDatabase::clear(void)
+bool ComponentDatabase::isRowDirty(const int row, const QVector<int>& attributes) const
+{
+    const size_t index = static_cast<size_t>(row);
+
+    for(auto&& attribute : attributes)
+    {
+        if(!this->isAttributeDirty(attribute))
+            continue;
+
+        const auto& rows = dirtyRows[attribute];
+
+        if(index < rows.size() && rows[index] != 0)
+            return true;
+    }
+
+    return false;
+}
+
+
+bool ComponentDatabase::isAttributeDirty(const int attribute) const
 {
-    ComponentMap.clear();
+    return attribute >= 0 && static_cast<size_t>(attribute) < dirtyRows.size() && !dirtyRows[attribute].empty();
 }
 
 
-QMap<int, Component> ComponentDatabase::getComponentsMap() const
+int ComponentDatabase::getNumberOfDirtyRows(const QVector<int>& attributes) const
 {
-    return ComponentMap;
+    QVector<int> dirtyAttributes;
+    for(auto&& attribute : attributes)
+    {
+        if(this->isAttributeDirty(attribute))
+            dirtyAttributes.append(attribute);
+    }
+
+    if(dirtyAttributes.isEmpty())
+        return 0;
+
+    int numDirtyRows = 0;
+
+    for(size_t i = 0; i<IDs.size(); ++i)
+    {
+        if(this->isRowDirty(static_cast<int>(i), dirtyAttributes))
+            ++numDirtyRows;
+    }
+
+    return numDirtyRows;
 }
 
 
-void ComponentDatabase::updateComponentAttribute(const int ID, const QString& attribute, const QVariant& value)
+void ComponentDatabase::clearDirty(void)
 {
-    auto component = this->getComponent(ID);
+    dirtyRows.clear();
+}
+
+
+int ComponentDatabase::addResult(const QString& name)
+{
+    auto it = resultIndex.constFind(name);
+    if(it != resultIndex.constEnd())
+        return it.value();
+
+    // Grow the existing columns first, then allocate the new column with the same stride
+    this->reserveResultRows(IDs.size());
+
+    auto index = resultNames.size();
+
+    resultNames.append(name);
+    resultIndex.insert(name, index);
+
+    resultValues.resize(resultValues.size() + resultStride, 0.0);
+
+    return index;
+}
+
+
+int ComponentDatabase::getResultIndex(const QString& name) const
+{
+    return resultIndex.value(name, -1);
+}
+
+
+QStringList ComponentDatabase::getResultNames(void) const
+{
+    return resultNames;
+}
+
+
+double ComponentDatabase::getResultValue(const int row, const int result) const
+{
+    return resultValues[result*resultStride + row];
+}
+
+
+void ComponentDatabase::setResultValue(const int row, const int result, const double value)
+{
+    resultValues[result*resultStride + row] = value;
+}
+
+
+const double* ComponentDatabase::getResultColumn(const int result) const
+{
+    return resultValues.data() + result*resultStride;
+}
+
+
+int ComponentDatabase::getNumberOfResults(void) const
+{
+    return resultNames.size();
+}
+
+
+void ComponentDatabase::clearResults(void)
+{
+    std::fill(resultValues.begin(), resultValues.end(), 0.0);
+}
+
+
+void ComponentDatabase::reserveResultRows(const size_t numRows)
+{
+    if(numRows <= resultStride)
+        return;
+
+    const size_t numColumns = static_cast<size_t>(resultNames.size());
+
+    // Grow geometrically so that adding components one at a time does not move the matrix every time
+    auto newStride = numColumns == 0 ? numRows : std::max(numRows, 2*resultStride);
+
+    std::vector<double> newValues(numColumns*newStride, 0.0);
+
+    for(size_t i = 0; i<numColumns; ++i)
+        std::copy(resultValues.begin() + i*resultStride, resultValues.begin() + (i+1)*resultStride, newValues.begin() + i*newStride);
+
+    resultValues.swap(newValues);
+    resultStride = newStride;
+}
+
+
+void ComponentDatabase::setEnvelope(const int row, const RTreeEnvelope& envelope)
+{
+    const size_t minSize = static_cast<size_t>(row) + 1;
+
+    if(envelopes.size() < minSize)
+    {
+        const auto nan = std::numeric_limits<double>::quiet_NaN();
+        envelopes.resize(minSize, RTreeEnvelope{nan, nan, nan, nan});
+    }
+
+    envelopes[row] = envelope;
+}
+
+
+RTreeEnvelope ComponentDatabase::getEnvelope(const int row) const
+{
+    if(static_cast<size_t>(row) >= envelopes.size())
+    {
+        const auto nan = std::numeric_limits<double>::quiet_NaN();
+        return RTreeEnvelope{nan, nan, nan, nan};
+    }
+
+    return envelopes[row];
+}
+
+
+void ComponentDatabase::setFootprints(FootprintStore&& store)
+{
+    footprints = std::move(store);
+}
+
+
+const FootprintStore& ComponentDatabase::getFootprints(void) const
+{
+    return footprints;
+}
+
+
+void ComponentDatabase::buildSpatialIndex(void)
+{
+    spatialIndexRows.clear();
+
+    std::vector<RTreeEnvelope> indexEnvelopes;
+    indexEnvelopes.reserve(envelopes.size());
+
+    for(size_t i = 0; i<envelopes.size(); ++i)
+    {
+        if(std::isnan(envelopes[i].xMin))
+            continue;
+
+        indexEnvelopes.push_back(envelopes[i]);
+        spatialIndexRows.push_back(static_cast<int>(i));
+    }
+
+    spatialIndex.build(indexEnvelopes);
+}
+
+
+std::vector<int> ComponentDatabase::getRowsInEnvelope(const RTreeEnvelope& envelope) const
+{
+    std::vector<int> rows;
+
+    spatialIndex.visit(envelope, [&](const int item, const RTreeEnvelope&)
+    {
+        rows.push_back(spatialIndexRows[item]);
+        return true;
+    });
+
+    return rows;
+}
+
+
+std::vector<qint64> ComponentDatabase::getIDsInEnvelope(const RTreeEnvelope& envelope) const
+{
+    std::vector<qint64> componentIDs;
+
+    spatialIndex.visit(envelope, [&](const int item, const RTreeEnvelope&)
+    {
+        componentIDs.push_back(IDs[spatialIndexRows[item]]);
+        return true;
+    });
+
+    return componentIDs;
+}
+
+
+std::vector<qint64> ComponentDatabase::getIDsInPolygon(const QVector<QPointF>& polygon) const
+{
+    std::vector<qint64> componentIDs;
+
+    if(polygon.size() < 3)
+        return componentIDs;
+
+    // Only the components that intersect the bounding box of the polygon need to be tested against the polygon
+    RTreeEnvelope polygonEnvelope{polygon.first().x(), polygon.first().y(), polygon.first().x(), polygon.first().y()};
+    for(auto&& it : polygon)
+        polygonEnvelope.expand(RTreeEnvelope{it.x(), it.y(), it.x(), it.y()});
+
+    spatialIndex.visit(polygonEnvelope, [&](const int item, const RTreeEnvelope& envelope)
+    {
+        // The component is taken to be within the polygon if all of the corners of its envelope are
+        if(polygonEnvelope.contains(envelope) &&
+                isPointInPolygon(envelope.xMin, envelope.yMin, polygon) && isPointInPolygon(envelope.xMax, envelope.yMin, polygon) &&
+                isPointInPolygon(envelope.xMax, envelope.yMax, polygon) && isPointInPolygon(envelope.xMin, envelope.yMax, polygon))
+            componentIDs.push_back(IDs[spatialIndexRows[item]]);
+
+        return true;
+    });
+
+    return componentIDs;
+}
+
+
+bool ComponentDatabase::loadCache(const QString& pathToFile, const char* data, const qint64 size, const QString& UIDPrefix)
+{
+    this->clear();
+
+    QFileInfo fileInfo(pathToFile);
+
+    auto canonicalPath = fileInfo.canonicalFilePath().toUtf8();
+
+    if(canonicalPath.isEmpty())
+        return false;
+
+    auto lastModified = fileInfo.lastModified().toMSecsSinceEpoch();
+
+    // Only hash the contents if the rest of the key matches
+    quint64 hash = 0;
+    bool hashComputed = false;
+
+    for(auto&& cachePath : CSVIndexCache::cachePaths(pathToFile, "r2dcomponents"))
+    {
+        QFile cacheFile(cachePath);
+
+        if(!cacheFile.open(QIODevice::ReadOnly))
+            continue;
+
+        // The cache is memory-mapped and the arrays are copied straight out of the mapping, nothing is parsed or converted
+        // The columns keep their own copy because they are edited and grow as components and results are added
+        const qint64 cacheSize = cacheFile.size();
+        const char* cacheData = cacheSize > 0 ? reinterpret_cast<const char*>(cacheFile.map(0, cacheSize)) : nullptr;
+
+        if(cacheData == nullptr)
+            continue;
+
+        // Returns the next numBytes bytes of the cache, or nullptr if the cache is truncated
+        qint64 cachePos = 0;
+        auto readBytes = [&](const qint64 numBytes) -> const char*
+        {
+            if(numBytes < 0 || numBytes > cacheSize - cachePos)
+                return nullptr;
+
+            const char* bytes = cacheData + cachePos;
+            cachePos += numBytes;
+
+            return bytes;
+        };
+
+        auto readArray = [&](auto& values, const qint64 numValues)
+        {
+            const qint64 numBytes = static_cast<qint64>(sizeof(values[0]))*numValues;
+
+            const char* bytes = readBytes(numBytes);
+            if(bytes == nullptr)
+                return false;
+
+            values.resize(static_cast<size_t>(numValues));
+
+            if(numBytes > 0)
+                std::memcpy(values.data(), bytes, static_cast<size_t>(numBytes));
+
+            return true;
+        };
+
+        const char* headerBytes = readBytes(sizeof(CacheHeader));
+        if(headerBytes == nullptr)
+            continue;
+
+        CacheHeader header;
+        std::memcpy(&header, headerBytes, sizeof(CacheHeader));
+
+        bool isValid = std::memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) == 0 &&
+                header.version == cacheVersion &&
+                header.fileSize == size &&
+                header.lastModified == lastModified &&
+                header.numRows >= 0 && header.numRows <= std::numeric_limits<int>::max() &&
+                header.numAttributes >= 0 &&
+                header.pathLength == quint32(canonicalPath.size());
+
+        if(isValid)
+        {
+            const char* path = readBytes(header.pathLength);
+            isValid = path != nullptr && std::memcmp(path, canonicalPath.constData(), header.pathLength) == 0;
+        }
+
+        if(isValid)
+        {
+            if(!hashComputed)
+            {
+                hash = CSVIndexCache::contentHash(data, size);
+                hashComputed = true;
+            }
+
+            isValid = header.contentHash == hash;
+        }
+
+        if(!isValid)
+            continue;
+
+        bool OK = readArray(IDs, header.numRows);
+
+        for(qint64 i = 0; OK && i<header.numAttributes; ++i)
+        {
+            qint64 nameLength = 0;
+
+            const char* nameLengthBytes = readBytes(sizeof(nameLength));
+            if(nameLengthBytes != nullptr)
+                std::memcpy(&nameLength, nameLengthBytes, sizeof(nameLength));
+
+            const char* name = nameLengthBytes != nullptr && nameLength <= std::numeric_limits<int>::max() ? readBytes(nameLength) : nullptr;
+
+            if(name == nullptr)
+            {
+                OK = false;
+                break;
+            }
+
+            auto index = this->addAttribute(QString::fromUtf8(name, static_cast<int>(nameLength)));
+
+            OK = index == i && attributeColumns[index].read(readBytes, header.numRows);
+        }
+
+        qint64 numEnvelopes = 0;
+        const char* numEnvelopesBytes = OK ? readBytes(sizeof(numEnvelopes)) : nullptr;
+        if(numEnvelopesBytes != nullptr)
+            std::memcpy(&numEnvelopes, numEnvelopesBytes, sizeof(numEnvelopes));
+
+        OK = numEnvelopesBytes != nullptr && numEnvelopes >= 0 && numEnvelopes <= header.numRows && readArray(envelopes, numEnvelopes);
+
+        qint64 numIndexRows = 0;
+        const char* numIndexRowsBytes = OK ? readBytes(sizeof(numIndexRows)) : nullptr;
+        if(numIndexRowsBytes != nullptr)
+            std::memcpy(&numIndexRows, numIndexRowsBytes, sizeof(numIndexRows));
+
+        OK = numIndexRowsBytes != nullptr && numIndexRows >= 0 && numIndexRows <= numEnvelopes && readArray(spatialIndexRows, numIndexRows);
+
+        OK = OK && spatialIndex.read(readBytes) && spatialIndex.size() == numIndexRows && cachePos == cacheSize;
+
+        // Every row in the spatial index must be a row with an envelope
+        for(size_t i = 0; OK && i<spatialIndexRows.size(); ++i)
+            OK = spatialIndexRows[i] >= 0 && spatialIndexRows[i] < numEnvelopes;
+
+        if(!OK)
+        {
+            this->clear();
+            continue;
+        }
+
+        // The hash indexes are filled from the stored IDs, which were checked to be unique before they were cached
+        const auto numRows = static_cast<int>(header.numRows);
+
+        UIDs.reserve(numRows);
+        features.assign(static_cast<size_t>(numRows), nullptr);
+        IDToRow.reserve(numRows);
+        UIDToRow.reserve(numRows);
+
+        for(int row = 0; row<numRows; ++row)
+        {
+            auto UID = UIDPrefix + QString::number(row);
+
+            UIDs.append(UID);
+
+            IDToRow.insert(IDs[row], row);
+            UIDToRow.insert(UID, row);
+        }
+
+        if(IDToRow.size() != numRows)
+        {
+            this->clear();
+            continue;
+        }
+
+        this->reserveResultRows(IDs.size());
+
+        return true;
+    }
+
+    return false;
+}
+
+
+bool ComponentDatabase::saveCache(const QString& pathToFile, const char* data, const qint64 size) const
+{
+    for(auto&& column : attributeColumns)
+    {
+        if(column.type == AttributeColumn::Variant)
+            return false;
+    }
+
+    QFileInfo fileInfo(pathToFile);
+
+    auto canonicalPath = fileInfo.canonicalFilePath().toUtf8();
+
+    if(canonicalPath.isEmpty())
+        return false;
+
+    CacheHeader header;
+    std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+    header.version = cacheVersion;
+    header.pathLength = quint32(canonicalPath.size());
+    header.fileSize = size;
+    header.lastModified = fileInfo.lastModified().toMSecsSinceEpoch();
+    header.contentHash = CSVIndexCache::contentHash(data, size);
+    header.numRows = static_cast<qint64>(IDs.size());
+    header.numAttributes = static_cast<qint64>(attributeColumns.size());
+
+    const qint64 numEnvelopes = static_cast<qint64>(envelopes.size());
+    const qint64 numIndexRows = static_cast<qint64>(spatialIndexRows.size());
+
+    for(auto&& cachePath : CSVIndexCache::cachePaths(pathToFile, "r2dcomponents"))
+    {
+        QDir().mkpath(QFileInfo(cachePath).absolutePath());
+
+        // The cache only replaces an existing cache once it is written in full
+        QSaveFile cacheFile(cachePath);
+
+        if(!cacheFile.open(QIODevice::WriteOnly))
+            continue;
+
+        auto writeBytes = [&cacheFile](const void* bytes, const qint64 numBytes)
+        {
+            return numBytes == 0 || cacheFile.write(reinterpret_cast<const char*>(bytes), numBytes) == numBytes;
+        };
+
+        bool OK = writeBytes(&header, sizeof(CacheHeader)) &&
+                writeBytes(canonicalPath.constData(), canonicalPath.size()) &&
+                writeBytes(IDs.data(), 8*header.numRows);
+
+        for(size_t i = 0; OK && i<attributeColumns.size(); ++i)
+        {
+            auto name = attributeNames.at(static_cast<int>(i)).toUtf8();
+            const qint64 nameLength = name.size();
+
+            OK = writeBytes(&nameLength, sizeof(nameLength)) && writeBytes(name.constData(), nameLength) && attributeColumns[i].write(writeBytes);
+        }
+
+        OK = OK && writeBytes(&numEnvelopes, sizeof(numEnvelopes)) &&
+                writeBytes(envelopes.data(), static_cast<qint64>(sizeof(RTreeEnvelope))*numEnvelopes) &&
+                writeBytes(&numIndexRows, sizeof(numIndexRows)) &&
+                writeBytes(spatialIndexRows.data(), 4*numIndexRows) &&
+                spatialIndex.write(writeBytes);
+
+        if(OK && cacheFile.commit())
+            return true;
+
+        cacheFile.cancelWriting();
+    }
 
-   component.setAttributeValue(attribute,value);
+    return false;
 }
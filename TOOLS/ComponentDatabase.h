@@ -38,12 +38,21 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 // Written by: Stevan Gavrilovic
 
-#include <QMap>
+#include <QHash>
+#include <QPointF>
+#include <QStringList>
 #include <QVariant>
+#include <QVector>
+
+#include "ComponentSelection.h"
+#include "FootprintStore.h"
+#include "RTree.h"
 
 #include <Feature.h>
 #include <FeatureTable.h>
 
+#include <vector>
+
 namespace Esri
 {
 namespace ArcGISRuntime
@@ -52,92 +61,358 @@ class Feature;
 }
 }
 
-struct Component
+class ComponentDatabase;
+
+// Lightweight view of a component (row) in the component database
+// The view does not hold any data itself, it is cheap to copy and remains valid until the database is cleared
+class Component
 {
 public:
+    Component(ComponentDatabase* database = nullptr, const int row = -1);
 
-    void addResult(const QString& key, const double res)
-    {
-        ResultsValues.insert(key,res);
-    }
+    void addResult(const QString& key, const double res);
 
-    QVariant getAttributeValue(const QString& key)
-    {
-        return ComponentAttributes.value(key);
-    }
+    QVariant getAttributeValue(const QString& key) const;
 
-    double getResultValue(const QString& key)
-    {
-        return ResultsValues.value(key);
-    }
+    // Returns the default value if the component does not have the attribute
+    QVariant getAttributeValue(const QString& key, const QVariant& defaultValue) const;
 
-    int setAttributeValue(const QString& attribute, const QVariant& value)
-    {
-        ComponentAttributes[attribute] = value;
+    double getResultValue(const QString& key) const;
 
-        if(ComponentFeature != nullptr)
-        {
-            ComponentFeature->attributes()->replaceAttribute(attribute,value);
-            ComponentFeature->featureTable()->updateFeature(ComponentFeature);
-
-            if(ComponentFeature->attributes()->attributeValue(attribute).isNull())
-            {
-                qDebug()<<"Failed to update feature "<<attribute<<" in component "<<ID;
-                return -1;
-            }
-        }
+    // Sets the attribute in the database and in the feature of the component
+    int setAttributeValue(const QString& attribute, const QVariant& value);
 
-        return 0;
-    }
+    // True if the component exists in the database, whether or not it has a feature on the map
+    bool isValid(void) const;
 
-    bool isValid(void)
-    {
-        if(ComponentFeature == nullptr || ComponentAttributes.empty())
-            return false;
+    // Row of the component in the database, -1 if the component does not exist
+    int getRow(void) const;
 
-        return true;
-    }
-
-    int ID = -1;
+    // Returns -1 if the component does not exist
+    qint64 getID(void) const;
 
     // Unique id of this component
-    QString UID = "NULL";
+    QString getUID(void) const;
 
     // The Component feature in the GIS widget
-    Esri::ArcGISRuntime::Feature* ComponentFeature = nullptr;
+    Esri::ArcGISRuntime::Feature* getFeature(void) const;
 
-    // Map to store the Component attributes
-    QMap<QString, QVariant> ComponentAttributes;
+private:
 
-    // Map to store the results - the QString (key) is the header text while the double is the value for that Component
-    QMap<QString, double> ResultsValues;
+    ComponentDatabase* theDatabase;
+    int row;
 };
 
 
+// Stores the components as a structure of arrays: one column per attribute, where each attribute name is stored once, and the components are addressed by their row
+// Numeric attributes are stored as doubles, text attributes are stored once per unique value, and anything else is stored as a QVariant
 class ComponentDatabase
 {
 public:
     ComponentDatabase();
 
-    // Gets the Component as a modifiable reference
-    Component& getComponent(const int ID);
+    // Iterates over the components in the order they were added, yielding a view of each component
+    class ComponentIterator
+    {
+    public:
+        ComponentIterator(ComponentDatabase* database, const int row) : theDatabase(database), row(row) {}
+
+        Component operator*() const { return Component(theDatabase, row); }
+        ComponentIterator& operator++() { ++row; return *this; }
+        bool operator==(const ComponentIterator& other) const { return row == other.row && theDatabase == other.theDatabase; }
+        bool operator!=(const ComponentIterator& other) const { return !(*this == other); }
+
+    private:
+        ComponentDatabase* theDatabase;
+        int row;
+    };
+
+    ComponentIterator begin(void);
+    ComponentIterator end(void);
+
+    // Adds a component and returns its row. If a component with the given ID already exists, its UID and feature are replaced
+    int addComponent(const qint64 ID, const QString& UID, Esri::ArcGISRuntime::Feature* feature = nullptr);
+
+    // Gets a view of the component, the view is not valid if the component does not exist
+    Component getComponent(const qint64 ID);
 
     Component getComponent(const QString UID);
 
-    int getNumberOfComponents();
+    // Gets a view of the component at the given row
+    Component getComponentAtRow(const int row);
+
+    int getNumberOfComponents() const;
 
-    void addComponent(int ID, Component& asset);
+    // Reserves the memory and the ID indexes for the given number of components
+    void reserve(const int numComponents);
 
     void clear(void);
 
-    QMap<int, Component> getComponentsMap() const;
+    void updateComponentAttribute(const qint64 ID, const QString& attribute, const QVariant& value);
+
+    // Sets the attribute of many components at once, the attribute name is looked up once and the features are updated in place
+    // Returns -1 if the number of IDs and values do not match or if a component does not exist
+    int updateAttributes(const QVector<qint64>& IDs, const QString& attribute, const QVector<QVariant>& values, QString& err);
+
+    // Row of the component, -1 if there is no component with the given ID
+    int getRow(const qint64 ID) const;
+
+    // Row of the component, -1 if there is no component with the given UID
+    int getRow(const QString& UID) const;
+
+    qint64 getID(const int row) const;
+
+    // Returns all of the component IDs as a selection, the consecutive IDs are stored as ranges
+    ComponentSelection getIDs(void) const;
+    QString getUID(const int row) const;
+
+    Esri::ArcGISRuntime::Feature* getFeature(const int row) const;
+    void setFeature(const int row, Esri::ArcGISRuntime::Feature* feature);
+
+    // Returns the index of the attribute with the given name, adding the attribute if it does not exist
+    int addAttribute(const QString& name);
+
+    // Returns the index of the attribute with the given name, -1 if it does not exist
+    int getAttributeIndex(const QString& name) const;
+
+    // Adds an attribute where every value is stored as text and encoded as a code into the unique values of the attribute
+    // Use for attributes that repeat a handful of values, e.g., the occupancy class or the structure type
+    int addCategoricalAttribute(const QString& name);
+
+    // True if the attribute was added with addCategoricalAttribute
+    bool isCategoricalAttribute(const int attribute) const;
+
+    // Returns the unique values of a text attribute, the position of each value in the list is its code
+    QStringList getCategories(const int attribute) const;
+
+    // Returns the code of the value of a text attribute, -1 if the value is missing or the attribute is not text
+    int getCategoryCode(const int row, const int attribute) const;
+
+    // Groups the rows by the value of a text attribute, the groups are in the same order as the categories and rows with missing values are left out
+    QVector<QVector<int>> groupBy(const int attribute) const;
+
+    QStringList getAttributeNames(void) const;
+
+    QVariant getAttributeValue(const int row, const int attribute) const;
+
+    // Returns the value as it is written in the table and in the output files, an empty text if the value is missing
+    QString getAttributeText(const int row, const int attribute) const;
+
+    // Writes a value as text, the numbers are written in the shortest form that reads back to the same number
+    static QString toText(const QVariant& value);
+
+    // Returns the values of a numeric attribute for all of the components, one value per row where missing values are NaN
+    // Returns nullptr if the attribute is not stored as numbers. The pointer is valid until a value or a component is added
+    const double* getAttributeColumn(const int attribute) const;
+
+    // Sets the value without marking the component as edited, used when loading the components
+    void setAttributeValue(const int row, const int attribute, const QVariant& value);
+
+    // Marks the attribute of the component as edited since the components were loaded
+    // The edits made through a Component view or updateAttributes are marked automatically
+    void setDirty(const int row, const int attribute);
+
+    // True if any component was edited since the components were loaded or since the last call to clearDirty
+    bool isDirty(void) const;
+
+    // True if any of the given attributes of the component was edited, e.g., one of the attributes that are exported
+    // Results written into the components, e.g., the loss ratio, do not make a component dirty for the attributes that are not written out
+    bool isRowDirty(const int row, const QVector<int>& attributes) const;
+    bool isAttributeDirty(const int attribute) const;
+
+    // Number of components where any of the given attributes was edited
+    int getNumberOfDirtyRows(const QVector<int>& attributes) const;
+
+    // Forgets the edits, e.g., once the edited components were saved
+    void clearDirty(void);
+
+    // Returns the index of the result with the given name, adding the result if it does not exist
+    int addResult(const QString& name);
+
+    // Returns the index of the result with the given name, -1 if it does not exist
+    int getResultIndex(const QString& name) const;
+
+    QStringList getResultNames(void) const;
+
+    double getResultValue(const int row, const int result) const;
+    void setResultValue(const int row, const int result, const double value);
 
-    void updateComponentAttribute(const int ID, const QString& attribute, const QVariant& value);
+    // Returns the values of a result for all of the components, one value per row
+    // The pointer is valid until a result or a component is added
+    const double* getResultColumn(const int result) const;
+
+    int getNumberOfResults(void) const;
+
+    // Sets all of the result values to zero but keeps the result columns
+    void clearResults(void);
+
+    // Sets the bounding box of the geometry of the component, in the coordinates of the component features
+    void setEnvelope(const int row, const RTreeEnvelope& envelope);
+
+    // Returns the envelope of the component, the envelope is empty (NaN) if the component has no geometry
+    RTreeEnvelope getEnvelope(const int row) const;
+
+    // The footprints of the components, decoded once when the components are loaded
+    void setFootprints(FootprintStore&& store);
+    const FootprintStore& getFootprints(void) const;
+
+    // Builds the spatial index over the envelopes of the components, call once the components are loaded
+    void buildSpatialIndex(void);
+
+    // Returns the rows of the components whose envelope intersects the given envelope
+    std::vector<int> getRowsInEnvelope(const RTreeEnvelope& envelope) const;
+
+    // Returns the IDs of the components whose envelope intersects the given envelope
+    std::vector<qint64> getIDsInEnvelope(const RTreeEnvelope& envelope) const;
+
+    // Returns the IDs of the components whose envelope lies within the polygon, the polygon is closed automatically
+    std::vector<qint64> getIDsInPolygon(const QVector<QPointF>& polygon) const;
+
+    // Reads the components loaded from a CSV file from the cache, where data and size are the contents of the CSV file. Returns true if an up to date cache was found
+    // The IDs, the typed attribute columns, the envelopes, and the spatial index are read as they were stored, and the components get the UIDs UIDPrefix + row
+    // The cache is kept next to the index cache of the CSV file and is invalidated in the same way, see CSVIndexCache
+    // The cache file is memory-mapped, and a cache that is truncated or holds an index that is out of range is discarded
+    bool loadCache(const QString& pathToFile, const char* data, const qint64 size, const QString& UIDPrefix);
+
+    // Writes the components loaded from the CSV file to the cache, returns true on success
+    // The features, footprints, edits, and results are not cached, and neither is a database with an attribute stored as QVariants
+    bool saveCache(const QString& pathToFile, const char* data, const qint64 size) const;
 
 private:
 
-    QMap<int,Component> ComponentMap;
+    // The filter kernels run directly over the columns
+    friend class ComponentFilter;
+
+    // The category codes of a text column, stored in 8, 16 or 32 bits depending on the number of categories
+    // The largest value that fits is reserved for missing values
+    class CategoryCodes
+    {
+    public:
+        size_t size(void) const;
+
+        quint32 get(const size_t row) const;
+
+        // Widens the codes if the code does not fit in the current width
+        void set(const size_t row, const quint32 code);
+
+        // Number of bytes per code
+        int getWidth(void) const;
+
+        // Sets the width and the number of codes, all of the codes are missing. Used to read the codes from the cache into data()
+        void resize(const int codeWidth, const size_t numCodes);
+        void* data(void);
+
+        // Calls the visitor with a pointer to the codes at the current width, the number of codes, and the code that marks a missing value at this width
+        template <typename Visitor>
+        void visit(Visitor visitor) const
+        {
+            switch (width)
+            {
+            case 1 :
+                visitor(codes8.data(), codes8.size(), static_cast<quint32>(0xFF));
+                break;
+            case 2 :
+                visitor(codes16.data(), codes16.size(), static_cast<quint32>(0xFFFF));
+                break;
+            default :
+                visitor(codes32.data(), codes32.size(), static_cast<quint32>(0xFFFFFFFFu));
+                break;
+            }
+        }
+
+        void clear(void);
+
+    private:
+
+        void widen(void);
+
+        int width = 1;
+
+        std::vector<quint8> codes8;
+        std::vector<quint16> codes16;
+        std::vector<quint32> codes32;
+    };
+
+    // The values of one attribute for all of the components
+    struct AttributeColumn
+    {
+        enum Type {Empty, Double, String, Variant};
+
+        void setValue(const int row, const QVariant& value);
+        QVariant getValue(const int row) const;
+
+        // Converts a column of numbers into a column of text, used when a text is not written as a number
+        void toText(void);
+
+        // Converts the column into a column of QVariants, used when a value cannot be written as text, e.g., a list
+        void toVariant(void);
+
+        // Fills the column with missing values up to the number of rows, the column of a type always holds one value per component
+        void resize(const size_t numRows);
+
+        // Returns the code of the text, adding it to the unique values if it is new
+        quint32 getCode(const QString& str);
+
+        // Writes the column through the writer and reads it back through the reader, see RTree::write and RTree::read. Columns of QVariants cannot be written
+        // A column that does not have a value for each of the numRows rows, or a code that is not one of its unique values, is not read
+        template <typename Writer>
+        bool write(Writer writeBytes) const;
+        template <typename Reader>
+        bool read(Reader readBytes, const qint64 numRows);
+
+        Type type = Empty;
+
+        // Missing values are NaN, empty texts and "NA" are missing values
+        std::vector<double> doubles;
+
+        // Index of each value into the unique values, missing values are marked by missingCode
+        CategoryCodes codes;
+        QStringList uniqueValues;
+        QHash<QString, quint32> uniqueValueIndex;
+
+        // Categorical columns store every value as text, they are never converted to another type
+        bool categorical = false;
+
+        std::vector<QVariant> variants;
+    };
+
+    static const quint32 missingCode = 0xFFFFFFFFu;
+
+    // The IDs do not have to be sequential, e.g., parcel numbers from assessor data
+    std::vector<qint64> IDs;
+    QStringList UIDs;
+    std::vector<Esri::ArcGISRuntime::Feature*> features;
+
+    // Hash indexes to find the row of a component
+    QHash<qint64, int> IDToRow;
+    QHash<QString, int> UIDToRow;
+
+    QStringList attributeNames;
+    QHash<QString, int> attributeIndex;
+    std::vector<AttributeColumn> attributeColumns;
+
+    // Flags of the rows that were edited for each attribute, an attribute that was never edited has no flags so that an unedited database costs nothing
+    std::vector<std::vector<quint8>> dirtyRows;
+
+    // Grows the results matrix so that each column can hold at least the given number of rows
+    void reserveResultRows(const size_t numRows);
+
+    // The results are stored as a dense matrix - the QString (key) is the header text of a column
+    QStringList resultNames;
+    QHash<QString, int> resultIndex;
+
+    // Column-major matrix, column i starts at i*resultStride, the stride grows geometrically as components are added
+    std::vector<double> resultValues;
+    size_t resultStride = 0;
+
+    // Envelopes of the component geometries, rows without a geometry have an empty (NaN) envelope
+    std::vector<RTreeEnvelope> envelopes;
+
+    FootprintStore footprints;
 
+    // The spatial index and the row of each item in the index
+    RTree spatialIndex;
+    std::vector<int> spatialIndexRows;
 };
 
 #endif // ComponentDATABASE_H
@@ -0,0 +1,723 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "ComponentFilter.h"
+#include "ComponentDatabase.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Runs the predicate over a contiguous array of values and writes the result into the mask
+template <typename T, typename Predicate>
+void runKernel(const T* values, const size_t numValues, quint8* mask, Predicate predicate)
+{
+    for(size_t i = 0; i<numValues; ++i)
+        mask[i] = predicate(values[i]) ? 1 : 0;
+}
+
+
+// Numeric comparison kernels, NaN (missing) values never pass
+template <typename T, typename N>
+void runNumericKernel(const T* values, const size_t numValues, quint8* mask, const int op, const N number)
+{
+    switch (op)
+    {
+    case 0 :
+        runKernel(values, numValues, mask, [number](T val) { return val < number; });
+        break;
+    case 1 :
+        runKernel(values, numValues, mask, [number](T val) { return val <= number; });
+        break;
+    case 2 :
+        runKernel(values, numValues, mask, [number](T val) { return val > number; });
+        break;
+    case 3 :
+        runKernel(values, numValues, mask, [number](T val) { return val >= number; });
+        break;
+    case 4 :
+        runKernel(values, numValues, mask, [number](T val) { return val == number; });
+        break;
+    default :
+        runKernel(values, numValues, mask, [number](T val) { return val == val && val != number; });
+        break;
+    }
+}
+
+}
+
+
+ComponentFilter::ComponentFilter() : currentToken(0), root(-1)
+{
+
+}
+
+
+int ComponentFilter::compile(const QString& expression, const ComponentDatabase& database, QString& err)
+{
+    nodes.clear();
+    root = -1;
+
+    if(expression.trimmed().isEmpty())
+        return 0;
+
+    if(this->tokenize(expression, err) != 0)
+        return -1;
+
+    currentToken = 0;
+
+    auto node = this->parseOr(database, err);
+
+    if(node == -1)
+    {
+        nodes.clear();
+        return -1;
+    }
+
+    if(tokens[currentToken].type != Token::End)
+    {
+        err = "Unexpected \"" + tokens[currentToken].text + "\" at position " + QString::number(tokens[currentToken].position + 1) + " of the filter";
+        nodes.clear();
+        return -1;
+    }
+
+    root = node;
+
+    return 0;
+}
+
+
+bool ComponentFilter::isEmpty(void) const
+{
+    return root == -1;
+}
+
+
+std::vector<quint8> ComponentFilter::evaluateMask(const ComponentDatabase& database) const
+{
+    std::vector<quint8> mask(database.getNumberOfComponents(), 0);
+    std::vector<quint8> valid(mask.size(), 0);
+
+    if(root != -1)
+        this->evaluateNode(root, database, mask, valid);
+
+    return mask;
+}
+
+
+std::vector<qint64> ComponentFilter::evaluate(const ComponentDatabase& database) const
+{
+    std::vector<qint64> componentIDs;
+
+    if(root == -1)
+        return componentIDs;
+
+    auto mask = this->evaluateMask(database);
+
+    for(size_t i = 0; i<mask.size(); ++i)
+    {
+        if(mask[i])
+            componentIDs.push_back(database.IDs[i]);
+    }
+
+    return componentIDs;
+}
+
+
+int ComponentFilter::tokenize(const QString& expression, QString& err)
+{
+    tokens.clear();
+
+    const int length = expression.size();
+
+    int i = 0;
+    while(i < length)
+    {
+        const QChar c = expression.at(i);
+
+        if(c.isSpace())
+        {
+            ++i;
+            continue;
+        }
+
+        Token token;
+        token.position = i;
+
+        if(c == '"' || c == '\'')
+        {
+            // Quoted string, the quotes are not part of the value
+            auto end = expression.indexOf(c, i + 1);
+
+            if(end == -1)
+            {
+                err = "Missing the closing quote of the string at position " + QString::number(i + 1) + " of the filter";
+                return -1;
+            }
+
+            token.type = Token::String;
+            token.text = expression.mid(i + 1, end - i - 1);
+            i = end + 1;
+        }
+        else if(c.isDigit() || ((c == '-' || c == '.') && i + 1 < length && (expression.at(i + 1).isDigit() || expression.at(i + 1) == '.')))
+        {
+            int end = i + 1;
+            while(end < length && (expression.at(end).isLetterOrNumber() || expression.at(end) == '.' ||
+                                   ((expression.at(end) == '-' || expression.at(end) == '+') && (expression.at(end - 1) == 'e' || expression.at(end - 1) == 'E'))))
+                ++end;
+
+            token.text = expression.mid(i, end - i);
+
+            // Values such as 3A are taken as words
+            bool OK = false;
+            token.text.toDouble(&OK);
+            token.type = OK ? Token::Number : Token::Word;
+
+            i = end;
+        }
+        else if(c.isLetter() || c == '_')
+        {
+            int end = i + 1;
+            while(end < length && (expression.at(end).isLetterOrNumber() || expression.at(end) == '_' || expression.at(end) == '.'))
+                ++end;
+
+            token.type = Token::Word;
+            token.text = expression.mid(i, end - i);
+            i = end;
+        }
+        else
+        {
+            // Two character symbols first
+            const auto twoChars = expression.mid(i, 2);
+
+            if(twoChars == "<=" || twoChars == ">=" || twoChars == "==" || twoChars == "!=" || twoChars == "&&" || twoChars == "||")
+            {
+                token.text = twoChars;
+                i += 2;
+            }
+            else if(QString("<>=!(){},").contains(c))
+            {
+                token.text = c;
+                ++i;
+            }
+            else
+            {
+                err = "Unexpected character \"" + QString(c) + "\" at position " + QString::number(i + 1) + " of the filter";
+                return -1;
+            }
+
+            token.type = Token::Symbol;
+        }
+
+        tokens.push_back(token);
+    }
+
+    Token end;
+    end.type = Token::End;
+    end.text = "end of the filter";
+    end.position = length;
+
+    tokens.push_back(end);
+
+    return 0;
+}
+
+
+bool ComponentFilter::isSymbol(const QString& symbol) const
+{
+    const auto& token = tokens[currentToken];
+
+    return token.type == Token::Symbol && token.text == symbol;
+}
+
+
+bool ComponentFilter::isKeyword(const QString& keyword) const
+{
+    const auto& token = tokens[currentToken];
+
+    return token.type == Token::Word && token.text.compare(keyword, Qt::CaseInsensitive) == 0;
+}
+
+
+int ComponentFilter::addNode(const Node& node)
+{
+    nodes.push_back(node);
+
+    return static_cast<int>(nodes.size()) - 1;
+}
+
+
+int ComponentFilter::parseOr(const ComponentDatabase& database, QString& err)
+{
+    auto left = this->parseAnd(database, err);
+
+    while(left != -1 && (this->isSymbol("||") || this->isKeyword("or")))
+    {
+        ++currentToken;
+
+        auto right = this->parseAnd(database, err);
+
+        if(right == -1)
+            return -1;
+
+        Node node;
+        node.type = Node::Or;
+        node.left = left;
+        node.right = right;
+
+        left = this->addNode(node);
+    }
+
+    return left;
+}
+
+
+int ComponentFilter::parseAnd(const ComponentDatabase& database, QString& err)
+{
+    auto left = this->parseUnary(database, err);
+
+    while(left != -1 && (this->isSymbol("&&") || this->isKeyword("and")))
+    {
+        ++currentToken;
+
+        auto right = this->parseUnary(database, err);
+
+        if(right == -1)
+            return -1;
+
+        Node node;
+        node.type = Node::And;
+        node.left = left;
+        node.right = right;
+
+        left = this->addNode(node);
+    }
+
+    return left;
+}
+
+
+int ComponentFilter::parseUnary(const ComponentDatabase& database, QString& err)
+{
+    if(this->isSymbol("!") || this->isKeyword("not"))
+    {
+        ++currentToken;
+
+        auto child = this->parseUnary(database, err);
+
+        if(child == -1)
+            return -1;
+
+        Node node;
+        node.type = Node::Not;
+        node.left = child;
+
+        return this->addNode(node);
+    }
+
+    if(this->isSymbol("("))
+    {
+        ++currentToken;
+
+        auto node = this->parseOr(database, err);
+
+        if(node == -1)
+            return -1;
+
+        if(!this->isSymbol(")"))
+        {
+            err = "Missing a closing parenthesis at position " + QString::number(tokens[currentToken].position + 1) + " of the filter";
+            return -1;
+        }
+
+        ++currentToken;
+
+        return node;
+    }
+
+    return this->parseComparison(database, err);
+}
+
+
+int ComponentFilter::parseComparison(const ComponentDatabase& database, QString& err)
+{
+    const auto& nameToken = tokens[currentToken];
+
+    if(nameToken.type != Token::Word && nameToken.type != Token::String)
+    {
+        err = "Expected an attribute name at position " + QString::number(nameToken.position + 1) + " of the filter, found \"" + nameToken.text + "\"";
+        return -1;
+    }
+
+    Node node;
+    node.type = Node::Compare;
+
+    node.attribute = database.getAttributeIndex(nameToken.text);
+
+    if(node.attribute == -1)
+    {
+        if(nameToken.text.compare("ID", Qt::CaseInsensitive) != 0)
+        {
+            err = "The attribute \"" + nameToken.text + "\" in the filter does not exist";
+            return -1;
+        }
+
+        node.attribute = idAttribute;
+    }
+
+    ++currentToken;
+
+    auto readValue = [&]() -> bool
+    {
+        const auto& valueToken = tokens[currentToken];
+
+        if(valueToken.type == Token::End || valueToken.type == Token::Symbol)
+        {
+            err = "Expected a value at position " + QString::number(valueToken.position + 1) + " of the filter, found \"" + valueToken.text + "\"";
+            return false;
+        }
+
+        bool OK = false;
+        auto number = valueToken.text.toDouble(&OK);
+
+        // Quoted values are always compared as text
+        if(!OK || valueToken.type == Token::String)
+            number = std::numeric_limits<double>::quiet_NaN();
+
+        node.values.append(valueToken.text);
+        node.numbers.push_back(number);
+
+        ++currentToken;
+
+        return true;
+    };
+
+    if(this->isKeyword("in"))
+    {
+        ++currentToken;
+
+        node.type = Node::In;
+
+        if(!this->isSymbol("{"))
+        {
+            err = "Expected \"{\" after \"in\" at position " + QString::number(tokens[currentToken].position + 1) + " of the filter";
+            return -1;
+        }
+
+        ++currentToken;
+
+        while(true)
+        {
+            if(!readValue())
+                return -1;
+
+            if(this->isSymbol(","))
+            {
+                ++currentToken;
+                continue;
+            }
+
+            if(this->isSymbol("}"))
+            {
+                ++currentToken;
+                break;
+            }
+
+            err = "Expected \",\" or \"}\" at position " + QString::number(tokens[currentToken].position + 1) + " of the filter";
+            return -1;
+        }
+    }
+    else
+    {
+        const auto& opToken = tokens[currentToken];
+
+        if(opToken.type != Token::Symbol)
+        {
+            err = "Expected a comparison after \"" + nameToken.text + "\" at position " + QString::number(opToken.position + 1) + " of the filter";
+            return -1;
+        }
+
+        if(opToken.text == "<")
+            node.op = Less;
+        else if(opToken.text == "<=")
+            node.op = LessEqual;
+        else if(opToken.text == ">")
+            node.op = Greater;
+        else if(opToken.text == ">=")
+            node.op = GreaterEqual;
+        else if(opToken.text == "==" || opToken.text == "=")
+            node.op = Equal;
+        else if(opToken.text == "!=")
+            node.op = NotEqual;
+        else
+        {
+            err = "Expected a comparison after \"" + nameToken.text + "\" at position " + QString::number(opToken.position + 1) + " of the filter";
+            return -1;
+        }
+
+        ++currentToken;
+
+        if(!readValue())
+            return -1;
+    }
+
+    // Numeric attributes can only be compared with numbers
+    bool isNumericColumn = node.attribute == idAttribute || database.attributeColumns[node.attribute].type == ComponentDatabase::AttributeColumn::Double;
+
+    if(isNumericColumn)
+    {
+        for(int i = 0; i<node.values.size(); ++i)
+        {
+            if(std::isnan(node.numbers[i]))
+            {
+                err = "The attribute \"" + nameToken.text + "\" is numeric and cannot be compared with \"" + node.values.at(i) + "\"";
+                return -1;
+            }
+        }
+    }
+
+    return this->addNode(node);
+}
+
+
+void ComponentFilter::evaluateNode(const int index, const ComponentDatabase& database, std::vector<quint8>& mask, std::vector<quint8>& valid) const
+{
+    const auto& node = nodes[index];
+
+    switch (node.type)
+    {
+    case Node::And :
+    case Node::Or :
+    {
+        this->evaluateNode(node.left, database, mask, valid);
+
+        std::vector<quint8> rightMask(mask.size(), 0);
+        std::vector<quint8> rightValid(mask.size(), 0);
+        this->evaluateNode(node.right, database, rightMask, rightValid);
+
+        // A side that is false decides an and, a side that is true decides an or, even if the other side is missing
+        if(node.type == Node::And)
+        {
+            for(size_t i = 0; i<mask.size(); ++i)
+            {
+                valid[i] = (valid[i] & rightValid[i]) | (valid[i] & (mask[i] ^ 1)) | (rightValid[i] & (rightMask[i] ^ 1));
+                mask[i] &= rightMask[i];
+            }
+        }
+        else
+        {
+            for(size_t i = 0; i<mask.size(); ++i)
+            {
+                mask[i] |= rightMask[i];
+                valid[i] = (valid[i] & rightValid[i]) | mask[i];
+            }
+        }
+
+        break;
+    }
+    case Node::Not :
+    {
+        this->evaluateNode(node.left, database, mask, valid);
+
+        // Only the rows with a known value are negated, the rest stay false
+        for(size_t i = 0; i<mask.size(); ++i)
+            mask[i] = (mask[i] ^ 1) & valid[i];
+
+        break;
+    }
+    default :
+        this->evaluateComparison(node, database, mask, valid);
+        break;
+    }
+}
+
+
+void ComponentFilter::evaluateComparison(const Node& node, const ComponentDatabase& database, std::vector<quint8>& mask, std::vector<quint8>& valid) const
+{
+    std::fill(mask.begin(), mask.end(), 0);
+    std::fill(valid.begin(), valid.end(), 0);
+
+    if(node.attribute == idAttribute)
+    {
+        // Every component has an ID
+        std::fill(valid.begin(), valid.end(), 1);
+
+        if(node.type == Node::In)
+        {
+            // The IDs are read from the text, a double cannot hold every 64-bit ID
+            std::vector<qint64> values;
+            for(auto&& it : node.values)
+            {
+                bool OK = false;
+                auto ID = it.toLongLong(&OK);
+
+                if(OK)
+                    values.push_back(ID);
+            }
+
+            std::sort(values.begin(), values.end());
+
+            runKernel(database.IDs.data(), database.IDs.size(), mask.data(), [&](qint64 val) { return std::binary_search(values.begin(), values.end(), val); });
+        }
+        else
+        {
+            bool OK = false;
+            auto ID = node.values.at(0).toLongLong(&OK);
+
+            if(OK)
+                runNumericKernel(database.IDs.data(), database.IDs.size(), mask.data(), node.op, ID);
+            else
+                runNumericKernel(database.IDs.data(), database.IDs.size(), mask.data(), node.op, node.numbers[0]);
+        }
+
+        return;
+    }
+
+    const auto& column = database.attributeColumns[node.attribute];
+
+    switch (column.type)
+    {
+    case ComponentDatabase::AttributeColumn::Double :
+    {
+        if(node.type == Node::In)
+        {
+            const auto& values = node.numbers;
+            runKernel(column.doubles.data(), mask.size(), mask.data(), [&](double val) { return std::find(values.begin(), values.end(), val) != values.end(); });
+        }
+        else
+        {
+            runNumericKernel(column.doubles.data(), mask.size(), mask.data(), node.op, node.numbers[0]);
+        }
+
+        runKernel(column.doubles.data(), valid.size(), valid.data(), [](double val) { return val == val; });
+
+        break;
+    }
+    case ComponentDatabase::AttributeColumn::String :
+    {
+        // Evaluate the comparison once per category, then look up the result of each row by its code
+        const auto& categories = column.uniqueValues;
+
+        std::vector<quint8> categoryMask(categories.size() + 1, 0);
+
+        for(int i = 0; i<categories.size(); ++i)
+            categoryMask[i] = this->compareValue(node, QVariant(categories.at(i))) ? 1 : 0;
+
+        column.codes.visit([&](auto codes, const size_t numCodes, const quint32 missing)
+        {
+            // The missing code maps to the last entry, which never passes
+            const auto missingIndex = static_cast<quint32>(categories.size());
+
+            runKernel(codes, numCodes, mask.data(), [&](quint32 code) { return categoryMask[code == missing ? missingIndex : code]; });
+            runKernel(codes, numCodes, valid.data(), [missing](quint32 code) { return code != missing; });
+        });
+
+        break;
+    }
+    case ComponentDatabase::AttributeColumn::Variant :
+    {
+        for(size_t i = 0; i<column.variants.size(); ++i)
+        {
+            mask[i] = this->compareValue(node, column.variants[i]) ? 1 : 0;
+            valid[i] = column.variants[i].isValid() ? 1 : 0;
+        }
+
+        break;
+    }
+    default :
+        break;
+    }
+}
+
+
+bool ComponentFilter::compareValue(const Node& node, const QVariant& value) const
+{
+    if(!value.isValid())
+        return false;
+
+    const auto text = value.toString();
+
+    bool isNumber = false;
+    const auto number = value.toDouble(&isNumber);
+
+    auto compareOne = [&](const int i, const Operator op) -> bool
+    {
+        // Compare as numbers when both sides are numbers, otherwise compare the text
+        if(isNumber && !std::isnan(node.numbers[i]))
+        {
+            const auto other = node.numbers[i];
+
+            switch (op)
+            {
+            case Less : return number < other;
+            case LessEqual : return number <= other;
+            case Greater : return number > other;
+            case GreaterEqual : return number >= other;
+            case Equal : return number == other;
+            default : return number != other;
+            }
+        }
+
+        const auto result = text.compare(node.values.at(i));
+
+        switch (op)
+        {
+        case Less : return result < 0;
+        case LessEqual : return result <= 0;
+        case Greater : return result > 0;
+        case GreaterEqual : return result >= 0;
+        case Equal : return result == 0;
+        default : return result != 0;
+        }
+    };
+
+    if(node.type == Node::In)
+    {
+        for(int i = 0; i<node.values.size(); ++i)
+        {
+            if(compareOne(i, Equal))
+                return true;
+        }
+
+        return false;
+    }
+
+    return compareOne(0, node.op);
+}
@@ -0,0 +1,136 @@
+#ifndef COMPONENTFILTER_H
+#define COMPONENTFILTER_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+
+#include <vector>
+
+class ComponentDatabase;
+
+// Selects components with an expression over their attributes, e.g., YearBuilt < 1940 && NumberOfStories >= 3 && OccupancyClass in {RES3, COM1}
+//
+// Comparisons: <, <=, >, >=, == (or =), !=, and "in {a, b, ...}" to test for membership in a set of values
+// Logical operators: && (or "and"), || (or "or"), ! (or "not"), and parentheses for grouping
+// Values are numbers, quoted strings, or bare words. "ID" refers to the component ID
+// Comparisons with a missing value are always false, and so are their negations, e.g., !(YearBuilt < 1940) does not select the components without a YearBuilt
+//
+// The expression is compiled once against the attribute columns of the database and then evaluated one column at a time over all of the components
+class ComponentFilter
+{
+public:
+    ComponentFilter();
+
+    // Parses the expression and resolves the attribute names in the database, returns -1 and sets the error message if the expression is not valid
+    int compile(const QString& expression, const ComponentDatabase& database, QString& err);
+
+    bool isEmpty(void) const;
+
+    // Returns a mask with one entry per row of the database, 1 if the component passes the filter
+    // The database must not have been modified since the filter was compiled
+    std::vector<quint8> evaluateMask(const ComponentDatabase& database) const;
+
+    // Returns the IDs of the components that pass the filter
+    std::vector<qint64> evaluate(const ComponentDatabase& database) const;
+
+private:
+
+    enum Operator {Less, LessEqual, Greater, GreaterEqual, Equal, NotEqual};
+
+    struct Node
+    {
+        enum Type {And, Or, Not, Compare, In};
+
+        Type type;
+
+        // Children of the logical operators
+        int left = -1;
+        int right = -1;
+
+        // The attribute to compare, idAttribute for the component ID
+        int attribute = -1;
+        Operator op = Equal;
+
+        // The value(s) compared against, the numbers are NaN for values that are not numbers
+        QStringList values;
+        std::vector<double> numbers;
+    };
+
+    static const int idAttribute = -2;
+
+    struct Token
+    {
+        enum Type {Word, Number, String, Symbol, End};
+
+        Type type;
+        QString text;
+        int position;
+    };
+
+    int tokenize(const QString& expression, QString& err);
+
+    // Recursive descent parser, each function returns the index of the node it created, or -1 on error
+    int parseOr(const ComponentDatabase& database, QString& err);
+    int parseAnd(const ComponentDatabase& database, QString& err);
+    int parseUnary(const ComponentDatabase& database, QString& err);
+    int parseComparison(const ComponentDatabase& database, QString& err);
+
+    bool isSymbol(const QString& symbol) const;
+    bool isKeyword(const QString& keyword) const;
+
+    int addNode(const Node& node);
+
+    // The mask is 1 where the node is true, the valid mask is 1 where the node is known to be true or false
+    // A comparison against a missing value is neither, so that it fails both the comparison and its negation
+    void evaluateNode(const int node, const ComponentDatabase& database, std::vector<quint8>& mask, std::vector<quint8>& valid) const;
+    void evaluateComparison(const Node& node, const ComponentDatabase& database, std::vector<quint8>& mask, std::vector<quint8>& valid) const;
+
+    // Whether a single value passes the comparison of the node
+    bool compareValue(const Node& node, const QVariant& value) const;
+
+    std::vector<Token> tokens;
+    size_t currentToken;
+
+    std::vector<Node> nodes;
+    int root;
+};
+
+#endif // COMPONENTFILTER_H
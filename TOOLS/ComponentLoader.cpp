@@ -0,0 +1,594 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "ComponentLoader.h"
+#include "CSVIndexCache.h"
+#include "MappedCSVFile.h"
+
+#include <Envelope.h>
+
+#include <QThread>
+#include <QUuid>
+#include <QVector>
+#include <QtConcurrent/QtConcurrentMap>
+
+#include <algorithm>
+#include <numeric>
+
+using namespace Esri::ArcGISRuntime;
+
+ComponentLoader::ComponentLoader(QObject* parent) : QObject(parent), running(false), stopRequested(false), currentGeneration(0), isCached(false)
+{
+
+}
+
+
+ComponentLoader::~ComponentLoader()
+{
+    this->cancel();
+
+    if(worker)
+        worker->wait();
+}
+
+
+void ComponentLoader::setCategoricalAttributes(const QStringList& attributes)
+{
+    categoricalAttributes = attributes;
+}
+
+
+void ComponentLoader::setGeometryBuilder(const GeometryBuilder& builder)
+{
+    geometryBuilder = builder;
+}
+
+
+void ComponentLoader::setFootprintAttribute(const QString& attribute)
+{
+    footprintAttribute = attribute;
+}
+
+
+int ComponentLoader::start(const QString& pathToFile, QString& err)
+{
+    if(running)
+    {
+        err = "A file is already being loaded";
+        return -1;
+    }
+
+    // The previous worker may still be returning from its last signal
+    if(worker)
+        worker->wait();
+
+    this->pathToFile = pathToFile;
+
+    headings.clear();
+    database.clear();
+    geometries.clear();
+
+    stopRequested = false;
+    running = true;
+
+    const int loadGeneration = ++currentGeneration;
+
+    worker.reset(QThread::create([this, loadGeneration]{ this->run(loadGeneration); }));
+    worker->start();
+
+    return 0;
+}
+
+
+void ComponentLoader::cancel(void)
+{
+    stopRequested = true;
+}
+
+
+bool ComponentLoader::isRunning(void) const
+{
+    return running;
+}
+
+
+int ComponentLoader::getGeneration(void) const
+{
+    return currentGeneration;
+}
+
+
+QStringList ComponentLoader::getHeadings(void) const
+{
+    return headings;
+}
+
+
+int ComponentLoader::takeResults(ComponentDatabase& componentDatabase, std::vector<Geometry>& componentGeometries)
+{
+    if(worker)
+        worker->wait();
+
+    if(stopRequested)
+    {
+        database.clear();
+        geometries.clear();
+        return -1;
+    }
+
+    componentDatabase = std::move(database);
+    componentGeometries = std::move(geometries);
+
+    database.clear();
+    geometries.clear();
+
+    return 0;
+}
+
+
+void ComponentLoader::run(const int generation)
+{
+    QString err;
+
+    MappedCSVFile csvFile;
+
+    auto res = this->parse(csvFile, err);
+
+    // A large file that was loaded before has its components in the cache, so the rows do not have to be validated and indexed again
+    isCached = res == 0 && this->loadCache(csvFile);
+
+    if(res == 0 && !isCached)
+        res = this->validate(csvFile, err);
+
+    if(res == 0 && !isCached)
+        res = this->index(csvFile, err);
+
+    if(res == 0)
+        res = this->decodeFootprints(csvFile, err);
+
+    if(res == 0)
+        res = this->buildGeometries(err);
+
+    // The components are cached once their envelopes and spatial index are built
+    if(res == 0 && !isCached && csvFile.size() >= CSVIndexCache::minFileSize)
+        database.saveCache(pathToFile, csvFile.data(), csvFile.size());
+
+    // The file is no longer needed once the components are in the database
+    csvFile.close();
+
+    if(res != 0)
+    {
+        database.clear();
+        geometries.clear();
+        componentIDs.clear();
+
+        running = false;
+
+        if(stopRequested)
+            emit cancelled(generation);
+        else
+            emit failed(generation, err);
+
+        return;
+    }
+
+    running = false;
+
+    emit finished(generation);
+}
+
+
+int ComponentLoader::parse(MappedCSVFile& csvFile, QString& err)
+{
+    emit progressChanged("Parsing file", 0, 1);
+
+    // The index of the rows and cells is kept in a cache, so that a large inventory only has to be tokenized the first time it is loaded
+    csvFile.open(pathToFile, err, true);
+
+    if(!err.isEmpty())
+        return -1;
+
+    if(csvFile.numRows() < 2)
+    {
+        err = "Input file is empty";
+        return -1;
+    }
+
+    if(csvFile.row(1).isEmpty())
+    {
+        err = "First row is empty";
+        return -1;
+    }
+
+    // Get the header file
+    headings = csvFile.rowStrings(0);
+
+    if(stopRequested)
+        return -1;
+
+    emit progressChanged("Parsing file", 1, 1);
+
+    return 0;
+}
+
+
+bool ComponentLoader::loadCache(const MappedCSVFile& csvFile)
+{
+    if(csvFile.size() < CSVIndexCache::minFileSize)
+        return false;
+
+    emit progressChanged("Reading cached components", 0, 1);
+
+    auto UIDPrefix = QUuid::createUuid().toString() + "-";
+
+    if(!database.loadCache(pathToFile, csvFile.data(), csvFile.size(), UIDPrefix))
+        return false;
+
+    // The cache has to hold a column for each heading of the file, stored as categories if and only if they are categorical attributes now
+    auto numCols = headings.size();
+
+    bool isValid = database.getNumberOfComponents() == csvFile.numRows()-1 && database.getAttributeNames().size() == numCols-1;
+
+    for(int j = 1; isValid && j<numCols; ++j)
+    {
+        auto attribute = database.getAttributeIndex(headings.at(j));
+
+        isValid = attribute != -1 && database.isCategoricalAttribute(attribute) == categoricalAttributes.contains(headings.at(j));
+    }
+
+    if(!isValid)
+    {
+        database.clear();
+        return false;
+    }
+
+    emit progressChanged("Reading cached components", 1, 1);
+
+    return true;
+}
+
+
+int ComponentLoader::validate(const MappedCSVFile& csvFile, QString& err)
+{
+    // The first row contains the header information
+    auto numRows = csvFile.numRows()-1;
+    auto numCols = headings.size();
+
+    componentIDs.resize(numRows);
+
+    for(int i = 0; i<numRows; ++i)
+    {
+        if(!this->checkProgress("Validating rows", i, numRows))
+            return -1;
+
+        if(csvFile.numFields(i+1) != numCols)
+        {
+            err = "Error, the number of items in row " + QString::number(i+1) + " does not equal number of headings in the file";
+            return -1;
+        }
+
+        // The IDs do not have to be sequential, they only have to be unique which is checked when the components are indexed
+        bool OK = false;
+        componentIDs[i] = csvFile.field(i+1,0).toLongLong(&OK);
+
+        if(!OK)
+        {
+            err = "Error, the asset ID in row " + QString::number(i+1) + " is not an integer";
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+
+int ComponentLoader::index(const MappedCSVFile& csvFile, QString& err)
+{
+    auto numRows = csvFile.numRows()-1;
+    auto numCols = headings.size();
+
+    // Categorical attributes have to be added before they get any values
+    for(auto&& attribute : categoricalAttributes)
+    {
+        if(headings.contains(attribute))
+            database.addCategoricalAttribute(attribute);
+    }
+
+    // The first column is the ID which is kept by the database
+    QVector<int> attributeIndexes(numCols, -1);
+    for(int j = 1; j<numCols; ++j)
+        attributeIndexes[j] = database.addAttribute(headings.at(j));
+
+    database.reserve(numRows);
+
+    // The UIDs share a prefix that is unique to this load, which is much cheaper than creating a UUID for every component
+    auto UIDPrefix = QUuid::createUuid().toString() + "-";
+
+    for(int i = 0; i<numRows; ++i)
+    {
+        if(!this->checkProgress("Indexing rows", i, numRows))
+            return -1;
+
+        // The database gives back the row of the existing component if the ID was already added
+        if(database.addComponent(componentIDs[i], UIDPrefix + QString::number(i)) != i)
+        {
+            err = "Error, the asset ID " + QString::number(componentIDs[i]) + " in row " + QString::number(i+1) + " is not unique";
+            return -1;
+        }
+    }
+
+    componentIDs.clear();
+    componentIDs.shrink_to_fit();
+
+    // Each attribute is stored in its own column, so the columns are filled in parallel
+    std::vector<int> columns(std::max(numCols-1, 0));
+    std::iota(columns.begin(), columns.end(), 1);
+
+    // The footprints are decoded into the footprint store, their text is left in the file and read from there when the components are written out
+    auto footprintColumn = footprintAttribute.isEmpty() ? -1 : headings.indexOf(footprintAttribute);
+
+    if(footprintColumn > 0)
+        columns.erase(std::remove(columns.begin(), columns.end(), footprintColumn), columns.end());
+
+    std::atomic<int> numColumnsDone(0);
+
+    QtConcurrent::blockingMap(columns, [&](const int col)
+    {
+        for(int i = 0; i<numRows; ++i)
+        {
+            if(i % progressInterval == 0 && stopRequested)
+                return;
+
+            database.setAttributeValue(i, attributeIndexes.at(col), csvFile.field(i+1,col));
+        }
+
+        emit progressChanged("Indexing attribute columns", ++numColumnsDone, static_cast<int>(columns.size()));
+    });
+
+    if(stopRequested)
+        return -1;
+
+    return 0;
+}
+
+
+int ComponentLoader::decodeFootprints(const MappedCSVFile& csvFile, QString& err)
+{
+    auto column = headings.indexOf(footprintAttribute);
+
+    if(footprintAttribute.isEmpty() || column == -1)
+        return 0;
+
+    auto numRows = csvFile.numRows()-1;
+
+    FootprintStore footprints;
+
+    // A file that was loaded before has its footprints in the cache
+    const bool useCache = csvFile.size() >= CSVIndexCache::minFileSize;
+
+    if(useCache && footprints.loadCache(pathToFile, column, csvFile.data(), csvFile.size()) && footprints.size() == numRows)
+    {
+        database.setFootprints(std::move(footprints));
+        return 0;
+    }
+
+    // Each chunk of rows is decoded into its own store in parallel, and the stores are joined in order. Each chunk keeps the first error it finds
+    struct Chunk
+    {
+        int start;
+        int end;
+        FootprintStore footprints;
+        QString err;
+    };
+
+    std::vector<Chunk> chunks;
+    for(int start = 0; start<numRows; start += chunkSize)
+        chunks.push_back(Chunk{start, std::min(start + chunkSize, numRows), FootprintStore(), QString()});
+
+    std::atomic<int> numRowsDone(0);
+
+    QtConcurrent::blockingMap(chunks, [&](Chunk& chunk)
+    {
+        chunk.footprints.reserve(chunk.end - chunk.start);
+
+        std::vector<double> coordinates;
+
+        for(int row = chunk.start; row<chunk.end; ++row)
+        {
+            if(stopRequested)
+                return;
+
+            auto footprint = csvFile.field(row+1, column);
+
+            // Components without a footprint are given one by the geometry builder
+            if(footprint.isEmpty() || footprint.compare("NA") == 0)
+                coordinates.clear();
+            else if(FootprintStore::decode(footprint, coordinates) != 0)
+                chunk.err = "Error getting the footprint geometry of the asset " + QString::number(database.getID(row));
+
+            if(chunk.err.isEmpty() && chunk.footprints.append(coordinates) != 0)
+                chunk.err = "Error, the footprint of the asset " + QString::number(database.getID(row)) + " is too large to be stored";
+
+            if(!chunk.err.isEmpty())
+                return;
+        }
+
+        auto numChunkRows = chunk.end - chunk.start;
+        auto done = numRowsDone += numChunkRows;
+
+        if((done - numChunkRows)*20/numRows != done*20/numRows)
+            emit progressChanged("Decoding footprints", done, numRows);
+    });
+
+    if(stopRequested)
+        return -1;
+
+    footprints.reserve(numRows);
+
+    for(auto&& chunk : chunks)
+    {
+        if(!chunk.err.isEmpty())
+        {
+            err = chunk.err;
+            return -1;
+        }
+
+        footprints.append(chunk.footprints);
+    }
+
+    if(useCache)
+        footprints.saveCache(pathToFile, column, csvFile.data(), csvFile.size());
+
+    database.setFootprints(std::move(footprints));
+
+    return 0;
+}
+
+
+int ComponentLoader::buildGeometries(QString& err)
+{
+    auto numRows = database.getNumberOfComponents();
+
+    const auto& footprints = database.getFootprints();
+
+    // The envelopes and the spatial index of cached components were read from the cache
+    if(!isCached)
+    {
+        // The components with a footprint get their geometry from the footprint store when their features are created
+        for(int row = 0; row<footprints.size(); ++row)
+        {
+            if(footprints.hasFootprint(row))
+                database.setEnvelope(row, footprints.getEnvelope(row));
+        }
+    }
+
+    if(!geometryBuilder)
+    {
+        if(!isCached)
+            database.buildSpatialIndex();
+
+        return 0;
+    }
+
+    geometries.assign(numRows, Geometry());
+
+    // The rows are split into chunks that are built in parallel, each chunk keeps the first error it finds
+    struct Chunk
+    {
+        int start;
+        int end;
+        QString err;
+    };
+
+    std::vector<Chunk> chunks;
+    for(int start = 0; start<numRows; start += chunkSize)
+        chunks.push_back(Chunk{start, std::min(start + chunkSize, numRows), QString()});
+
+    std::atomic<int> numRowsDone(0);
+
+    QtConcurrent::blockingMap(chunks, [&](Chunk& chunk)
+    {
+        for(int row = chunk.start; row<chunk.end; ++row)
+        {
+            if(stopRequested)
+                return;
+
+            if(footprints.hasFootprint(row))
+                continue;
+
+            geometries[row] = geometryBuilder(database, row, chunk.err);
+
+            if(!chunk.err.isEmpty())
+                return;
+        }
+
+        auto numChunkRows = chunk.end - chunk.start;
+        auto done = numRowsDone += numChunkRows;
+
+        // Report about twenty times, when the number of rows done crosses a twentieth of the rows
+        if((done - numChunkRows)*20/numRows != done*20/numRows)
+            emit progressChanged("Building geometries", done, numRows);
+    });
+
+    if(stopRequested)
+        return -1;
+
+    for(auto&& chunk : chunks)
+    {
+        if(!chunk.err.isEmpty())
+        {
+            err = chunk.err;
+            return -1;
+        }
+    }
+
+    if(isCached)
+        return 0;
+
+    // The bounding boxes of the geometries go into the spatial index used for selections
+    for(int row = 0; row<numRows; ++row)
+    {
+        if(geometries[row].isEmpty())
+            continue;
+
+        auto extent = geometries[row].extent();
+        database.setEnvelope(row, RTreeEnvelope{extent.xMin(), extent.yMin(), extent.xMax(), extent.yMax()});
+    }
+
+    database.buildSpatialIndex();
+
+    return 0;
+}
+
+
+bool ComponentLoader::checkProgress(const QString& stage, const int done, const int total)
+{
+    if(done % progressInterval != 0)
+        return true;
+
+    if(stopRequested)
+        return false;
+
+    // The progress is reported about twenty times per stage
+    auto reportInterval = std::max(static_cast<int>(progressInterval), total/20);
+
+    if(done % reportInterval < progressInterval)
+        emit progressChanged(stage, done, total);
+
+    return true;
+}
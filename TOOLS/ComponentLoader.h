@@ -0,0 +1,155 @@
+#ifndef COMPONENTLOADER_H
+#define COMPONENTLOADER_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "ComponentDatabase.h"
+
+#include <Geometry.h>
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class MappedCSVFile;
+class QThread;
+
+// Loads a component inventory from a CSV file on a worker thread, in stages: the file is parsed, the rows are validated, the components are indexed in a component database, the footprints are decoded, and the geometries of the components are built
+// A large file that was loaded before is read from the cache of its components instead of being validated and indexed again
+// Progress is reported through signals and the load can be cancelled at any time. The results are taken on the GUI thread, where the features are added to the map
+class ComponentLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Builds the geometry of the component at the given row of the database. It is called from worker threads, so it must not touch any GUI objects
+    // Sets the error if the geometry cannot be built, a component without a geometry is given an empty geometry and no error
+    typedef std::function<Esri::ArcGISRuntime::Geometry(const ComponentDatabase& database, const int row, QString& err)> GeometryBuilder;
+
+    explicit ComponentLoader(QObject* parent = nullptr);
+    ~ComponentLoader() override;
+
+    // Attributes whose values are stored as categories, see ComponentDatabase::addCategoricalAttribute
+    void setCategoricalAttributes(const QStringList& attributes);
+
+    // If no geometry builder is set, the components are loaded without geometries
+    void setGeometryBuilder(const GeometryBuilder& builder);
+
+    // Column holding the GeoJSON footprints of the components. The footprints are decoded once into the footprint store of the database, and kept in a cache next to the file
+    // The geometry builder is not called for the components that have a footprint. The footprint attribute is added to the database without any values, the text of the footprints is only kept in the file
+    void setFootprintAttribute(const QString& attribute);
+
+    // Starts loading the file, returns -1 if a file is already being loaded
+    // Each load is given the next generation, which is sent with the signals of the load
+    int start(const QString& pathToFile, QString& err);
+
+    // Asks the worker to stop, the cancelled signal is emitted once it has stopped
+    void cancel(void);
+
+    bool isRunning(void) const;
+
+    // The generation of the latest load. The finished, failed, and cancelled signals are queued, so a signal of an earlier load can arrive after a new load is started and must be ignored
+    int getGeneration(void) const;
+
+    // The headings of the columns in the file
+    QStringList getHeadings(void) const;
+
+    // Moves the components and their geometries, one per row, to the caller. Call once the finished signal of the latest generation is received
+    // Returns -1 if the load was cancelled after it finished, in which case the results are discarded
+    int takeResults(ComponentDatabase& componentDatabase, std::vector<Esri::ArcGISRuntime::Geometry>& componentGeometries);
+
+signals:
+    void progressChanged(const QString& stage, const int done, const int total);
+    void finished(const int generation);
+    void failed(const int generation, const QString& err);
+    void cancelled(const int generation);
+
+private:
+
+    // Runs on the worker thread
+    void run(const int generation);
+
+    // The stages of the load, each returns 0 on success and -1 on an error or if the load was cancelled
+    int parse(MappedCSVFile& csvFile, QString& err);
+
+    // Reads the components from the cache of the file instead of validating and indexing the rows, returns true if an up to date cache was found
+    // The cache is written once a large file is loaded, see ComponentDatabase::saveCache
+    bool loadCache(const MappedCSVFile& csvFile);
+    int validate(const MappedCSVFile& csvFile, QString& err);
+    int index(const MappedCSVFile& csvFile, QString& err);
+    int decodeFootprints(const MappedCSVFile& csvFile, QString& err);
+    int buildGeometries(QString& err);
+
+    // Checks for a cancellation and reports the progress every progressInterval items
+    bool checkProgress(const QString& stage, const int done, const int total);
+
+    static const int progressInterval = 1000;
+
+    // Number of rows given to a thread at a time when building the geometries
+    static const int chunkSize = 4096;
+
+    std::unique_ptr<QThread> worker;
+    std::atomic<bool> running;
+    std::atomic<bool> stopRequested;
+
+    // Only changed on the thread that starts the loads
+    int currentGeneration;
+
+    QString pathToFile;
+    QStringList categoricalAttributes;
+    GeometryBuilder geometryBuilder;
+    QString footprintAttribute;
+
+    QStringList headings;
+
+    // The IDs in the first column of the file, read when the rows are validated
+    std::vector<qint64> componentIDs;
+
+    ComponentDatabase database;
+    std::vector<Esri::ArcGISRuntime::Geometry> geometries;
+
+    // True if the components of the current load were read from the cache
+    bool isCached;
+};
+
+#endif // COMPONENTLOADER_H
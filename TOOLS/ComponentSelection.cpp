@@ -0,0 +1,340 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "ComponentSelection.h"
+
+#include <QStringList>
+
+#include <algorithm>
+
+ComponentSelection::const_iterator& ComponentSelection::const_iterator::operator++()
+{
+    if(ID < (*ranges)[range].last)
+    {
+        ++ID;
+        return *this;
+    }
+
+    ++range;
+
+    ID = range < ranges->size() ? (*ranges)[range].first : 0;
+
+    return *this;
+}
+
+
+ComponentSelection::ComponentSelection()
+{
+    numIDs = 0;
+}
+
+
+int ComponentSelection::fromString(const QString& text, ComponentSelection& selection, QString& err)
+{
+    auto inputText = text;
+
+    // Remove any white space from the string
+    inputText.remove(" ");
+
+    // Split the text into the parts delimited by commas
+    auto parts = inputText.split(",", Qt::SkipEmptyParts);
+
+    std::vector<Range> ranges;
+    ranges.reserve(parts.size());
+
+    for(auto&& part : parts)
+    {
+        bool OKStart = false;
+        bool OKEnd = false;
+
+        qint64 IDStart = 0;
+        qint64 IDEnd = 0;
+
+        // Handle the case where there is a range of assets separated by a '-'
+        auto pos = part.indexOf(QChar('-'));
+
+        if(pos != -1)
+        {
+            IDStart = part.left(pos).toLongLong(&OKStart);
+            IDEnd = part.mid(pos+1).toLongLong(&OKEnd);
+        }
+        else
+        {
+            IDStart = part.toLongLong(&OKStart);
+            IDEnd = IDStart;
+            OKEnd = OKStart;
+        }
+
+        if(!OKStart || !OKEnd)
+        {
+            err = "Error, could not read the asset IDs " + part + " in the Component asset selection box";
+            return -1;
+        }
+
+        // Make sure that the end integer is greater than the first
+        if(IDStart>IDEnd)
+        {
+            err = "Error in the range of asset IDs provided in the Component asset selection box";
+            return -1;
+        }
+
+        ranges.push_back(Range{IDStart, IDEnd});
+    }
+
+    selection.ranges.insert(selection.ranges.end(), ranges.begin(), ranges.end());
+    selection.normalize();
+
+    return 0;
+}
+
+
+QString ComponentSelection::toString(void) const
+{
+    QStringList parts;
+    parts.reserve(static_cast<int>(ranges.size()));
+
+    for(auto&& range : ranges)
+    {
+        if(range.first == range.last)
+            parts.append(QString::number(range.first));
+        else
+            parts.append(QString::number(range.first)+"-"+QString::number(range.last));
+    }
+
+    return parts.join(",");
+}
+
+
+void ComponentSelection::insert(const qint64 ID)
+{
+    this->insertRange(ID, ID);
+}
+
+
+void ComponentSelection::insert(const std::vector<qint64>& IDs)
+{
+    if(IDs.empty())
+        return;
+
+    auto sortedIDs = IDs;
+    std::sort(sortedIDs.begin(), sortedIDs.end());
+
+    // Collapse the runs of consecutive IDs into ranges before merging them with the selection
+    Range range{sortedIDs.front(), sortedIDs.front()};
+
+    for(auto&& ID : sortedIDs)
+    {
+        if(ID <= range.last || ID - 1 == range.last)
+        {
+            range.last = std::max(range.last, ID);
+            continue;
+        }
+
+        ranges.push_back(range);
+        range = Range{ID, ID};
+    }
+
+    ranges.push_back(range);
+
+    this->normalize();
+}
+
+
+void ComponentSelection::insertRange(const qint64 first, const qint64 last)
+{
+    if(first > last)
+        return;
+
+    ranges.push_back(Range{first, last});
+
+    this->normalize();
+}
+
+
+void ComponentSelection::unite(const ComponentSelection& other)
+{
+    ranges.insert(ranges.end(), other.ranges.begin(), other.ranges.end());
+
+    this->normalize();
+}
+
+
+void ComponentSelection::intersect(const ComponentSelection& other)
+{
+    std::vector<Range> intersection;
+
+    // Walk through the two sorted lists of ranges together
+    size_t i = 0;
+    size_t j = 0;
+
+    while(i < ranges.size() && j < other.ranges.size())
+    {
+        auto first = std::max(ranges[i].first, other.ranges[j].first);
+        auto last = std::min(ranges[i].last, other.ranges[j].last);
+
+        if(first <= last)
+            intersection.push_back(Range{first, last});
+
+        // Move past the range that ends first
+        if(ranges[i].last < other.ranges[j].last)
+            ++i;
+        else
+            ++j;
+    }
+
+    ranges.swap(intersection);
+
+    this->normalize();
+}
+
+
+bool ComponentSelection::contains(const qint64 ID) const
+{
+    return this->indexOf(ID) != -1;
+}
+
+
+qint64 ComponentSelection::indexOf(const qint64 ID) const
+{
+    // Find the first range that ends at or after the ID
+    auto it = std::lower_bound(ranges.begin(), ranges.end(), ID, [](const Range& range, const qint64 val) { return range.last < val; });
+
+    if(it == ranges.end() || it->first > ID)
+        return -1;
+
+    auto range = std::distance(ranges.begin(), it);
+
+    return offsets[range] + (ID - it->first);
+}
+
+
+qint64 ComponentSelection::at(const qint64 index) const
+{
+    // Find the last range that starts at or before the index
+    auto it = std::upper_bound(offsets.begin(), offsets.end(), index);
+
+    auto range = std::distance(offsets.begin(), it) - 1;
+
+    return ranges[range].first + (index - offsets[range]);
+}
+
+
+qint64 ComponentSelection::size(void) const
+{
+    return numIDs;
+}
+
+
+bool ComponentSelection::isEmpty(void) const
+{
+    return ranges.empty();
+}
+
+
+void ComponentSelection::clear(void)
+{
+    ranges.clear();
+    offsets.clear();
+    numIDs = 0;
+}
+
+
+qint64 ComponentSelection::first(void) const
+{
+    return ranges.front().first;
+}
+
+
+qint64 ComponentSelection::last(void) const
+{
+    return ranges.back().last;
+}
+
+
+const std::vector<ComponentSelection::Range>& ComponentSelection::getRanges(void) const
+{
+    return ranges;
+}
+
+
+ComponentSelection::const_iterator ComponentSelection::begin(void) const
+{
+    if(ranges.empty())
+        return this->end();
+
+    return const_iterator(&ranges, 0, ranges.front().first);
+}
+
+
+ComponentSelection::const_iterator ComponentSelection::end(void) const
+{
+    return const_iterator(&ranges, ranges.size(), 0);
+}
+
+
+void ComponentSelection::normalize(void)
+{
+    std::sort(ranges.begin(), ranges.end(), [](const Range& a, const Range& b) { return a.first < b.first; });
+
+    // Merge the ranges that overlap or touch into the range before them
+    size_t numRanges = 0;
+
+    for(size_t i = 0; i<ranges.size(); ++i)
+    {
+        // Written so that it does not overflow at the ends of the range of IDs
+        if(numRanges > 0 && (ranges[i].first <= ranges[numRanges-1].last || ranges[i].first - 1 == ranges[numRanges-1].last))
+        {
+            ranges[numRanges-1].last = std::max(ranges[numRanges-1].last, ranges[i].last);
+            continue;
+        }
+
+        ranges[numRanges] = ranges[i];
+        ++numRanges;
+    }
+
+    ranges.resize(numRanges);
+
+    offsets.resize(numRanges);
+
+    numIDs = 0;
+    for(size_t i = 0; i<numRanges; ++i)
+    {
+        offsets[i] = numIDs;
+        numIDs += ranges[i].last - ranges[i].first + 1;
+    }
+}
@@ -0,0 +1,139 @@
+#ifndef COMPONENTSELECTION_H
+#define COMPONENTSELECTION_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include <QString>
+
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+// Set of component IDs stored as sorted ranges of consecutive IDs, e.g., the selection 1-1000000 is stored as a single range
+// The memory used depends on the number of gaps between the selected IDs and not on the number of IDs
+class ComponentSelection
+{
+public:
+
+    // The IDs from first to last, inclusive
+    struct Range
+    {
+        qint64 first;
+        qint64 last;
+    };
+
+    // Iterates over the IDs in ascending order
+    class const_iterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef qint64 value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const qint64* pointer;
+        typedef qint64 reference;
+
+        const_iterator(const std::vector<Range>* ranges, const size_t range, const qint64 ID) : ranges(ranges), range(range), ID(ID) {}
+
+        qint64 operator*() const { return ID; }
+        const_iterator& operator++();
+        const_iterator operator++(int) { auto it = *this; ++(*this); return it; }
+        bool operator==(const const_iterator& other) const { return range == other.range && ID == other.ID; }
+        bool operator!=(const const_iterator& other) const { return !(*this == other); }
+
+    private:
+        const std::vector<Range>* ranges;
+        size_t range;
+        qint64 ID;
+    };
+
+    ComponentSelection();
+
+    // Parses a list of IDs in the form 1,3,5-10,12 into the selection, returns -1 and sets the error if the list is not valid
+    static int fromString(const QString& text, ComponentSelection& selection, QString& err);
+
+    // Returns the IDs in the form 1,3,5-10,12
+    QString toString(void) const;
+
+    void insert(const qint64 ID);
+    void insert(const std::vector<qint64>& IDs);
+    void insertRange(const qint64 first, const qint64 last);
+
+    // Adds the IDs of the other selection to this selection
+    void unite(const ComponentSelection& other);
+
+    // Keeps only the IDs that are also in the other selection
+    void intersect(const ComponentSelection& other);
+
+    bool contains(const qint64 ID) const;
+
+    // Position of the ID among the selected IDs in ascending order, -1 if the ID is not selected
+    qint64 indexOf(const qint64 ID) const;
+
+    // The ID at the given position among the selected IDs in ascending order
+    qint64 at(const qint64 index) const;
+
+    // Number of IDs in the selection
+    qint64 size(void) const;
+
+    bool isEmpty(void) const;
+
+    void clear(void);
+
+    // The smallest and the largest IDs, the selection must not be empty
+    qint64 first(void) const;
+    qint64 last(void) const;
+
+    const std::vector<Range>& getRanges(void) const;
+
+    const_iterator begin(void) const;
+    const_iterator end(void) const;
+
+private:
+
+    // Sorts the ranges, merges the ranges that overlap or touch, and counts the IDs
+    void normalize(void);
+
+    std::vector<Range> ranges;
+
+    // Number of IDs before each range
+    std::vector<qint64> offsets;
+
+    qint64 numIDs;
+};
+
+#endif // COMPONENTSELECTION_H
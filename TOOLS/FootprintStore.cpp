@@ -0,0 +1,417 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "FootprintStore.h"
+#include "CSVIndexCache.h"
+
+#include <PolygonBuilder.h>
+#include <SpatialReference.h>
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStringRef>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+using namespace Esri::ArcGISRuntime;
+
+namespace {
+
+const char cacheMagic[8] = {'R','2','D','F','O','O','T','P'};
+
+// Increment when the layout of the cache changes
+const quint32 cacheVersion = 1;
+
+struct CacheHeader
+{
+    char magic[8];
+    quint32 version;
+    quint32 pathLength;
+
+    // Key of the CSV file and of the column the footprints were decoded from
+    qint64 fileSize;
+    qint64 lastModified;
+    quint64 contentHash;
+    qint64 column;
+
+    qint64 numRows;
+    qint64 numPoints;
+};
+
+qint64 alignTo8(const qint64 numBytes)
+{
+    return (numBytes + 7) & ~qint64(7);
+}
+
+
+// Expected size of a cache with the given contents. The arrays are the point starts (numRows+1 entries), the tile origins, and the coordinates
+qint64 cacheSize(const qint64 pathLength, const qint64 numRows, const qint64 numPoints)
+{
+    return qint64(sizeof(CacheHeader)) + alignTo8(pathLength) + 8*(numRows + 1) + 8*numRows + 8*numPoints;
+}
+
+}
+
+
+FootprintStore::FootprintStore()
+{
+    pointStarts.push_back(0);
+}
+
+
+int FootprintStore::decode(const QString& geoJson, std::vector<double>& coordinates)
+{
+    coordinates.clear();
+
+    // Each innermost pair of brackets holds one point, the outer brackets only group the points
+    int pointStart = -1;
+
+    for(int i = 0; i<geoJson.size(); ++i)
+    {
+        auto c = geoJson.at(i);
+
+        if(c == '[')
+        {
+            pointStart = i+1;
+        }
+        else if(c == ']' && pointStart != -1)
+        {
+            QStringRef point(&geoJson, pointStart, i - pointStart);
+            pointStart = -1;
+
+            auto comma = point.indexOf(',');
+
+            if(comma == -1 || point.indexOf(',', comma+1) != -1)
+                return -1;
+
+            bool OK = false;
+            double lon = point.left(comma).toDouble(&OK);
+
+            if(!OK)
+                return -1;
+
+            double lat = point.mid(comma+1).toDouble(&OK);
+
+            if(!OK)
+                return -1;
+
+            coordinates.push_back(lon);
+            coordinates.push_back(lat);
+        }
+    }
+
+    return coordinates.empty() ? -1 : 0;
+}
+
+
+int FootprintStore::append(const std::vector<double>& coordinates)
+{
+    if(coordinates.size() % 2 != 0)
+        return -1;
+
+    const qint64 maxOffset = std::numeric_limits<qint32>::max();
+
+    qint32 tileLon = 0;
+    qint32 tileLat = 0;
+
+    if(!coordinates.empty())
+    {
+        if(!std::isfinite(coordinates[0]) || !std::isfinite(coordinates[1]) || std::abs(coordinates[0]) > 360.0 || std::abs(coordinates[1]) > 360.0)
+            return -1;
+
+        tileLon = static_cast<qint32>(std::floor(coordinates[0]));
+        tileLat = static_cast<qint32>(std::floor(coordinates[1]));
+    }
+
+    auto numCoordinates = this->coordinates.size();
+
+    for(size_t i = 0; i<coordinates.size(); i += 2)
+    {
+        auto lonOffset = (coordinates[i] - tileLon)*unitsPerDegree;
+        auto latOffset = (coordinates[i+1] - tileLat)*unitsPerDegree;
+
+        // Also rejects NaN
+        if(!(std::abs(lonOffset) < maxOffset && std::abs(latOffset) < maxOffset))
+        {
+            this->coordinates.resize(numCoordinates);
+            return -1;
+        }
+
+        this->coordinates.push_back(static_cast<qint32>(std::llround(lonOffset)));
+        this->coordinates.push_back(static_cast<qint32>(std::llround(latOffset)));
+    }
+
+    tileOrigins.push_back(tileLon);
+    tileOrigins.push_back(tileLat);
+
+    pointStarts.push_back(static_cast<qint64>(this->coordinates.size()/2));
+
+    return 0;
+}
+
+
+void FootprintStore::append(const FootprintStore& other)
+{
+    auto numPoints = pointStarts.back();
+
+    for(size_t i = 1; i<other.pointStarts.size(); ++i)
+        pointStarts.push_back(numPoints + other.pointStarts[i]);
+
+    tileOrigins.insert(tileOrigins.end(), other.tileOrigins.begin(), other.tileOrigins.end());
+    coordinates.insert(coordinates.end(), other.coordinates.begin(), other.coordinates.end());
+}
+
+
+int FootprintStore::size(void) const
+{
+    return static_cast<int>(pointStarts.size()) - 1;
+}
+
+
+bool FootprintStore::hasFootprint(const int row) const
+{
+    return this->getNumberOfPoints(row) > 0;
+}
+
+
+int FootprintStore::getNumberOfPoints(const int row) const
+{
+    if(row < 0 || row >= this->size())
+        return 0;
+
+    return static_cast<int>(pointStarts[row+1] - pointStarts[row]);
+}
+
+
+Geometry FootprintStore::getGeometry(const int row) const
+{
+    if(!this->hasFootprint(row))
+        return Geometry();
+
+    const double tileLon = tileOrigins[2*row];
+    const double tileLat = tileOrigins[2*row+1];
+
+    PolygonBuilder polygonBuilder(SpatialReference::wgs84());
+
+    for(auto i = pointStarts[row]; i<pointStarts[row+1]; ++i)
+        polygonBuilder.addPoint(tileLon + coordinates[2*i]/unitsPerDegree, tileLat + coordinates[2*i+1]/unitsPerDegree);
+
+    return polygonBuilder.toGeometry();
+}
+
+
+RTreeEnvelope FootprintStore::getEnvelope(const int row) const
+{
+    if(!this->hasFootprint(row))
+    {
+        const auto nan = std::numeric_limits<double>::quiet_NaN();
+        return RTreeEnvelope{nan, nan, nan, nan};
+    }
+
+    // The bounds are found on the offsets and converted to degrees once
+    auto start = pointStarts[row];
+
+    qint32 lonMin = coordinates[2*start];
+    qint32 lonMax = lonMin;
+    qint32 latMin = coordinates[2*start+1];
+    qint32 latMax = latMin;
+
+    for(auto i = start+1; i<pointStarts[row+1]; ++i)
+    {
+        lonMin = std::min(lonMin, coordinates[2*i]);
+        lonMax = std::max(lonMax, coordinates[2*i]);
+        latMin = std::min(latMin, coordinates[2*i+1]);
+        latMax = std::max(latMax, coordinates[2*i+1]);
+    }
+
+    const double tileLon = tileOrigins[2*row];
+    const double tileLat = tileOrigins[2*row+1];
+
+    return RTreeEnvelope{tileLon + lonMin/unitsPerDegree, tileLat + latMin/unitsPerDegree, tileLon + lonMax/unitsPerDegree, tileLat + latMax/unitsPerDegree};
+}
+
+
+void FootprintStore::reserve(const int numRows)
+{
+    pointStarts.reserve(static_cast<size_t>(numRows) + 1);
+    tileOrigins.reserve(2*static_cast<size_t>(numRows));
+}
+
+
+void FootprintStore::clear(void)
+{
+    pointStarts.assign(1, 0);
+    tileOrigins.clear();
+    coordinates.clear();
+}
+
+
+bool FootprintStore::loadCache(const QString& pathToFile, const int column, const char* data, const qint64 size)
+{
+    QFileInfo fileInfo(pathToFile);
+
+    auto canonicalPath = fileInfo.canonicalFilePath().toUtf8();
+
+    if(canonicalPath.isEmpty())
+        return false;
+
+    auto lastModified = fileInfo.lastModified().toMSecsSinceEpoch();
+
+    // Only hash the contents if the rest of the key matches
+    quint64 hash = 0;
+    bool hashComputed = false;
+
+    for(auto&& cachePath : CSVIndexCache::cachePaths(pathToFile, "r2dfootprints"))
+    {
+        QFile cacheFile(cachePath);
+
+        if(!cacheFile.open(QIODevice::ReadOnly))
+            continue;
+
+        CacheHeader header;
+        if(cacheFile.read(reinterpret_cast<char*>(&header), sizeof(CacheHeader)) != qint64(sizeof(CacheHeader)))
+            continue;
+
+        bool isValid = std::memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) == 0 &&
+                header.version == cacheVersion &&
+                header.fileSize == size &&
+                header.lastModified == lastModified &&
+                header.column == column &&
+                header.numRows >= 0 && header.numPoints >= 0 &&
+                header.pathLength == quint32(canonicalPath.size()) &&
+                cacheFile.size() == cacheSize(header.pathLength, header.numRows, header.numPoints);
+
+        if(isValid)
+            isValid = cacheFile.read(alignTo8(header.pathLength)).left(int(header.pathLength)) == canonicalPath;
+
+        if(isValid)
+        {
+            if(!hashComputed)
+            {
+                hash = CSVIndexCache::contentHash(data, size);
+                hashComputed = true;
+            }
+
+            isValid = header.contentHash == hash;
+        }
+
+        if(!isValid)
+            continue;
+
+        pointStarts.resize(header.numRows + 1);
+        tileOrigins.resize(2*header.numRows);
+        coordinates.resize(2*header.numPoints);
+
+        auto readBytes = [&cacheFile](void* bytes, const qint64 numBytes)
+        {
+            return cacheFile.read(reinterpret_cast<char*>(bytes), numBytes) == numBytes;
+        };
+
+        bool OK = readBytes(pointStarts.data(), 8*(header.numRows + 1)) &&
+                readBytes(tileOrigins.data(), 8*header.numRows) &&
+                readBytes(coordinates.data(), 8*header.numPoints) &&
+                pointStarts.front() == 0 && pointStarts.back() == header.numPoints;
+
+        if(OK)
+            return true;
+
+        this->clear();
+    }
+
+    return false;
+}
+
+
+bool FootprintStore::saveCache(const QString& pathToFile, const int column, const char* data, const qint64 size) const
+{
+    QFileInfo fileInfo(pathToFile);
+
+    auto canonicalPath = fileInfo.canonicalFilePath().toUtf8();
+
+    if(canonicalPath.isEmpty())
+        return false;
+
+    CacheHeader header;
+    std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+    header.version = cacheVersion;
+    header.pathLength = quint32(canonicalPath.size());
+    header.fileSize = size;
+    header.lastModified = fileInfo.lastModified().toMSecsSinceEpoch();
+    header.contentHash = CSVIndexCache::contentHash(data, size);
+    header.column = column;
+    header.numRows = this->size();
+    header.numPoints = pointStarts.back();
+
+    const QByteArray padding(int(alignTo8(header.pathLength) - header.pathLength), '\0');
+
+    for(auto&& cachePath : CSVIndexCache::cachePaths(pathToFile, "r2dfootprints"))
+    {
+        QDir().mkpath(QFileInfo(cachePath).absolutePath());
+
+        // The cache only replaces an existing cache once it is written in full
+        QSaveFile cacheFile(cachePath);
+
+        if(!cacheFile.open(QIODevice::WriteOnly))
+            continue;
+
+        auto writeBytes = [&cacheFile](const void* bytes, const qint64 numBytes)
+        {
+            return cacheFile.write(reinterpret_cast<const char*>(bytes), numBytes) == numBytes;
+        };
+
+        bool OK = writeBytes(&header, sizeof(CacheHeader)) &&
+                writeBytes(canonicalPath.constData(), canonicalPath.size()) &&
+                writeBytes(padding.constData(), padding.size()) &&
+                writeBytes(pointStarts.data(), 8*(header.numRows + 1)) &&
+                writeBytes(tileOrigins.data(), 8*header.numRows) &&
+                writeBytes(coordinates.data(), 8*header.numPoints);
+
+        if(OK && cacheFile.commit())
+            return true;
+
+        cacheFile.cancelWriting();
+    }
+
+    return false;
+}
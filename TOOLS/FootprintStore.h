@@ -0,0 +1,106 @@
+#ifndef FOOTPRINTSTORE_H
+#define FOOTPRINTSTORE_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "RTree.h"
+
+#include <Geometry.h>
+
+#include <QString>
+
+#include <vector>
+
+// Stores the footprints of the components, decoded once from their GeoJSON text, in one flat buffer of quantized coordinates
+// Each footprint keeps the origin of the one degree tile that its first point falls in, and its points are stored as 32-bit offsets from that origin in units of 1e-7 degrees (about a centimeter)
+// The geometries are built from the buffer when they are needed, so that a layer can be rebuilt without parsing the text again
+class FootprintStore
+{
+public:
+    FootprintStore();
+
+    // Number of units in a degree
+    static constexpr double unitsPerDegree = 1.0e7;
+
+    // Decodes a footprint given as a list of longitude and latitude pairs, e.g., [[-122.25,37.87],[-122.26,37.87],...], into the longitude and latitude of each point
+    // Returns -1 if the text is not a list of pairs of numbers
+    static int decode(const QString& geoJson, std::vector<double>& coordinates);
+
+    // Adds the footprint of the next row, a row without a footprint is given no coordinates. Returns -1 if a point is too far from the first point to be stored
+    int append(const std::vector<double>& coordinates);
+
+    // Adds the footprints of the rows of another store after the rows of this store
+    void append(const FootprintStore& other);
+
+    // Number of rows, with or without a footprint
+    int size(void) const;
+
+    bool hasFootprint(const int row) const;
+
+    int getNumberOfPoints(const int row) const;
+
+    // Builds the polygon of the footprint in WGS84, the geometry is empty if the row has no footprint
+    Esri::ArcGISRuntime::Geometry getGeometry(const int row) const;
+
+    // Bounding box of the footprint, the envelope is empty (NaN) if the row has no footprint
+    RTreeEnvelope getEnvelope(const int row) const;
+
+    void reserve(const int numRows);
+
+    void clear(void);
+
+    // Reads the footprints decoded from the given column of a CSV file, where data and size are the contents of the CSV file. Returns true if an up to date cache was found
+    // The cache is kept next to the index cache of the CSV file and is invalidated in the same way, see CSVIndexCache
+    bool loadCache(const QString& pathToFile, const int column, const char* data, const qint64 size);
+
+    // Writes the footprints decoded from the given column of the CSV file to the cache, returns true on success
+    bool saveCache(const QString& pathToFile, const int column, const char* data, const qint64 size) const;
+
+private:
+
+    // Position of the first point of each row in the buffer, numRows+1 entries so that the points of row i run from pointStarts[i] to pointStarts[i+1]
+    std::vector<qint64> pointStarts;
+
+    // The longitude and latitude of the origin of the tile of each row, in degrees
+    std::vector<qint32> tileOrigins;
+
+    // The longitude and latitude offsets of each point from the origin of its tile
+    std::vector<qint32> coordinates;
+};
+
+#endif // FOOTPRINTSTORE_H
@@ -0,0 +1,349 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "GeoJSONReader.h"
+#include "GzipInputDevice.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonParseError>
+
+using namespace Esri::ArcGISRuntime;
+
+GeoJSONReader::GeoJSONReader()
+{
+    this->close();
+}
+
+
+GeoJSONReader::~GeoJSONReader()
+{
+    this->close();
+}
+
+
+int GeoJSONReader::open(const QString& pathToFile, QString& err)
+{
+    this->close();
+
+    this->pathToFile = pathToFile;
+
+    if(GzipInputDevice::isCompressed(pathToFile))
+        device = std::make_unique<GzipInputDevice>(pathToFile);
+    else
+        device = std::make_unique<QFile>(pathToFile);
+
+    if(!device->open(QIODevice::ReadOnly))
+    {
+        err = "Cannot open the file: " + pathToFile + "\n" + device->errorString();
+        device.reset();
+        return -1;
+    }
+
+    return 0;
+}
+
+
+void GeoJSONReader::close(void)
+{
+    if(device)
+        device->close();
+
+    device.reset();
+
+    buffer.clear();
+    bufferPos = 0;
+
+    depth = 0;
+    inString = false;
+    escaped = false;
+    inFeatures = false;
+    atEnd = false;
+
+    lastString.clear();
+    lastKey.clear();
+
+    currentFeature.clear();
+    featureStart = -1;
+}
+
+
+int GeoJSONReader::readFeatures(const int maxFeatures, QList<QByteArray>& features, QString& err)
+{
+    features.clear();
+
+    if(!device)
+    {
+        err = "The GeoJSON file is not open";
+        return -1;
+    }
+
+    while(features.size() < maxFeatures && !atEnd)
+    {
+        if(bufferPos == buffer.size())
+        {
+            // Keep the part of the feature that is in this block
+            if(featureStart != -1)
+            {
+                currentFeature.append(buffer.constData() + featureStart, buffer.size() - featureStart);
+                featureStart = 0;
+            }
+
+            if(!this->readBlock(err))
+            {
+                if(!err.isEmpty())
+                    return -1;
+
+                if(featureStart != -1 || inFeatures)
+                {
+                    err = "The file " + pathToFile + " ends in the middle of the features";
+                    return -1;
+                }
+
+                atEnd = true;
+                break;
+            }
+
+            continue;
+        }
+
+        const char c = buffer.at(bufferPos++);
+
+        if(inString)
+        {
+            if(escaped)
+                escaped = false;
+            else if(c == '\\')
+                escaped = true;
+            else if(c == '"')
+                inString = false;
+            else if(depth == 1)
+                lastString.append(c);
+
+            continue;
+        }
+
+        // The top level object holds the features array, whose elements are the features
+        switch (c)
+        {
+        case '"' :
+            inString = true;
+            if(depth == 1)
+                lastString.clear();
+            break;
+        case ':' :
+            if(depth == 1)
+                lastKey = lastString;
+            break;
+        case '{' :
+        case '[' :
+            ++depth;
+            if(c == '[' && depth == 2 && lastKey == "features")
+            {
+                inFeatures = true;
+            }
+            else if(c == '{' && depth == 3 && inFeatures)
+            {
+                currentFeature.clear();
+                featureStart = bufferPos-1;
+            }
+            break;
+        case '}' :
+        case ']' :
+            --depth;
+            if(depth < 0)
+            {
+                err = "The file " + pathToFile + " is not a valid GeoJSON file";
+                return -1;
+            }
+            if(c == '}' && depth == 2 && featureStart != -1)
+            {
+                currentFeature.append(buffer.constData() + featureStart, bufferPos - featureStart);
+                features.append(currentFeature);
+                currentFeature.clear();
+                featureStart = -1;
+            }
+            else if(c == ']' && depth == 1 && inFeatures)
+            {
+                // The rest of the file is not needed
+                inFeatures = false;
+                atEnd = true;
+            }
+            break;
+        default :
+            break;
+        }
+    }
+
+    return features.size();
+}
+
+
+bool GeoJSONReader::readBlock(QString& err)
+{
+    buffer.resize(blockSize);
+    bufferPos = 0;
+
+    auto numRead = device->read(buffer.data(), blockSize);
+
+    if(numRead < 0)
+    {
+        err = "Error reading the file: " + pathToFile + "\n" + device->errorString();
+        buffer.clear();
+        return false;
+    }
+
+    buffer.resize(static_cast<int>(numRead));
+
+    return numRead > 0;
+}
+
+
+int GeoJSONReader::parseFeature(const QByteArray& text, GeoJSONFeature& feature, QString& err)
+{
+    QJsonParseError parseError;
+    auto doc = QJsonDocument::fromJson(text, &parseError);
+
+    if(parseError.error != QJsonParseError::NoError || !doc.isObject())
+    {
+        err = "Error parsing a feature: " + parseError.errorString();
+        return -1;
+    }
+
+    auto featureObject = doc.object();
+
+    feature.properties = featureObject["properties"].toObject().toVariantMap();
+
+    auto geometryObject = featureObject["geometry"].toObject();
+
+    auto type = geometryObject["type"].toString();
+    auto coordinates = geometryObject["coordinates"].toArray();
+
+    // The coordinates are handed to the geometry in the Esri JSON format, which nests them in the same way
+    QJsonObject esriGeometry;
+
+    feature.parts.clear();
+
+    auto addPart = [&](const QJsonArray& positions)
+    {
+        std::vector<double> part;
+        part.reserve(2*positions.size());
+
+        for(auto&& position : positions)
+        {
+            auto point = position.toArray();
+            part.push_back(point.at(0).toDouble());
+            part.push_back(point.at(1).toDouble());
+        }
+
+        feature.parts.push_back(std::move(part));
+    };
+
+    if(type.compare("Point") == 0)
+    {
+        if(coordinates.size() < 2)
+        {
+            err = "Error, a point feature does not have two coordinates";
+            return -1;
+        }
+
+        feature.geometryType = GeometryType::Point;
+        esriGeometry["x"] = coordinates.at(0);
+        esriGeometry["y"] = coordinates.at(1);
+    }
+    else if(type.compare("MultiPoint") == 0)
+    {
+        feature.geometryType = GeometryType::Multipoint;
+        esriGeometry["points"] = coordinates;
+    }
+    else if(type.compare("LineString") == 0)
+    {
+        feature.geometryType = GeometryType::Polyline;
+        esriGeometry["paths"] = QJsonArray{coordinates};
+        addPart(coordinates);
+    }
+    else if(type.compare("MultiLineString") == 0)
+    {
+        feature.geometryType = GeometryType::Polyline;
+        esriGeometry["paths"] = coordinates;
+        for(auto&& path : coordinates)
+            addPart(path.toArray());
+    }
+    else if(type.compare("Polygon") == 0)
+    {
+        feature.geometryType = GeometryType::Polygon;
+        esriGeometry["rings"] = coordinates;
+        for(auto&& ring : coordinates)
+            addPart(ring.toArray());
+    }
+    else if(type.compare("MultiPolygon") == 0)
+    {
+        // The rings of all of the polygons make up one polygon
+        QJsonArray rings;
+        for(auto&& polygon : coordinates)
+        {
+            for(auto&& ring : polygon.toArray())
+            {
+                rings.append(ring);
+                addPart(ring.toArray());
+            }
+        }
+
+        feature.geometryType = GeometryType::Polygon;
+        esriGeometry["rings"] = rings;
+    }
+    else
+    {
+        err = "Error, the import of the type of geometry " + type + " is not yet supported";
+        return -1;
+    }
+
+    esriGeometry["spatialReference"] = QJsonObject{{"wkid", 4326}};
+
+    feature.geometry = Geometry::fromJson(QString::fromUtf8(QJsonDocument(esriGeometry).toJson(QJsonDocument::Compact)));
+
+    if(feature.geometry.isEmpty())
+    {
+        err = "Error getting the geometry of a " + type + " feature";
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,115 @@
+#ifndef GEOJSONREADER_H
+#define GEOJSONREADER_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include <Geometry.h>
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QVariantMap>
+
+#include <memory>
+#include <vector>
+
+class QIODevice;
+
+// A feature of a GeoJSON file, with its geometry in WGS84
+struct GeoJSONFeature
+{
+    Esri::ArcGISRuntime::GeometryType geometryType = Esri::ArcGISRuntime::GeometryType::Unknown;
+    Esri::ArcGISRuntime::Geometry geometry;
+    QVariantMap properties;
+
+    // The longitude and latitude pairs of the paths of a line or the rings of a polygon, see GeometrySimplifier
+    std::vector<std::vector<double>> parts;
+};
+
+// Streams the features of a GeoJSON feature collection out of a file, so that the file is never parsed into one document
+// The reader scans the file block by block for the features array, and hands out the text of each feature. The file is inflated as it is read if it is compressed
+// The text of a feature is parsed with parseFeature, which does not touch any GUI objects so that the features can be parsed on worker threads
+class GeoJSONReader
+{
+public:
+    GeoJSONReader();
+    ~GeoJSONReader();
+
+    int open(const QString& pathToFile, QString& err);
+    void close(void);
+
+    // Reads the text of up to maxFeatures of the next features. Returns the number of features read, 0 at the end of the features, and -1 on an error
+    int readFeatures(const int maxFeatures, QList<QByteArray>& features, QString& err);
+
+    // Parses the text of a feature. Points, line strings, and polygons are supported, as well as their multi-part versions
+    // Returns -1 if the feature is not valid or if its geometry is not supported
+    static int parseFeature(const QByteArray& text, GeoJSONFeature& feature, QString& err);
+
+private:
+
+    Q_DISABLE_COPY(GeoJSONReader)
+
+    // Reads the next block of the file into the buffer, returns false at the end of the file
+    bool readBlock(QString& err);
+
+    static const int blockSize = 4*1024*1024;
+
+    std::unique_ptr<QIODevice> device;
+
+    QString pathToFile;
+
+    QByteArray buffer;
+    int bufferPos;
+
+    // State of the scan, kept between the blocks
+    int depth;
+    bool inString;
+    bool escaped;
+    bool inFeatures;
+    bool atEnd;
+
+    // The last string and key of the top level object, used to find the features array
+    QByteArray lastString;
+    QByteArray lastKey;
+
+    // The text of the feature that is being read, which can span several blocks
+    QByteArray currentFeature;
+    int featureStart;
+};
+
+#endif // GEOJSONREADER_H
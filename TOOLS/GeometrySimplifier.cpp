@@ -0,0 +1,480 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "GeometrySimplifier.h"
+
+#include <QHash>
+#include <QtConcurrent/QtConcurrentMap>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+GeometrySimplifier::GeometrySimplifier()
+{
+    this->clear();
+}
+
+
+int GeometrySimplifier::addPath(const std::vector<double>& pathCoordinates, const bool isRing)
+{
+    coordinates.insert(coordinates.end(), pathCoordinates.begin(), pathCoordinates.begin() + 2*(pathCoordinates.size()/2));
+
+    pathStarts.push_back(static_cast<qint64>(coordinates.size()/2));
+    ringFlags.push_back(isRing);
+
+    levels.clear();
+
+    return this->getNumberOfPaths()-1;
+}
+
+
+void GeometrySimplifier::joinPaths(void)
+{
+    auto numPaths = this->getNumberOfPaths();
+    auto numPoints = this->getNumberOfPoints();
+
+    // Number of times each point is on the paths
+    QHash<qint64, int> pointCounts;
+    pointCounts.reserve(static_cast<int>(std::min<qint64>(numPoints, std::numeric_limits<int>::max())));
+
+    for(qint64 i = 0; i<numPoints; ++i)
+        ++pointCounts[this->getPointKey(i)];
+
+    // The end of a path is 2*path at its first point and 2*path+1 at its last point, each end is linked to the end of the path it joins
+    std::vector<int> links(2*static_cast<size_t>(numPaths), -1);
+
+    QHash<qint64, int> openEnds;
+
+    for(int path = 0; path<numPaths; ++path)
+    {
+        if(ringFlags[path] || pathStarts[path+1] - pathStarts[path] < 2)
+            continue;
+
+        for(int side = 0; side<2; ++side)
+        {
+            auto key = this->getPointKey(side == 0 ? pathStarts[path] : pathStarts[path+1]-1);
+
+            if(pointCounts.value(key) != 2)
+                continue;
+
+            auto end = 2*path + side;
+
+            auto it = openEnds.find(key);
+            if(it == openEnds.end())
+            {
+                openEnds.insert(key, end);
+            }
+            else
+            {
+                links[end] = it.value();
+                links[it.value()] = end;
+                openEnds.erase(it);
+            }
+        }
+    }
+
+    std::vector<double> joinedCoordinates;
+    joinedCoordinates.reserve(coordinates.size());
+
+    std::vector<qint64> joinedPathStarts{0};
+    std::vector<char> joinedRingFlags;
+
+    std::vector<char> visited(numPaths, false);
+
+    // Follows the links from the path, which is entered at its first point if forward
+    auto joinFrom = [&](int path, bool forward)
+    {
+        auto firstPoint = joinedCoordinates.size();
+
+        while(true)
+        {
+            visited[path] = true;
+
+            auto start = pathStarts[path];
+            auto end = pathStarts[path+1];
+
+            // The first point of each joined path is the last point of the path before it
+            auto skipFirst = joinedCoordinates.size() > firstPoint;
+
+            for(qint64 k = skipFirst ? 1 : 0; k<end-start; ++k)
+            {
+                auto point = forward ? start + k : end - 1 - k;
+                joinedCoordinates.push_back(coordinates[2*point]);
+                joinedCoordinates.push_back(coordinates[2*point+1]);
+            }
+
+            auto next = links[2*path + (forward ? 1 : 0)];
+
+            if(next == -1 || visited[next/2])
+                break;
+
+            path = next/2;
+            forward = next % 2 == 0;
+        }
+
+        joinedPathStarts.push_back(static_cast<qint64>(joinedCoordinates.size()/2));
+        joinedRingFlags.push_back(false);
+    };
+
+    // Start from the free ends first, the lines that are left are loops
+    for(int path = 0; path<numPaths; ++path)
+    {
+        if(visited[path] || ringFlags[path])
+            continue;
+
+        if(links[2*path] == -1)
+            joinFrom(path, true);
+        else if(links[2*path+1] == -1)
+            joinFrom(path, false);
+    }
+
+    for(int path = 0; path<numPaths; ++path)
+    {
+        if(visited[path] || ringFlags[path])
+            continue;
+
+        joinFrom(path, true);
+    }
+
+    // The rings are kept as they are
+    for(int path = 0; path<numPaths; ++path)
+    {
+        if(!ringFlags[path])
+            continue;
+
+        joinedCoordinates.insert(joinedCoordinates.end(), coordinates.begin() + 2*pathStarts[path], coordinates.begin() + 2*pathStarts[path+1]);
+        joinedPathStarts.push_back(static_cast<qint64>(joinedCoordinates.size()/2));
+        joinedRingFlags.push_back(true);
+    }
+
+    coordinates.swap(joinedCoordinates);
+    pathStarts.swap(joinedPathStarts);
+    ringFlags.swap(joinedRingFlags);
+
+    levels.clear();
+}
+
+
+void GeometrySimplifier::computeLevels(const std::vector<double>& tolerances)
+{
+    auto numPaths = this->getNumberOfPaths();
+    auto numPoints = this->getNumberOfPoints();
+
+    auto isJunction = this->findJunctions();
+
+    ranks.assign(numPoints, 0.0);
+    for(qint64 i = 0; i<numPoints; ++i)
+    {
+        if(isJunction[i])
+            ranks[i] = std::numeric_limits<double>::infinity();
+    }
+
+    // Each path is cut into sections at its junctions, the paths are ranked in chunks on the worker threads
+    std::vector<int> chunkStarts;
+    for(int start = 0; start<numPaths; start += chunkSize)
+        chunkStarts.push_back(start);
+
+    QtConcurrent::blockingMap(chunkStarts, [&](const int chunkStart)
+    {
+        std::vector<std::pair<qint64, qint64>> stack;
+
+        for(int path = chunkStart; path<std::min(chunkStart + chunkSize, numPaths); ++path)
+        {
+            auto sectionStart = pathStarts[path];
+
+            for(qint64 point = pathStarts[path]+1; point<pathStarts[path+1]; ++point)
+            {
+                if(!isJunction[point])
+                    continue;
+
+                this->rankSection(sectionStart, point, stack);
+                sectionStart = point;
+            }
+        }
+    });
+
+    levels.clear();
+    levels.resize(tolerances.size());
+
+    for(size_t i = 0; i<tolerances.size(); ++i)
+        levels[i].tolerance = tolerances[i];
+
+    // Each level only keeps the points ranked at or above its tolerance
+    QtConcurrent::blockingMap(levels, [&](Level& level)
+    {
+        level.pathStarts.reserve(numPaths+1);
+        level.pathStarts.push_back(0);
+
+        for(int path = 0; path<numPaths; ++path)
+        {
+            auto firstCoordinate = level.coordinates.size();
+
+            for(qint64 point = pathStarts[path]; point<pathStarts[path+1]; ++point)
+            {
+                if(ranks[point] < level.tolerance)
+                    continue;
+
+                level.coordinates.push_back(coordinates[2*point]);
+                level.coordinates.push_back(coordinates[2*point+1]);
+            }
+
+            // A ring needs at least three distinct points
+            if(ringFlags[path] && level.coordinates.size() - firstCoordinate < 8)
+                level.coordinates.resize(firstCoordinate);
+
+            level.pathStarts.push_back(static_cast<qint64>(level.coordinates.size()/2));
+        }
+    });
+}
+
+
+int GeometrySimplifier::getNumberOfPaths(void) const
+{
+    return static_cast<int>(pathStarts.size()) - 1;
+}
+
+
+int GeometrySimplifier::getNumberOfLevels(void) const
+{
+    return static_cast<int>(levels.size());
+}
+
+
+std::vector<double> GeometrySimplifier::getPath(const int level, const int path) const
+{
+    if(level < 0 || level >= this->getNumberOfLevels() || path < 0 || path >= this->getNumberOfPaths())
+        return std::vector<double>();
+
+    const auto& theLevel = levels[level];
+
+    return std::vector<double>(theLevel.coordinates.begin() + 2*theLevel.pathStarts[path], theLevel.coordinates.begin() + 2*theLevel.pathStarts[path+1]);
+}
+
+
+qint64 GeometrySimplifier::getNumberOfPoints(const int level) const
+{
+    if(level == -1)
+        return static_cast<qint64>(coordinates.size()/2);
+
+    if(level < 0 || level >= this->getNumberOfLevels())
+        return 0;
+
+    return static_cast<qint64>(levels[level].coordinates.size()/2);
+}
+
+
+void GeometrySimplifier::clear(void)
+{
+    coordinates.clear();
+    pathStarts.assign(1, 0);
+    ringFlags.clear();
+    ranks.clear();
+    levels.clear();
+}
+
+
+qint64 GeometrySimplifier::getPointKey(const qint64 point) const
+{
+    auto x = static_cast<qint32>(std::llround(coordinates[2*point]*unitsPerDegree));
+    auto y = static_cast<qint32>(std::llround(coordinates[2*point+1]*unitsPerDegree));
+
+    return (static_cast<qint64>(x) << 32) | static_cast<quint32>(y);
+}
+
+
+std::vector<char> GeometrySimplifier::findJunctions(void) const
+{
+    auto numPaths = this->getNumberOfPaths();
+    auto numPoints = this->getNumberOfPoints();
+
+    // A point is a junction if it is the end of a line, or if its neighbours are not the same on every path that passes through it
+    struct Neighbours
+    {
+        qint64 first;
+        qint64 second;
+        bool isJunction;
+    };
+
+    const auto none = std::numeric_limits<qint64>::min();
+
+    QHash<qint64, Neighbours> points;
+    points.reserve(static_cast<int>(std::min<qint64>(numPoints, std::numeric_limits<int>::max())));
+
+    for(int path = 0; path<numPaths; ++path)
+    {
+        auto start = pathStarts[path];
+        auto numPathPoints = pathStarts[path+1] - start;
+
+        // The last point of a ring is the same as its first point
+        auto isRing = ringFlags[path] && numPathPoints >= 4;
+        auto numVertices = isRing ? numPathPoints - 1 : numPathPoints;
+
+        for(qint64 k = 0; k<numVertices; ++k)
+        {
+            qint64 previous = none;
+            qint64 next = none;
+
+            if(isRing)
+            {
+                previous = this->getPointKey(start + (k + numVertices - 1) % numVertices);
+                next = this->getPointKey(start + (k + 1) % numVertices);
+            }
+            else
+            {
+                if(k > 0)
+                    previous = this->getPointKey(start + k - 1);
+
+                if(k < numVertices - 1)
+                    next = this->getPointKey(start + k + 1);
+            }
+
+            auto first = std::min(previous, next);
+            auto second = std::max(previous, next);
+
+            auto isEnd = !isRing && (k == 0 || k == numVertices - 1);
+
+            auto key = this->getPointKey(start + k);
+
+            auto it = points.find(key);
+            if(it == points.end())
+                points.insert(key, Neighbours{first, second, isEnd});
+            else if(isEnd || it->first != first || it->second != second)
+                it->isJunction = true;
+        }
+    }
+
+    // Rings are cut at their first point, which is then cut in every path
+    for(int path = 0; path<numPaths; ++path)
+    {
+        if(ringFlags[path] && pathStarts[path+1] > pathStarts[path])
+            points[this->getPointKey(pathStarts[path])].isJunction = true;
+    }
+
+    std::vector<char> isJunction(numPoints, false);
+
+    for(int path = 0; path<numPaths; ++path)
+    {
+        auto start = pathStarts[path];
+        auto end = pathStarts[path+1];
+
+        for(qint64 point = start; point<end; ++point)
+            isJunction[point] = points.value(this->getPointKey(point)).isJunction;
+
+        // The ends of each path close its sections
+        if(end > start)
+        {
+            isJunction[start] = true;
+            isJunction[end-1] = true;
+        }
+    }
+
+    return isJunction;
+}
+
+
+void GeometrySimplifier::rankSection(const qint64 start, const qint64 end, std::vector<std::pair<qint64, qint64>>& stack)
+{
+    if(end - start < 2)
+        return;
+
+    // The section is ranked from the end with the smaller key
+    auto startKey = this->getPointKey(start);
+    auto endKey = this->getPointKey(end);
+
+    auto reversed = endKey < startKey;
+    if(endKey == startKey)
+        reversed = this->getPointKey(end-1) < this->getPointKey(start+1);
+
+    // The points are projected on a plane around the section, in meters
+    const double pi = 3.14159265358979323846;
+    auto xScale = metersPerDegree*std::cos(0.5*(coordinates[2*start+1] + coordinates[2*end+1])*pi/180.0);
+    auto yScale = metersPerDegree;
+
+    stack.clear();
+    stack.push_back(std::make_pair(start, end));
+
+    while(!stack.empty())
+    {
+        auto segment = stack.back();
+        stack.pop_back();
+
+        auto a = segment.first;
+        auto b = segment.second;
+
+        if(b - a < 2)
+            continue;
+
+        auto ax = coordinates[2*a]*xScale;
+        auto ay = coordinates[2*a+1]*yScale;
+        auto dx = coordinates[2*b]*xScale - ax;
+        auto dy = coordinates[2*b+1]*yScale - ay;
+        auto lengthSquared = dx*dx + dy*dy;
+
+        double maxDistance = -1.0;
+        qint64 farthest = -1;
+
+        for(qint64 k = 1; k<b-a; ++k)
+        {
+            auto point = reversed ? b - k : a + k;
+
+            auto px = coordinates[2*point]*xScale - ax;
+            auto py = coordinates[2*point+1]*yScale - ay;
+
+            // Distance to the segment, or to the point if the segment is closed
+            auto t = lengthSquared > 0.0 ? std::max(0.0, std::min(1.0, (px*dx + py*dy)/lengthSquared)) : 0.0;
+
+            auto ex = px - t*dx;
+            auto ey = py - t*dy;
+
+            auto distance = std::sqrt(ex*ex + ey*ey);
+
+            if(distance > maxDistance)
+            {
+                maxDistance = distance;
+                farthest = point;
+            }
+        }
+
+        // A point is never kept longer than the points of the segment it splits
+        ranks[farthest] = std::min(maxDistance, std::min(ranks[a], ranks[b]));
+
+        stack.push_back(std::make_pair(a, farthest));
+        stack.push_back(std::make_pair(farthest, b));
+    }
+}
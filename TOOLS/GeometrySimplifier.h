@@ -0,0 +1,114 @@
+#ifndef GEOMETRYSIMPLIFIER_H
+#define GEOMETRYSIMPLIFIER_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include <QtGlobal>
+
+#include <vector>
+
+// Simplifies lines and polygons so that they can be drawn with fewer points at smaller map scales
+// The paths are given as longitude and latitude pairs in WGS84. They are cut into sections at the junctions, i.e., the points where paths meet or split, and each section is simplified with the Douglas-Peucker algorithm
+// The junctions are never removed, and a section shared by several paths is simplified the same way in each path, so that connected lines and adjacent polygons stay connected at every level
+// The vertices are ranked once by the tolerance up to which they are kept, so that each level only filters the vertices by its tolerance
+class GeometrySimplifier
+{
+public:
+    GeometrySimplifier();
+
+    // Adds a path and returns its index. The last point of a ring is the same as its first point
+    int addPath(const std::vector<double>& coordinates, const bool isRing);
+
+    // Joins the lines whose ends meet at a point that is on no other path, so that a network of short segments is simplified across the segments
+    // The paths are numbered anew, so only call it when the paths do not have to be matched to the features they were added from
+    void joinPaths(void);
+
+    // Ranks the vertices and computes the simplified paths for each tolerance, in meters, on worker threads
+    void computeLevels(const std::vector<double>& tolerances);
+
+    int getNumberOfPaths(void) const;
+    int getNumberOfLevels(void) const;
+
+    // Returns the coordinates of the path at the level, empty if a ring collapses at the tolerance of the level
+    std::vector<double> getPath(const int level, const int path) const;
+
+    // Returns the number of points of all of the paths at the level, or in full if the level is -1
+    qint64 getNumberOfPoints(const int level = -1) const;
+
+    void clear(void);
+
+private:
+
+    // The coordinates are quantized to find the points that are shared by the paths
+    static constexpr double unitsPerDegree = 1.0e7;
+    static constexpr double metersPerDegree = 111319.49;
+
+    // Paths are ranked in chunks on the worker threads
+    static const int chunkSize = 1024;
+
+    qint64 getPointKey(const qint64 point) const;
+
+    // Marks the points where the paths are cut into sections
+    std::vector<char> findJunctions(void) const;
+
+    // Ranks the vertices between the points start and end of a section by the Douglas-Peucker algorithm
+    // The section is always ranked in the same direction, whichever way the path runs, so that a shared section gets the same ranks in every path
+    void rankSection(const qint64 start, const qint64 end, std::vector<std::pair<qint64, qint64>>& stack);
+
+    // Longitude and latitude pairs of the points of all of the paths
+    std::vector<double> coordinates;
+
+    // The index of the first point of each path, with the number of points at the end
+    std::vector<qint64> pathStarts;
+
+    std::vector<char> ringFlags;
+
+    // The largest tolerance, in meters, at which each point is kept
+    std::vector<double> ranks;
+
+    struct Level
+    {
+        double tolerance;
+        std::vector<qint64> pathStarts;
+        std::vector<double> coordinates;
+    };
+
+    std::vector<Level> levels;
+};
+
+#endif // GEOMETRYSIMPLIFIER_H
@@ -0,0 +1,350 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "GzipInputDevice.h"
+
+#include <QMutexLocker>
+#include <QThread>
+
+#include <algorithm>
+#include <cstring>
+
+#include <zlib.h>
+
+GzipInputDevice::GzipInputDevice(const QString& pathToFile, QObject* parent) : QIODevice(parent), file(pathToFile)
+{
+    finished = false;
+    stopRequested = false;
+    currentPos = 0;
+}
+
+
+GzipInputDevice::~GzipInputDevice()
+{
+    this->close();
+}
+
+
+bool GzipInputDevice::open(OpenMode mode)
+{
+    if(mode & QIODevice::WriteOnly)
+    {
+        this->setErrorString("Writing to a compressed file is not supported");
+        return false;
+    }
+
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        this->setErrorString("Cannot find the file: " + file.fileName() + "\nCheck your directory and try again.");
+        return false;
+    }
+
+    finished = false;
+    stopRequested = false;
+    inflateError.clear();
+    blocks.clear();
+    currentBlock.clear();
+    currentPos = 0;
+
+    // The inflated data is handed over in blocks, so there is no need for the buffer of QIODevice
+    QIODevice::open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+
+    worker.reset(QThread::create([this]{ this->inflateFile(); }));
+    worker->start();
+
+    return true;
+}
+
+
+void GzipInputDevice::close()
+{
+    if(worker)
+    {
+        {
+            QMutexLocker locker(&mutex);
+            stopRequested = true;
+            spaceAvailable.wakeAll();
+        }
+
+        worker->wait();
+        worker.reset();
+    }
+
+    blocks.clear();
+    currentBlock.clear();
+    currentPos = 0;
+
+    if(file.isOpen())
+        file.close();
+
+    if(this->isOpen())
+        QIODevice::close();
+}
+
+
+bool GzipInputDevice::isSequential() const
+{
+    return true;
+}
+
+
+bool GzipInputDevice::isCompressed(const QString& pathToFile)
+{
+    QFile inputFile(pathToFile);
+
+    if(!inputFile.open(QIODevice::ReadOnly))
+        return false;
+
+    char signature[2];
+    if(inputFile.read(signature, 2) != 2)
+        return false;
+
+    return static_cast<uchar>(signature[0]) == 0x1f && static_cast<uchar>(signature[1]) == 0x8b;
+}
+
+
+QByteArray GzipInputDevice::readFile(const QString& pathToFile, QString& err)
+{
+    if(!isCompressed(pathToFile))
+    {
+        QFile inputFile(pathToFile);
+
+        if(!inputFile.open(QIODevice::ReadOnly))
+        {
+            err = "Cannot find the file: " + pathToFile + "\nCheck your directory and try again.";
+            return QByteArray();
+        }
+
+        return inputFile.readAll();
+    }
+
+    GzipInputDevice device(pathToFile);
+
+    if(!device.open(QIODevice::ReadOnly))
+    {
+        err = device.errorString();
+        return QByteArray();
+    }
+
+    QByteArray data;
+
+    while(true)
+    {
+        // Read directly into the end of the array
+        auto size = data.size();
+        data.resize(size + outputBlockSize);
+
+        auto numRead = device.read(data.data() + size, outputBlockSize);
+
+        if(numRead < 0)
+        {
+            err = "Error reading the file: " + pathToFile + "\n" + device.errorString();
+            return QByteArray();
+        }
+
+        data.resize(static_cast<int>(size + numRead));
+
+        if(numRead == 0)
+            break;
+    }
+
+    return data;
+}
+
+
+qint64 GzipInputDevice::readData(char* data, qint64 maxSize)
+{
+    qint64 numCopied = 0;
+
+    while(numCopied < maxSize)
+    {
+        if(currentPos < currentBlock.size())
+        {
+            auto numBytes = std::min(maxSize - numCopied, static_cast<qint64>(currentBlock.size() - currentPos));
+
+            std::memcpy(data + numCopied, currentBlock.constData() + currentPos, static_cast<size_t>(numBytes));
+
+            numCopied += numBytes;
+            currentPos += static_cast<int>(numBytes);
+
+            continue;
+        }
+
+        QMutexLocker locker(&mutex);
+
+        while(blocks.empty() && !finished)
+            blockAvailable.wait(&mutex);
+
+        if(blocks.empty())
+        {
+            if(!inflateError.isEmpty())
+            {
+                this->setErrorString(inflateError);
+
+                // Return the data that was read before the error first
+                return numCopied > 0 ? numCopied : -1;
+            }
+
+            break;
+        }
+
+        currentBlock = blocks.front();
+        currentPos = 0;
+
+        blocks.pop_front();
+
+        spaceAvailable.wakeOne();
+    }
+
+    return numCopied;
+}
+
+
+qint64 GzipInputDevice::writeData(const char*, qint64)
+{
+    return -1;
+}
+
+
+void GzipInputDevice::inflateFile(void)
+{
+    z_stream stream;
+    std::memset(&stream, 0, sizeof(stream));
+
+    // 15 window bits plus 32 detects a gzip or zlib header automatically
+    if(inflateInit2(&stream, 15 + 32) != Z_OK)
+    {
+        this->setInflateError("Could not initialize the decompression of the file " + file.fileName());
+        return;
+    }
+
+    QByteArray input(inputBlockSize, Qt::Uninitialized);
+
+    bool streamEnded = false;
+
+    while(true)
+    {
+        if(stream.avail_in == 0)
+        {
+            auto numRead = file.read(input.data(), inputBlockSize);
+
+            if(numRead < 0)
+            {
+                this->setInflateError("Error reading the file " + file.fileName() + "\n" + file.errorString());
+                break;
+            }
+
+            if(numRead == 0)
+            {
+                if(!streamEnded)
+                    this->setInflateError("The compressed file " + file.fileName() + " is truncated");
+                break;
+            }
+
+            // A file can consist of several gzip members one after another
+            if(streamEnded)
+            {
+                inflateReset(&stream);
+                streamEnded = false;
+            }
+
+            stream.next_in = reinterpret_cast<Bytef*>(input.data());
+            stream.avail_in = static_cast<uInt>(numRead);
+        }
+
+        QByteArray output(outputBlockSize, Qt::Uninitialized);
+
+        stream.next_out = reinterpret_cast<Bytef*>(output.data());
+        stream.avail_out = static_cast<uInt>(outputBlockSize);
+
+        auto res = inflate(&stream, Z_NO_FLUSH);
+
+        if(res == Z_STREAM_END)
+        {
+            streamEnded = true;
+
+            if(stream.avail_in > 0)
+            {
+                inflateReset(&stream);
+                streamEnded = false;
+            }
+        }
+        else if(res != Z_OK && res != Z_BUF_ERROR)
+        {
+            this->setInflateError("Error decompressing the file " + file.fileName() + ": " + QString(stream.msg != nullptr ? stream.msg : "corrupt data"));
+            break;
+        }
+
+        output.resize(outputBlockSize - static_cast<int>(stream.avail_out));
+
+        if(!output.isEmpty() && !this->pushBlock(output))
+            break;
+    }
+
+    inflateEnd(&stream);
+
+    QMutexLocker locker(&mutex);
+    finished = true;
+    blockAvailable.wakeAll();
+}
+
+
+bool GzipInputDevice::pushBlock(const QByteArray& block)
+{
+    QMutexLocker locker(&mutex);
+
+    while(static_cast<int>(blocks.size()) >= maxQueuedBlocks && !stopRequested)
+        spaceAvailable.wait(&mutex);
+
+    if(stopRequested)
+        return false;
+
+    blocks.push_back(block);
+    blockAvailable.wakeOne();
+
+    return true;
+}
+
+
+void GzipInputDevice::setInflateError(const QString& err)
+{
+    QMutexLocker locker(&mutex);
+    inflateError = err;
+    finished = true;
+    blockAvailable.wakeAll();
+}
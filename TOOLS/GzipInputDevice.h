@@ -0,0 +1,112 @@
+#ifndef GZIPINPUTDEVICE_H
+#define GZIPINPUTDEVICE_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+
+// Written by: Stevan Gavrilovic
+
+#include <QByteArray>
+#include <QFile>
+#include <QIODevice>
+#include <QMutex>
+#include <QString>
+#include <QWaitCondition>
+
+#include <deque>
+#include <memory>
+
+class QThread;
+
+// Read-only device that inflates a gzip compressed file as it is read
+// The file is read and inflated on a separate thread, a few blocks ahead of the reader, so that the decompression runs in parallel with the parsing of the data
+// Reads block until inflated data is available; a read returns 0 at the end of the data and -1 if the file is corrupt
+class GzipInputDevice : public QIODevice
+{
+public:
+    GzipInputDevice(const QString& pathToFile, QObject* parent = nullptr);
+    ~GzipInputDevice() override;
+
+    bool open(OpenMode mode) override;
+    void close() override;
+
+    bool isSequential() const override;
+
+    // Returns true if the file starts with the gzip signature
+    static bool isCompressed(const QString& pathToFile);
+
+    // Reads the whole file into memory, the file is inflated if it is compressed. Returns an empty array and sets the error on failure
+    static QByteArray readFile(const QString& pathToFile, QString& err);
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override;
+    qint64 writeData(const char* data, qint64 maxSize) override;
+
+private:
+
+    // Runs on the worker thread
+    void inflateFile(void);
+
+    // Hands a block of inflated data to the reader, waits if the reader is too far behind
+    bool pushBlock(const QByteArray& block);
+
+    void setInflateError(const QString& err);
+
+    static const int inputBlockSize = 1024*1024;
+    static const int outputBlockSize = 4*1024*1024;
+
+    // Maximum number of inflated blocks that are waiting for the reader
+    static const int maxQueuedBlocks = 4;
+
+    QFile file;
+
+    std::unique_ptr<QThread> worker;
+
+    QMutex mutex;
+    QWaitCondition blockAvailable;
+    QWaitCondition spaceAvailable;
+
+    std::deque<QByteArray> blocks;
+    bool finished;
+    bool stopRequested;
+    QString inflateError;
+
+    // The block that is currently being read
+    QByteArray currentBlock;
+    int currentPos;
+};
+
+#endif // GZIPINPUTDEVICE_H
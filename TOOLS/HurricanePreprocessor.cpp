@@ -38,12 +38,14 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 #include "HurricanePreprocessor.h"
 #include "CSVReaderWriter.h"
+#include "CSVTokenizer.h"
 #include "VisualizationWidget.h"
 
 #include <QProgressBar>
 #include <QList>
 #include <QApplication>
 #include <QObject>
+#include <QLocale>
 
 // GIS Layers
 #include "Feature.h"
@@ -68,87 +70,128 @@ int HurricanePreprocessor::loadHurricaneTrackData(const QString &eventFile, QStr
 {
     CSVReaderWriter csvTool;
 
-    QVector<QStringList> data = csvTool.parseCSVFile(eventFile, err);
+    QStringList headerData;
+    int numCol = 0;
+    int indexLandfall = -1;
+    int indexSID = -1;
+    int indexName = -1;
+    int indexSeason = -1;
 
-    if(!err.isEmpty())
-    {
-        return -1;
-    }
-
-    if(data.empty())
-    {
-        err = "Hurricane data is empty";
-        return -1;
-    }
-
-    // Get the header information to populate the fields
-    auto headerData = data.at(0);
-
-    auto numCol = headerData.size();
-
-    // Pop off the first two rows that contain the header and units information
-    data.pop_front();
-    data.pop_front();
+    // Only the parameters that are used are converted to numbers, all of the columns are kept in the raw text of the row
+    const QStringList usedParameters = {"LAT", "LON", "USA_LAT", "USA_LON", "STORM_DIR", "STORM_SPEED", "USA_PRES", "WMO_PRES", "USA_RMW", "REUNION_RMW"};
 
+    QStringList parameterLabels;
+    QVector<int> parameterIndexes;
 
     // Split the hurricanes up as they come in one long list
-    QVectorIterator<QStringList> i(data);
     QString SID;
 
     HurricaneObject hurricane;
-    hurricane.parameterLabels = headerData;
-
-    auto indexLandfall = headerData.indexOf("DIST2LAND");
-    auto indexSID = headerData.indexOf("SID");
-
-    if(indexLandfall == -1 || indexSID == -1)
-    {
-        err = "Could not find the required column indexes in the data file";
-        return -1;
-    }
 
     // While iterating through the hurricane points, save the data at first landfall
     bool landfallFound = false;
-    while (i.hasNext())
+
+    // Stream the rows from the file so that only the current hurricane is held in memory besides the ones already processed
+    auto rowVisitor = [&](const CSVRow& csvRow, const int rowNumber)
     {
-        auto row = i.next();
+        // Get the header information to populate the fields
+        if(rowNumber == 0)
+        {
+            headerData = csvRow.toStringList();
+            numCol = headerData.size();
+
+            indexLandfall = headerData.indexOf("DIST2LAND");
+            indexSID = headerData.indexOf("SID");
+            indexName = headerData.indexOf("NAME");
+            indexSeason = headerData.indexOf("SEASON");
+
+            if(indexLandfall == -1 || indexSID == -1 || indexName == -1 || indexSeason == -1)
+            {
+                err = "Could not find the required column indexes in the data file";
+                return false;
+            }
+
+            for(auto&& it : usedParameters)
+            {
+                auto index = headerData.indexOf(it);
+
+                if(index == -1)
+                    continue;
+
+                parameterLabels.append(it);
+                parameterIndexes.append(index);
+            }
+
+            hurricane.parameterLabels = parameterLabels;
+            hurricane.trackPointLabels = headerData;
+
+            return true;
+        }
 
-        if(row.size() != numCol)
+        // Skip the second row that contains the units information
+        if(rowNumber == 1)
+            return true;
+
+        if(csvRow.size() != numCol)
         {
             err = "Error, inconsistency in the data in the row and number of columns";
-            return -1;
+            return false;
+        }
+
+        auto currSID = csvRow.at(indexSID);
+
+        if(SID.compare(currSID) != 0)
+        {
+            if(!hurricane.empty())
+            {
+                hurricanes.push_back(hurricane);
+                hurricane.clear();
+                landfallFound = false;
+            }
+
+            SID = currSID;
+
+            hurricane.SID = currSID;
+            hurricane.name = csvRow.at(indexName);
+            hurricane.season = csvRow.at(indexSeason);
         }
 
         // Not all hurricanes will make landfall
         if(!landfallFound)
         {
-            auto distToLand = row.at(indexLandfall);
+            auto distToLand = csvRow.at(indexLandfall);
 
             // If the distance to land is 0, then this is the first landfall
             if(distToLand.compare("0") == 0)
             {
                 landfallFound = true;
-                hurricane.landfallData = row;
+                hurricane.landfallData = csvRow.toStringList();
+                hurricane.landfallLabels = headerData;
                 hurricane.indexLandfall = hurricane.size();
             }
         }
 
-        auto currSID = row.at(indexSID);
-
-        if(SID.compare(currSID) != 0)
+        QVector<double> trackPoint(parameterIndexes.size());
+        for(int i = 0; i<parameterIndexes.size(); ++i)
         {
-            if(!hurricane.empty())
-            {
-                hurricanes.push_back(hurricane);
-                hurricane.clear();
-                landfallFound = false;
-            }
+            bool ok = false;
+            auto value = csvRow.at(parameterIndexes.at(i)).toDouble(&ok);
 
-            SID = currSID;
+            trackPoint[i] = ok ? value : std::numeric_limits<double>::quiet_NaN();
         }
 
-        hurricane.push_back(row);
-    }
+        auto rowText = csvRow.toByteArray();
+        rowText.append('\n');
+
+        hurricane.push_back(trackPoint, rowText);
+
+        return true;
+    };
+
+    auto res = csvTool.parseCSVFile(eventFile, rowVisitor, err);
+
+    if(res != 0 || !err.isEmpty())
+        return -1;
 
     // Push back the last hurricane
     if(!hurricane.empty())
@@ -161,18 +204,6 @@ int HurricanePreprocessor::loadHurricaneTrackData(const QString &eventFile, QStr
     theProgressBar->reset();
     QApplication::processEvents();
 
-    // Name and storm ID
-    auto indexName = headerData.indexOf("NAME");
-    auto indexSeason = headerData.indexOf("SEASON");
-
-    // Check that the indexes are found
-    if(indexName == -1 || indexSID == -1 || indexSeason == -1)
-    {
-        err = "Could not find the required column indexes in the data file";
-        return -1;
-    }
-
-
     // Create the feature collection table/layers
     QList<Field> trackFields;
     trackFields.append(Field::createText("NAME", "NULL",4));
@@ -223,13 +254,9 @@ int HurricanePreprocessor::loadHurricaneTrackData(const QString &eventFile, QStr
         // Get the hurricane
         HurricaneObject& hurricane = hurricanes[i];
 
-        auto name = hurricane.front().at(indexName);
-        auto SID = hurricane.front().at(indexSID);
-        auto season = hurricane.front().at(indexSeason);
-
-        hurricane.name = name;
-        hurricane.SID = SID;
-        hurricane.season = season;
+        auto name = hurricane.name;
+        auto SID = hurricane.SID;
+        auto season = hurricane.season;
         auto nameID = name+"-"+season;
 
         // Create a unique ID for this track
@@ -361,14 +388,14 @@ Geometry HurricanePreprocessor::getTrackGeometry(HurricaneObject* hurricane, QSt
 
     for(int j = 0; j<hurricane->size(); ++j)
     {
-        QStringList trackPoint = (*hurricane)[j];
+        const auto& trackPoint = (*hurricane)[j];
 
         Point pointPrev(longitude,latitude);
 
         // Create the geometry for visualization
         // By default will use USA_LAT and USA_LON, if not available fall back on the LAT and LON below
-        latitude = trackPoint.at(indexLat).toDouble();
-        longitude = trackPoint.at(indexLon).toDouble();
+        latitude = trackPoint.at(indexLat);
+        longitude = trackPoint.at(indexLon);
 
         //  if(latitude == 0.0 || longitude == 0.0)
         //  {
@@ -438,8 +465,11 @@ LayerTreeItem*  HurricanePreprocessor::createTrackPointsVisualization(HurricaneO
     pointFields.append(Field::createText("TabName", "NULL",4));
     pointFields.append(Field::createText("UID", "NULL",4));
 
-    // Full fields
-    for(auto&& it : headerData)
+    // Full fields, all of the columns of the data file if the rows of the track points were kept, otherwise the parameters that were kept as numbers
+    const bool hasRows = hurricane->hasTrackPointRows();
+    const auto fieldLabels = hasRows ? hurricane->trackPointLabels : headerData;
+
+    for(auto&& it : fieldLabels)
     {
         pointFields.append(Field::createText(it, "NULL",4));
     }
@@ -468,14 +498,27 @@ LayerTreeItem*  HurricanePreprocessor::createTrackPointsVisualization(HurricaneO
     for(int j = 0; j<numPnts; ++j)
     {
 
-        QStringList trackPoint = (*hurricane)[j];
+        const auto& trackPoint = (*hurricane)[j];
 
         //create the feature attributes
         QMap<QString, QVariant> featureAttributes;
-        for(int k = 0; k<headerData.size(); ++k)
+        if(hasRows)
         {
-            if(!trackPoint.at(k).isEmpty())
-                featureAttributes.insert(headerData.at(k), trackPoint.at(k));
+            auto rowValues = hurricane->getTrackPointRow(j);
+
+            for(int k = 0; k<rowValues.size() && k<fieldLabels.size(); ++k)
+            {
+                if(!rowValues.at(k).isEmpty())
+                    featureAttributes.insert(fieldLabels.at(k), rowValues.at(k));
+            }
+        }
+        else
+        {
+            for(int k = 0; k<headerData.size(); ++k)
+            {
+                if(!std::isnan(trackPoint.at(k)))
+                    featureAttributes.insert(headerData.at(k), QString::number(trackPoint.at(k), 'g', QLocale::FloatingPointShortest));
+            }
         }
 
         auto uid = theVisualizationWidget->createUniqueID();
@@ -486,8 +529,8 @@ LayerTreeItem*  HurricanePreprocessor::createTrackPointsVisualization(HurricaneO
 
         // Create the geometry for visualization
         // By default will use USA_LAT and USA_LON, if not available fall back on the LAT and LON below
-        auto latitude = trackPoint.at(indexLat).toDouble();
-        auto longitude = trackPoint.at(indexLon).toDouble();
+        auto latitude = trackPoint.at(indexLat);
+        auto longitude = trackPoint.at(indexLon);
 
         //  if(latitude == 0.0 || longitude == 0.0)
         //  {
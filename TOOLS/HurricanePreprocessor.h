@@ -38,11 +38,17 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 // Written by: Stevan Gavrilovic
 
+#include "CSVTokenizer.h"
+
+#include <QByteArray>
 #include <QString>
 #include <QStringList>
 #include <QVector>
 #include <QVariant>
 
+#include <cmath>
+#include <limits>
+
 class VisualizationWidget;
 class LayerTreeItem;
 
@@ -63,38 +69,51 @@ struct HurricaneObject{
 
 public:
 
-    QVector<QStringList>& getHurricaneData(){
+    // The values at each track point, in the order of the parameter labels. Only the parameters that are used are kept, and the values that are missing are NaN
+    QVector<QVector<double>>& getHurricaneData(){
         return hurricaneData;
     }
 
-    QStringList& operator[](int index) {
+    QVector<double>& operator[](int index) {
 
         return hurricaneData[index];
     }
 
 
-    QStringList trackPointAtLatLon(double lat, double lon)
+    QVector<double> trackPointAtLatLon(double lat, double lon)
+    {
+        auto index = this->trackPointIndexAtLatLon(lat, lon);
+
+        if(index == -1)
+            return QVector<double>();
+
+        return hurricaneData.at(index);
+    }
+
+
+    // Returns -1 if there is no track point at the location
+    int trackPointIndexAtLatLon(double lat, double lon)
     {
         auto latIndex = parameterLabels.indexOf("LAT");
         auto lonIndex = parameterLabels.indexOf("LON");
 
         if(latIndex == -1 || lonIndex == -1)
-            return QStringList();
+            return -1;
 
-        for(auto&& it : hurricaneData)
+        for(int i = 0; i<hurricaneData.size(); ++i)
         {
-            auto latD = it.at(latIndex).toDouble();
-            auto lonD = it.at(lonIndex).toDouble();
+            auto latD = hurricaneData.at(i).at(latIndex);
+            auto lonD = hurricaneData.at(i).at(lonIndex);
 
             if((latD-lat)*(latD-lat) + (lonD-lon)*(lonD-lon) <= std::numeric_limits<double>::epsilon())
-                return it;
+                return i;
         }
 
-        return QStringList();
+        return -1;
     }
 
 
-    QStringList& front(void) {
+    QVector<double>& front(void) {
         return hurricaneData.front();
     }
 
@@ -104,12 +123,53 @@ public:
     }
 
 
-    void push_back(const QStringList& data)
+    void push_back(const QVector<double>& data)
     {
         hurricaneData.push_back(data);
     }
 
 
+    // Keeps the row of the data file that the track point was read from, with all of its columns
+    void push_back(const QVector<double>& data, const QByteArray& row)
+    {
+        hurricaneData.push_back(data);
+        trackPointRows.push_back(row);
+    }
+
+
+    // True if every track point has the row of the data file that it was read from
+    bool hasTrackPointRows(void) {
+        return !trackPointRows.isEmpty() && trackPointRows.size() == hurricaneData.size();
+    }
+
+
+    // The values of all of the columns of the data file at the track point, in the order of the track point labels
+    QStringList getTrackPointRow(const int index)
+    {
+        // The row is kept with its newline so that it is split into the same fields as when the file was read
+        const auto& row = trackPointRows.at(index);
+
+        std::vector<quint32> fieldOffsets;
+        qint64 pos = 0;
+        qint64 rowEnd = 0;
+
+        if(!CSVTokenizer::nextRow(row.constData(), row.size(), pos, true, fieldOffsets, rowEnd))
+            return QStringList();
+
+        return CSVRow(row.constData(), 0, rowEnd, fieldOffsets.data(), static_cast<int>(fieldOffsets.size())).toStringList();
+    }
+
+
+    // The values that are not numbers are stored as missing values
+    void push_back(const QStringList& data)
+    {
+        QVector<double> values(data.size());
+
+        for(int i = 0; i<data.size(); ++i)
+            values[i] = toValue(data.at(i));
+
+        hurricaneData.push_back(values);
+    }
 
 
     void push_back(const QList<QVariant>& data)
@@ -119,7 +179,7 @@ public:
         for(auto&& it : data)
             dataAsStringList.append(it.toString());
 
-        hurricaneData.push_back(dataAsStringList);
+        this->push_back(dataAsStringList);
     }
 
 
@@ -130,6 +190,7 @@ public:
 
     void clear() {
         hurricaneData.clear();
+        trackPointRows.clear();
         landfallData.clear();
         name.clear();
         SID.clear();
@@ -141,10 +202,12 @@ public:
     QString getValueOfParameter(const QString& paramName, const int dataPoint) {
         auto indexOfParam = parameterLabels.indexOf(paramName);
 
-        if(indexOfParam == -1 || hurricaneData.size() < dataPoint || dataPoint < 0)
+        if(indexOfParam == -1 || hurricaneData.size() <= dataPoint || dataPoint < 0)
             return QString();
 
-        return hurricaneData.at(dataPoint).at(indexOfParam);
+        auto value = hurricaneData.at(dataPoint).at(indexOfParam);
+
+        return std::isnan(value) ? QString() : QString::number(value);
     }
 
 
@@ -160,101 +223,63 @@ public:
 
     double getLatitudeAtLandfall(void)
     {
-        if(landfallData.empty() || landfallData.size() != parameterLabels.size())
-            return 0.0;
-
         // By default will use USA_LAT and USA_LON, if not available fall back on the LAT and LON below
-        auto indexUSALat = parameterLabels.indexOf("USA_LAT");
-        auto indexLat = parameterLabels.indexOf("LAT");
-
-        if(indexUSALat == -1 || indexLat == -1)
-            return 0.0;
-
-        auto USAlat = landfallData.at(indexUSALat).toDouble();
+        auto USAlat = this->getValueAtLandfall("USA_LAT");
 
         if(USAlat != 0.0)
             return USAlat;
 
-        return landfallData.at(indexLat).toDouble();
+        return this->getValueAtLandfall("LAT");
     }
 
 
     double getLongitudeAtLandfall(void)
     {
-        if(landfallData.empty() || landfallData.size() != parameterLabels.size())
-            return 0.0;
-
         // By default will use USA_LAT and USA_LON, if not available fall back on the LAT and LON below
-        auto indexUSALon = parameterLabels.indexOf("USA_LON");
-        auto indexLon = parameterLabels.indexOf("LON");
-
-        if(indexUSALon == -1 || indexLon == -1)
-            return 0.0;
-
-        auto USAlon = landfallData.at(indexUSALon).toDouble();
+        auto USAlon = this->getValueAtLandfall("USA_LON");
 
         if(USAlon != 0.0)
             return USAlon;
 
-        return landfallData.at(indexLon).toDouble();
+        return this->getValueAtLandfall("LON");
     }
 
 
     // i.e., the storm direction at landfall
     double getLandingAngle(void)
     {
-        if(landfallData.empty() || landfallData.size() != parameterLabels.size())
-            return 0.0;
-
-        auto indexStormDir = parameterLabels.indexOf("STORM_DIR");
-
-        if(indexStormDir == -1)
-            return 0.0;
-
-        return landfallData.at(indexStormDir).toDouble();
+        return this->getValueAtLandfall("STORM_DIR");
     }
 
 
     // Speed in kts
     double getStormSpeedAtLandfall(void)
     {
-        if(landfallData.empty() || landfallData.size() != parameterLabels.size())
-            return 0.0;
-
-        auto indexStormSpeed = parameterLabels.indexOf("STORM_SPEED");
-
-        if(indexStormSpeed == -1)
-            return 0.0;
-
-        return landfallData.at(indexStormSpeed).toDouble();
+        return this->getValueAtLandfall("STORM_SPEED");
     }
 
 
     // Pressure in mb
     double getPressureAtLandfall(void)
     {
-        if(landfallData.empty() || landfallData.size() != parameterLabels.size())
-            return 0.0;
-
         // Default to USA pressure and then WMO pressure if no USA pressure
-        auto indexUSAPress = parameterLabels.indexOf("USA_PRES");
-        auto indexWMOPress = parameterLabels.indexOf("WMO_PRES");
-
-        if(indexUSAPress == -1 || indexWMOPress == -1)
-            return 0.0;
-
-        auto USAPress = landfallData.at(indexUSAPress).toDouble();
+        auto USAPress = this->getValueAtLandfall("USA_PRES");
 
         if(USAPress != 0.0)
             return USAPress;
 
 
         // Check if there is WMO pressure at landfall (WMO data  can have longer intervals and may need to interpolate)
-        auto WMOPress = landfallData.at(indexWMOPress).toDouble();
+        auto WMOPress = this->getValueAtLandfall("WMO_PRES");
 
         if(WMOPress != 0.0)
             return WMOPress;
 
+        auto indexWMOPress = parameterLabels.indexOf("WMO_PRES");
+
+        if(indexWMOPress == -1 || indexLandfall == -1)
+            return 0.0;
+
         // Need to interpolate WMO pressure
 
         // Get the WMO pressure at the timepoint before landfall
@@ -262,7 +287,8 @@ public:
         auto indexBefore = indexLandfall-1;
         while(pressBefore == 0.0 && indexBefore > 0)
         {
-            pressBefore = hurricaneData.at(indexBefore).at(indexWMOPress).toDouble();
+            pressBefore = this->getValue(indexBefore, indexWMOPress);
+            --indexBefore;
         }
 
         // Get the WMO pressure at the timepoint after landfall
@@ -270,7 +296,8 @@ public:
         auto indexAfter = indexLandfall+1;
         while(pressAfter == 0.0 && indexAfter < hurricaneData.size()-1)
         {
-            pressAfter = hurricaneData.at(indexAfter).at(indexWMOPress).toDouble();
+            pressAfter = this->getValue(indexAfter, indexWMOPress);
+            ++indexAfter;
         }
 
         // Throw an error
@@ -285,34 +312,56 @@ public:
     // Storm radius in nautical mile nmile
     double getRadiusAtLandfall(void){
 
-        if(landfallData.empty() || landfallData.size() != parameterLabels.size())
-            return 0.0;
-
-        auto indexOfUSARMW = parameterLabels.indexOf("USA_RMW");
-        auto indexOfReunionRMW = parameterLabels.indexOf("REUNION_RMW");
-
-        if(indexOfUSARMW == -1 || indexOfReunionRMW == -1)
-            return 0.0;
-
-        auto USARMW = landfallData.at(indexOfUSARMW).toDouble();
+        auto USARMW = this->getValueAtLandfall("USA_RMW");
 
         if(USARMW != 0.0)
             return USARMW;
 
-        return landfallData.at(indexOfReunionRMW).toDouble();
-
+        return this->getValueAtLandfall("REUNION_RMW");
     }
 
-    QVector<QStringList> hurricaneData;
+    QVector<QVector<double>> hurricaneData;
     QStringList parameterLabels;
 
+    // The raw text of the row of each track point, including the newline, with the labels from the header of the file
+    QVector<QByteArray> trackPointRows;
+    QStringList trackPointLabels;
+
+    // The full row of the data file at landfall, with the labels from the header of the file
     QStringList landfallData;
+    QStringList landfallLabels;
     int indexLandfall = -1;
 
     QString name;
     QString SID; // The storm id
     QString season; // i.e., the year
 
+private:
+
+    static double toValue(const QString& str)
+    {
+        bool ok = false;
+        auto value = str.toDouble(&ok);
+
+        return ok ? value : std::numeric_limits<double>::quiet_NaN();
+    }
+
+    // The missing values are 0.0, as the data file does not have values for every parameter at every point
+    double getValue(const int dataPoint, const int indexOfParam)
+    {
+        if(indexOfParam == -1 || dataPoint < 0 || dataPoint >= hurricaneData.size())
+            return 0.0;
+
+        auto value = hurricaneData.at(dataPoint).at(indexOfParam);
+
+        return std::isnan(value) ? 0.0 : value;
+    }
+
+    double getValueAtLandfall(const QString& paramName)
+    {
+        return this->getValue(indexLandfall, parameterLabels.indexOf(paramName));
+    }
+
 };
 
 
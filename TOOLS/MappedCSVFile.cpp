@@ -0,0 +1,404 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "GzipInputDevice.h"
+#include "MappedCSVFile.h"
+
+#include <QThread>
+#include <QtConcurrent/QtConcurrentMap>
+
+#include <algorithm>
+
+MappedCSVFile::MappedCSVFile()
+{
+    fileData = nullptr;
+    fileSize = 0;
+
+    nRows = 0;
+    rowStartsData = nullptr;
+    rowEndsData = nullptr;
+    rowFieldIndexData = nullptr;
+    fieldOffsetsData = nullptr;
+}
+
+
+MappedCSVFile::~MappedCSVFile()
+{
+    this->close();
+}
+
+
+int MappedCSVFile::open(const QString& pathToFile, QString& err, const bool useCache)
+{
+    this->close();
+
+    file.setFileName(pathToFile);
+
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        err = "Cannot find the file: " + pathToFile + "\nCheck your directory and try again.";
+        return -1;
+    }
+
+    // A compressed file is inflated into memory
+    if(GzipInputDevice::isCompressed(pathToFile))
+    {
+        fileBuffer = GzipInputDevice::readFile(pathToFile, err);
+
+        if(!err.isEmpty())
+        {
+            this->close();
+            return -1;
+        }
+
+        fileData = fileBuffer.constData();
+        fileSize = fileBuffer.size();
+    }
+
+    auto numBytes = fileData == nullptr ? file.size() : 0;
+
+    if(numBytes > 0)
+    {
+        auto mappedBytes = file.map(0, numBytes);
+
+        if(mappedBytes != nullptr)
+        {
+            fileData = reinterpret_cast<const char*>(mappedBytes);
+            fileSize = numBytes;
+        }
+        else
+        {
+            // Fall back to reading the file into memory
+            fileBuffer = file.readAll();
+            fileData = fileBuffer.constData();
+            fileSize = fileBuffer.size();
+        }
+    }
+
+    const bool cacheIndex = useCache && fileSize >= CSVIndexCache::minFileSize;
+
+    if(cacheIndex && indexCache.load(pathToFile, fileData, fileSize))
+    {
+        nRows = indexCache.numRows();
+        rowStartsData = indexCache.rowStarts();
+        rowEndsData = indexCache.rowEnds();
+        rowFieldIndexData = indexCache.rowFieldIndex();
+        fieldOffsetsData = indexCache.fieldOffsets();
+
+        return 0;
+    }
+
+    this->index();
+
+    nRows = static_cast<qint64>(rowStarts.size());
+    rowStartsData = rowStarts.data();
+    rowEndsData = rowEnds.data();
+    rowFieldIndexData = rowFieldIndex.data();
+    fieldOffsetsData = fieldOffsets.data();
+
+    // A failure to write the cache is not an error, the file is simply indexed again next time
+    if(cacheIndex)
+        CSVIndexCache::save(pathToFile, fileData, fileSize, nRows, rowStartsData, rowEndsData, rowFieldIndexData, fieldOffsetsData);
+
+    return 0;
+}
+
+
+void MappedCSVFile::close(void)
+{
+    rowStarts.clear();
+    rowEnds.clear();
+    rowFieldIndex.clear();
+    fieldOffsets.clear();
+
+    indexCache.close();
+
+    nRows = 0;
+    rowStartsData = nullptr;
+    rowEndsData = nullptr;
+    rowFieldIndexData = nullptr;
+    fieldOffsetsData = nullptr;
+
+    fileBuffer.clear();
+    fileData = nullptr;
+    fileSize = 0;
+
+    // Closing the file also removes the memory mapping
+    if(file.isOpen())
+        file.close();
+}
+
+
+bool MappedCSVFile::isOpen(void) const
+{
+    return file.isOpen();
+}
+
+
+void MappedCSVFile::index(void)
+{
+    rowFieldIndex.push_back(0);
+
+    if(fileData == nullptr)
+        return;
+
+    // Small files are not worth the overhead of the thread pool
+    auto numThreads = QThread::idealThreadCount();
+    auto numChunks = std::min(qint64(numThreads), fileSize/minChunkSize);
+
+    if(numChunks < 2)
+    {
+        this->indexChunk(0, fileSize, true, rowStarts, rowEnds, rowFieldIndex, fieldOffsets);
+        return;
+    }
+
+    this->indexParallel(static_cast<int>(numChunks));
+}
+
+
+void MappedCSVFile::indexChunk(const qint64 chunkStart, const qint64 chunkEnd, const bool atEnd, std::vector<qint64>& starts, std::vector<qint64>& ends, std::vector<qint64>& fieldIndex, std::vector<quint32>& offsets) const
+{
+    // Estimate the number of rows from the first line to avoid reallocating the index
+    qint64 pos = chunkStart;
+    qint64 rowEnd = 0;
+    const auto numFieldsIn = offsets.size();
+    if(CSVTokenizer::nextRow(fileData, chunkEnd, pos, atEnd, offsets, rowEnd))
+    {
+        auto estNumRows = (chunkEnd-chunkStart)/std::max(pos-chunkStart,qint64(1)) + 1;
+        auto numFieldsPerRow = offsets.size() - numFieldsIn;
+
+        starts.reserve(starts.size() + estNumRows);
+        ends.reserve(ends.size() + estNumRows);
+        fieldIndex.reserve(fieldIndex.size() + estNumRows);
+        offsets.reserve(offsets.size() + estNumRows*numFieldsPerRow);
+
+        starts.push_back(chunkStart);
+        ends.push_back(rowEnd);
+        fieldIndex.push_back(offsets.size());
+    }
+
+    auto rowStart = pos;
+    while(CSVTokenizer::nextRow(fileData, chunkEnd, pos, atEnd, offsets, rowEnd))
+    {
+        starts.push_back(rowStart);
+        ends.push_back(rowEnd);
+        fieldIndex.push_back(offsets.size());
+
+        rowStart = pos;
+    }
+}
+
+
+void MappedCSVFile::indexParallel(const int numChunks)
+{
+    struct Chunk
+    {
+        // Nominal byte range of the chunk
+        qint64 begin = 0;
+        qint64 end = 0;
+
+        // Number of double-quotes in the nominal range
+        qint64 numQuotes = 0;
+
+        // True if the nominal start of the chunk falls within a quoted section
+        bool startsInQuotes = false;
+
+        // Start of the first row that begins in the chunk
+        qint64 rowBegin = 0;
+
+        std::vector<qint64> starts;
+        std::vector<qint64> ends;
+        std::vector<qint64> fieldIndex;
+        std::vector<quint32> offsets;
+    };
+
+    std::vector<Chunk> chunks(numChunks);
+
+    const auto nominalSize = fileSize/numChunks;
+    for(int i = 0; i<numChunks; ++i)
+    {
+        chunks[i].begin = i*nominalSize;
+        chunks[i].end = (i == numChunks-1) ? fileSize : (i+1)*nominalSize;
+    }
+
+    const char* data = fileData;
+    const auto size = fileSize;
+
+    // First pass, count the double-quotes in each chunk
+    QtConcurrent::blockingMap(chunks, [data](Chunk& chunk)
+    {
+        chunk.numQuotes = std::count(data + chunk.begin, data + chunk.end, '"');
+    });
+
+    // The quote state at any position is the parity of the double-quotes before it, since an escaped double-quote toggles twice
+    qint64 quotesBefore = 0;
+    for(auto&& chunk : chunks)
+    {
+        chunk.startsInQuotes = (quotesBefore % 2) != 0;
+        quotesBefore += chunk.numQuotes;
+    }
+
+    // Second pass, find the first row boundary in each chunk, i.e., the first newline that is not in a quoted section
+    QtConcurrent::blockingMap(chunks, [data, size](Chunk& chunk)
+    {
+        if(chunk.begin == 0)
+        {
+            chunk.rowBegin = 0;
+            return;
+        }
+
+        if(data[chunk.begin-1] == '\n' && !chunk.startsInQuotes)
+        {
+            chunk.rowBegin = chunk.begin;
+            return;
+        }
+
+        bool inQuotes = chunk.startsInQuotes;
+
+        chunk.rowBegin = size;
+        for(qint64 i = chunk.begin; i < size; ++i)
+        {
+            const char current = data[i];
+
+            if(current == '"')
+                inQuotes = !inQuotes;
+            else if(current == '\n' && !inQuotes)
+            {
+                chunk.rowBegin = i + 1;
+                break;
+            }
+        }
+    });
+
+    // Third pass, tokenize the rows that begin in each chunk. A row that begins in a chunk is tokenized in full even if it extends into the next chunk
+    std::vector<qint64> rowEndsAt(numChunks);
+    for(int i = 0; i<numChunks; ++i)
+        rowEndsAt[i] = (i == numChunks-1) ? size : std::max(chunks[i+1].rowBegin, chunks[i].rowBegin);
+
+    QtConcurrent::blockingMap(chunks, [this, &chunks, &rowEndsAt](Chunk& chunk)
+    {
+        const auto i = &chunk - chunks.data();
+        const auto chunkEnd = rowEndsAt[i];
+
+        if(chunk.rowBegin >= chunkEnd)
+            return;
+
+        // All but the last chunk end right after a newline, so only the last chunk may contain an unterminated row
+        this->indexChunk(chunk.rowBegin, chunkEnd, chunkEnd == fileSize, chunk.starts, chunk.ends, chunk.fieldIndex, chunk.offsets);
+    });
+
+    // Stitch the chunks together in order
+    size_t totalRows = 0;
+    size_t totalFields = 0;
+    for(auto&& chunk : chunks)
+    {
+        totalRows += chunk.starts.size();
+        totalFields += chunk.offsets.size();
+    }
+
+    rowStarts.reserve(totalRows);
+    rowEnds.reserve(totalRows);
+    rowFieldIndex.reserve(totalRows+1);
+    fieldOffsets.reserve(totalFields);
+
+    for(auto&& chunk : chunks)
+    {
+        const qint64 fieldIndexOffset = fieldOffsets.size();
+
+        rowStarts.insert(rowStarts.end(), chunk.starts.begin(), chunk.starts.end());
+        rowEnds.insert(rowEnds.end(), chunk.ends.begin(), chunk.ends.end());
+        fieldOffsets.insert(fieldOffsets.end(), chunk.offsets.begin(), chunk.offsets.end());
+
+        for(auto&& it : chunk.fieldIndex)
+            rowFieldIndex.push_back(it + fieldIndexOffset);
+
+        // Release the memory of the chunk as soon as it is copied
+        std::vector<qint64>().swap(chunk.starts);
+        std::vector<qint64>().swap(chunk.ends);
+        std::vector<qint64>().swap(chunk.fieldIndex);
+        std::vector<quint32>().swap(chunk.offsets);
+    }
+}
+
+
+int MappedCSVFile::numRows(void) const
+{
+    return static_cast<int>(nRows);
+}
+
+
+int MappedCSVFile::numFields(const int row) const
+{
+    return static_cast<int>(rowFieldIndexData[row+1] - rowFieldIndexData[row]);
+}
+
+
+CSVRow MappedCSVFile::row(const int row) const
+{
+    return CSVRow(fileData, rowStartsData[row], rowEndsData[row], fieldOffsetsData + rowFieldIndexData[row], this->numFields(row));
+}
+
+
+QString MappedCSVFile::field(const int row, const int col) const
+{
+    return this->row(row).at(col);
+}
+
+
+QStringList MappedCSVFile::rowStrings(const int row) const
+{
+    return this->row(row).toStringList();
+}
+
+
+const char* MappedCSVFile::data(void) const
+{
+    return fileData;
+}
+
+
+qint64 MappedCSVFile::size(void) const
+{
+    return fileSize;
+}
+
+
+QString MappedCSVFile::getPathToFile(void) const
+{
+    return file.fileName();
+}
@@ -0,0 +1,132 @@
+#ifndef MAPPEDCSVFILE_H
+#define MAPPEDCSVFILE_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "CSVIndexCache.h"
+#include "CSVTokenizer.h"
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+
+#include <vector>
+
+// Memory-maps a CSV file and indexes the positions of its rows and fields without creating any strings
+// The fields are only converted into QStrings when a caller asks for them
+// Gzip compressed files are inflated into memory instead of being mapped
+class MappedCSVFile
+{
+public:
+    MappedCSVFile();
+    ~MappedCSVFile();
+
+    // Maps and indexes the file, returns 0 on success
+    // If useCache is true, the index of a large file is loaded from the index cache when the cache is up to date, otherwise the index is saved to the cache for the next time the file is opened
+    int open(const QString& pathToFile, QString& err, const bool useCache = false);
+
+    void close(void);
+
+    bool isOpen(void) const;
+
+    int numRows(void) const;
+
+    // Number of fields in the given row
+    int numFields(const int row) const;
+
+    // View of the given row, valid as long as the file is open
+    CSVRow row(const int row) const;
+
+    // Returns the value of the field as a string, the string is created when this function is called
+    QString field(const int row, const int col) const;
+
+    // Returns all of the fields in the row as a string list
+    QStringList rowStrings(const int row) const;
+
+    // The raw bytes of the file
+    const char* data(void) const;
+    qint64 size(void) const;
+
+    QString getPathToFile(void) const;
+
+private:
+
+    Q_DISABLE_COPY(MappedCSVFile)
+
+    // Files larger than two chunks are indexed in parallel, one chunk per thread
+    static const qint64 minChunkSize = 16*1024*1024;
+
+    void index(void);
+
+    // Tokenizes the rows from chunkStart up to chunkEnd and appends them to the given index
+    void indexChunk(const qint64 chunkStart, const qint64 chunkEnd, const bool atEnd, std::vector<qint64>& starts, std::vector<qint64>& ends, std::vector<qint64>& fieldIndex, std::vector<quint32>& offsets) const;
+
+    // Splits the file into byte ranges on row boundaries that respect quoted sections and tokenizes them on the thread pool
+    void indexParallel(const int numChunks);
+
+    QFile file;
+
+    // Used when the file cannot be mapped into memory, e.g., on some network drives
+    QByteArray fileBuffer;
+
+    const char* fileData;
+    qint64 fileSize;
+
+    // Start and end (position of the terminating newline) of each row in the file
+    std::vector<qint64> rowStarts;
+    std::vector<qint64> rowEnds;
+
+    // Index of the first field of each row in the field offsets vector, has one more entry than the number of rows
+    std::vector<qint64> rowFieldIndex;
+
+    // Offset of each field relative to the start of its row
+    std::vector<quint32> fieldOffsets;
+
+    // Used instead of the vectors above when the index is loaded from the cache
+    CSVIndexCache indexCache;
+
+    // The index in use, points either into the vectors or into the cache
+    qint64 nRows;
+    const qint64* rowStartsData;
+    const qint64* rowEndsData;
+    const qint64* rowFieldIndexData;
+    const quint32* fieldOffsetsData;
+};
+
+#endif // MAPPEDCSVFILE_H
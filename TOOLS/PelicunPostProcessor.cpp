@@ -37,6 +37,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 // Written by: Stevan Gavrilovic
 
 #include "CSVReaderWriter.h"
+#include "CSVTokenizer.h"
 #include "ComponentInputWidget.h"
 #include "GeneralInformationWidget.h"
 #include "MainWindowWorkflowApp.h"
@@ -83,6 +84,8 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "Map.h"
 #include "MapGraphicsView.h"
 
+#include <algorithm>
+
 using namespace QtCharts;
 
 PelicunPostProcessor::PelicunPostProcessor(QWidget *parent, VisualizationWidget* visWidget) : QMainWindow(parent), theVisualizationWidget(visWidget)
@@ -292,97 +295,159 @@ void PelicunPostProcessor::importResults(const QString& pathToResults)
             EDPreultsSheet = it;
     }
 
-    CSVReaderWriter csvTool;
-
-    DMdata = csvTool.parseCSVFile(pathToResults + QDir::separator() + DMResultsSheet,errMsg);
-    if(!errMsg.isEmpty())
-        throw errMsg;
-
-    DVdata = csvTool.parseCSVFile(pathToResults + QDir::separator() + DVResultsSheet,errMsg);
-    if(!errMsg.isEmpty())
-        throw errMsg;
-
-    EDPdata = csvTool.parseCSVFile(pathToResults + QDir::separator() + EDPreultsSheet,errMsg);
-    if(!errMsg.isEmpty())
-        throw errMsg;
-
-    if(!DVdata.empty())
-        this->processDVResults(DVdata);
-    else
+    // The damage and EDP results are not processed here, only check that they exist
+    for(auto&& it : {DMResultsSheet, EDPreultsSheet, DVResultsSheet})
     {
-        errMsg = "The DV results are empty";
-        throw errMsg;
+        if(it.isEmpty() || !QFileInfo::exists(pathToResults + QDir::separator() + it))
+        {
+            errMsg = "Cannot find the file: " + pathToResults + QDir::separator() + it + "\nCheck your directory and try again.";
+            throw errMsg;
+        }
     }
 
+    pathToDVResults = pathToResults + QDir::separator() + DVResultsSheet;
+
+    this->processDVResults(pathToDVResults);
 }
 
 
-int PelicunPostProcessor::processDVResults(const QVector<QStringList>& DVResults)
+int PelicunPostProcessor::processDVResults(const QString& pathToDVFile)
 {
-    if(DVResults.size() < numHeaderRows)
-    {
-        QString msg = "No results to import!";
-        throw msg;
-    }
+    auto theBuildingDB = this->getBuildingDatabase();
+
+    // Results from a previous import are overwritten
+    theBuildingDB->clearResults();
+
+    resultHeadings.clear();
+    resultIndexes.clear();
+    rowsWithResults.assign(static_cast<size_t>(theBuildingDB->getNumberOfComponents()), false);
+
+    int numHeaderColumns = 0;
 
-    auto numHeaderColumns = DVResults.at(0).size();
+    // The header rows are kept until the header strings can be assembled
+    QVector<QStringList> headerRows;
 
-    QStringList headerStrings;
+    // The rows of the buildings in the order of the results file
+    QVector<int> resultRows;
 
-    for(int i = 0; i<numHeaderColumns; ++i)
+    auto rowVisitor = [&](const CSVRow& csvRow, const int rowNumber)
     {
-        QString headerStr = DVResults.at(0).at(i) +"-"+ DVResults.at(1).at(i) +"-"+ DVResults.at(2).at(i) +"-"+ DVResults.at(3).at(i);
+        // 4 rows of headers in the results file
+        if(rowNumber < numHeaderRows)
+        {
+            headerRows.push_back(csvRow.toStringList());
 
-        headerStrings.append(headerStr);
-    }
+            if(rowNumber == numHeaderRows-1)
+            {
+                numHeaderColumns = headerRows.at(0).size();
+
+                for(int i = 0; i<numHeaderColumns; ++i)
+                {
+                    QString headerStr = headerRows.at(0).value(i) +"-"+ headerRows.at(1).value(i) +"-"+ headerRows.at(2).value(i) +"-"+ headerRows.at(3).value(i);
 
+                    resultHeadings.append(headerStr);
+                }
 
-    auto indexRCagg = headerStrings.indexOf("Repair Cost-aggregate--mean");
-    auto indexRepairImpracProb = headerStrings.indexOf("Repair Impractical-probability--");
+                if(!resultHeadings.contains("Repair Cost-aggregate--mean") || !resultHeadings.contains("Repair Impractical-probability--"))
+                {
+                    QString msg = "Could not find the required header keys in the Pelicun DV results file.";
+                    throw msg;
+                }
+
+                // Every column except the ID is stored as a result of the buildings
+                resultIndexes.fill(-1, numHeaderColumns);
+                for(int j = 1; j<numHeaderColumns; ++j)
+                    resultIndexes[j] = theBuildingDB->addResult(resultHeadings.at(j));
+            }
+
+            return true;
+        }
 
-    if(indexRCagg == -1 || indexRepairImpracProb==-1)
+        auto buildingID = objectToInt(csvRow.at(0));
+
+        // Buildings that were never drawn have no feature, they only have to exist in the database
+        auto row = theBuildingDB->getRow(buildingID);
+
+        if(row == -1)
+            throw QString("Could not find the building ID " + QString::number(buildingID) + " in the database");
+
+        for(int j = 1; j<numHeaderColumns && j<csvRow.size(); ++j)
+            theBuildingDB->setResultValue(row, resultIndexes.at(j), csvRow.at(j).toDouble());
+
+        rowsWithResults[static_cast<size_t>(row)] = true;
+        resultRows.push_back(row);
+
+        return true;
+    };
+
+    // Stream the results straight into the building database so that only one row is held in memory at a time
+    CSVReaderWriter csvTool;
+
+    QString errMsg;
+    csvTool.parseCSVFile(pathToDVFile, rowVisitor, errMsg);
+
+    if(!errMsg.isEmpty())
+        throw errMsg;
+
+    if(headerRows.size() < numHeaderRows)
     {
-        QString msg = "Could not find the required header keys in the Pelicun DV results file.";
+        QString msg = "No results to import!";
         throw msg;
     }
 
+    this->processResults(resultRows);
+
+    return resultRows.size();
+}
+
+
+void PelicunPostProcessor::processResults(const QVector<int>& rows)
+{
+    auto theBuildingDB = this->getBuildingDatabase();
+
     // Decipher the results file
+    auto resultColumn = [&](const QString& heading)
+    {
+        return resultHeadings.indexOf(heading);
+    };
+
+    auto indexRCagg = resultColumn("Repair Cost-aggregate--mean");
+    auto indexRepairImpracProb = resultColumn("Repair Impractical-probability--");
 
     // Structural - seismic
-    auto indexSRCagg = headerStrings.indexOf("Repair Cost-S-aggregate-mean");
-    auto indexNSRCagg = headerStrings.indexOf("Repair Cost-NS-aggregate-mean");
+    auto indexSRCagg = resultColumn("Repair Cost-S-aggregate-mean");
+    auto indexNSRCagg = resultColumn("Repair Cost-NS-aggregate-mean");
 
-    auto indexSRC1_1 = headerStrings.indexOf("Repair Cost-S-1_1-mean");
+    auto indexSRC1_1 = resultColumn("Repair Cost-S-1_1-mean");
 
     // Non-structural - seismic
-    // auto indexNSRC1_1 = headerStrings.indexOf("Repair Cost-NS-1_1-mean");
+    // auto indexNSRC1_1 = resultColumn("Repair Cost-NS-1_1-mean");
 
     // Non-structural - acceleration sensitive - seismic
-    auto indexNSARC1_1 = headerStrings.indexOf("Repair Cost-NSA-1_1-mean");
+    auto indexNSARC1_1 = resultColumn("Repair Cost-NSA-1_1-mean");
 
     // Non-structural - drift sensitive - seismic
-    auto indexNSDRC1_1 = headerStrings.indexOf("Repair Cost-NSD-1_1-mean");
+    auto indexNSDRC1_1 = resultColumn("Repair Cost-NSD-1_1-mean");
 
     // Repair times
-    auto indexRepairTime = headerStrings.indexOf("Repair Time--aggregate-mean");
+    auto indexRepairTime = resultColumn("Repair Time--aggregate-mean");
 
     // Injuries
-    auto indexInjuriesSev1 = headerStrings.indexOf("Injuries-sev1-aggregate-mean");
+    auto indexInjuriesSev1 = resultColumn("Injuries-sev1-aggregate-mean");
 
     // Wind repair cost
-    auto indexWindRCagg = headerStrings.indexOf("Repair Cost-Wind-aggregate");
-    auto indexWindRC1_1 = headerStrings.indexOf("Repair Cost-Wind-1_1-mean");
+    // auto indexWindRCagg = resultColumn("Repair Cost-Wind-aggregate");
+    // auto indexWindRC1_1 = resultColumn("Repair Cost-Wind-1_1-mean");
 
     // Flood repair cost
-    auto indexFloodRCagg = headerStrings.indexOf("Repair Cost-Flood-aggregate");
-    auto indexFloodRC1_1 = headerStrings.indexOf("Repair Cost-Flood-1_1-mean");
-
+    // auto indexFloodRCagg = resultColumn("Repair Cost-Flood-aggregate");
+    // auto indexFloodRC1_1 = resultColumn("Repair Cost-Flood-1_1-mean");
 
     QStringList tableHeadings = {"Asset ID","Repair\nCost","Repair\nTime","Replacement\nProbability","Fatalities","Loss\nRatio"};
 
     pelicunResultsTableWidget->setColumnCount(tableHeadings.size());
     pelicunResultsTableWidget->setHorizontalHeaderLabels(tableHeadings);
-    pelicunResultsTableWidget->setRowCount(DVResults.size()-numHeaderRows);
+    pelicunResultsTableWidget->setRowCount(rows.size());
 
     auto cumulativeSagg = 0.0;
     auto cumulativeNSagg = 0.0;
@@ -412,53 +477,34 @@ int PelicunPostProcessor::processDVResults(const QVector<QStringList>& DVResults
 
     REmpiricalProbabilityDistribution theProbDist;
 
-    auto buildingsWidget = theVisualizationWidget->getComponentWidget("BUILDINGS");
+    // The loss ratios are written to the buildings in one batch once all of the results are read
+    QVector<qint64> lossRatioIDs;
+    QVector<QVariant> lossRatioValues;
 
-    if(buildingsWidget == nullptr)
-    {
-        QString msg = "Error getting the building buildings widget from the visualization widget";
-        throw msg;
-    }
+    int count = 0;
 
-    // Get the buildings database
-    auto theBuildingDB = buildingsWidget->getComponentDatabase();
-
-    if(theBuildingDB == nullptr)
-    {
-        QString msg = "Error getting the building database from the input widget!";
-        throw msg;
-    }
-
-    // 4 rows of headers in the results file
-    for(int i = numHeaderRows, count = 0; i<DVResults.size(); ++i, ++count)
+    for(auto&& row : rows)
     {
-        auto inputRow = DVResults.at(i);
+        auto building = theBuildingDB->getComponent(theBuildingDB->getID(row));
 
-        auto buildingID = objectToInt(inputRow.at(0));
-
-        auto building = theBuildingDB->getComponent(buildingID);
-
-        if(building.ID == -1)
-            throw QString("Could not find the building ID " + QString::number(buildingID) + " in the database");
-
-        for(int j = 1; j<numHeaderColumns; ++j)
+        // The results of the building, by the column of the results file
+        auto value = [&](const int column)
         {
-            building.ResultsValues.insert(headerStrings.at(j),inputRow.at(j).toDouble());
-        }
+            if(column < 1 || column >= resultIndexes.size())
+                throw QString("The column " + QString::number(column) + " is not in the Pelicun DV results file");
+
+            return theBuildingDB->getResultValue(row, resultIndexes.at(column));
+        };
 
         // Defaults to 1.0 if no replacement cost is given, i.e., it assumes the repair cost is the loss ratio
-        auto replacementCostVar = building.ComponentAttributes.value("ReplacementCost",QVariant(1.0));
+        auto replacementCostVar = building.getAttributeValue("ReplacementCost",QVariant(1.0));
 
         auto replacementCost = objectToDouble(replacementCostVar);
 
-        building.ID = buildingID;
-
-        buildingsVec.push_back(building);
-
         // This assumes that the output from pelicun will not change
-        auto IDStr = inputRow.at(0);                                // ID
-        auto totalRepairCost = inputRow.at(indexRCagg);             // Aggregate repair cost (mean)
-        auto replaceMentProb = inputRow.at(indexRepairImpracProb);  // Replacement probability, i.e., repair impractical probability
+        auto buildingID = building.getID();                         // ID
+        auto repairCost = value(indexRCagg);                        // Aggregate repair cost (mean)
+        auto replaceMentProb = value(indexRepairImpracProb);        // Replacement probability, i.e., repair impractical probability
 
         auto repairTime = 0.0;
 
@@ -469,17 +515,17 @@ int PelicunPostProcessor::processDVResults(const QVector<QStringList>& DVResults
 
         // Aggregate repair time (mean)
         if(indexRepairTime != -1)
-            repairTime = objectToDouble(inputRow.at(indexRepairTime));
+            repairTime = value(indexRepairTime);
 
         cumulativeRepairTime += repairTime;
 
         if(indexSRC1_1 != -1)
         {
-            auto StructDS1 = objectToDouble(inputRow.at(indexSRC1_1));    // Structural losses damage state 1 (mean)
-            auto StructDS2 = objectToDouble(inputRow.at(indexSRC1_1+1));  // Structural losses damage state 2 (mean)
-            auto StructDS3 = objectToDouble(inputRow.at(indexSRC1_1+2));  // Structural losses damage state 3 (mean)
-            auto StructDS4 = objectToDouble(inputRow.at(indexSRC1_1+3));  // Structural losses damage state 4 (mean)
-            StructDS4 += objectToDouble(inputRow.at(indexSRC1_1+4));      // Structural losses damage state 4_2 (mean)
+            auto StructDS1 = value(indexSRC1_1);    // Structural losses damage state 1 (mean)
+            auto StructDS2 = value(indexSRC1_1+1);  // Structural losses damage state 2 (mean)
+            auto StructDS3 = value(indexSRC1_1+2);  // Structural losses damage state 3 (mean)
+            auto StructDS4 = value(indexSRC1_1+3);  // Structural losses damage state 4 (mean)
+            StructDS4 += value(indexSRC1_1+4);      // Structural losses damage state 4_2 (mean)
 
             cumulativeStructDS1 += StructDS1;
             cumulativeStructDS2 += StructDS2;
@@ -490,10 +536,10 @@ int PelicunPostProcessor::processDVResults(const QVector<QStringList>& DVResults
 
         if(indexNSARC1_1 != -1)
         {
-            auto NSAccDS1 = objectToDouble(inputRow.at(indexNSARC1_1));    // Non-structural acceleration sensitive losses damage state 1 (mean)
-            auto NSAccDS2 = objectToDouble(inputRow.at(indexNSARC1_1+1));  // Non-structural acceleration sensitive losses damage state 2 (mean)
-            auto NSAccDS3 = objectToDouble(inputRow.at(indexNSARC1_1+2));  // Non-structural acceleration sensitive losses damage state 3 (mean)
-            auto NSAccDS4 = objectToDouble(inputRow.at(indexNSARC1_1+3));  // Non-structural acceleration sensitive losses damage state 4 (mean)
+            auto NSAccDS1 = value(indexNSARC1_1);    // Non-structural acceleration sensitive losses damage state 1 (mean)
+            auto NSAccDS2 = value(indexNSARC1_1+1);  // Non-structural acceleration sensitive losses damage state 2 (mean)
+            auto NSAccDS3 = value(indexNSARC1_1+2);  // Non-structural acceleration sensitive losses damage state 3 (mean)
+            auto NSAccDS4 = value(indexNSARC1_1+3);  // Non-structural acceleration sensitive losses damage state 4 (mean)
 
             cumulativeNSAccDS1 += NSAccDS1;
             cumulativeNSAccDS2 += NSAccDS2;
@@ -504,10 +550,10 @@ int PelicunPostProcessor::processDVResults(const QVector<QStringList>& DVResults
 
         if(indexNSDRC1_1 != -1)
         {
-            auto NSDriftDS1 = objectToDouble(inputRow.at(24));  // Non-structural drift sensitive losses damage state 1 (mean)
-            auto NSDriftDS2 = objectToDouble(inputRow.at(25));  // Non-structural drift sensitive losses damage state 2 (mean)
-            auto NSDriftDS3 = objectToDouble(inputRow.at(26));  // Non-structural drift sensitive losses damage state 3 (mean)
-            auto NSDriftDS4 = objectToDouble(inputRow.at(27));  // Non-structural drift sensitive losses damage state 4 (mean)
+            auto NSDriftDS1 = value(24);  // Non-structural drift sensitive losses damage state 1 (mean)
+            auto NSDriftDS2 = value(25);  // Non-structural drift sensitive losses damage state 2 (mean)
+            auto NSDriftDS3 = value(26);  // Non-structural drift sensitive losses damage state 3 (mean)
+            auto NSDriftDS4 = value(27);  // Non-structural drift sensitive losses damage state 4 (mean)
 
             cumulativeNSDriftDS1 += NSDriftDS1;
             cumulativeNSDriftDS2 += NSDriftDS2;
@@ -518,10 +564,10 @@ int PelicunPostProcessor::processDVResults(const QVector<QStringList>& DVResults
 
         if(indexInjuriesSev1 != -1)
         {
-            injSevLvl1 = objectToDouble(inputRow.at(indexInjuriesSev1));    // Injuries severity level 1 (mean)
-            injSevLvl2 = objectToDouble(inputRow.at(indexInjuriesSev1+1));  // Injuries severity level 2 (mean)
-            injSevLvl3 = objectToDouble(inputRow.at(indexInjuriesSev1+2));  // Injuries severity level 3 (mean)
-            fatalities = objectToDouble(inputRow.at(indexInjuriesSev1+3));  // Injuries severity level 4 (mean)
+            injSevLvl1 = value(indexInjuriesSev1);    // Injuries severity level 1 (mean)
+            injSevLvl2 = value(indexInjuriesSev1+1);  // Injuries severity level 2 (mean)
+            injSevLvl3 = value(indexInjuriesSev1+2);  // Injuries severity level 3 (mean)
+            fatalities = value(indexInjuriesSev1+3);  // Injuries severity level 4 (mean)
 
             cumulativeinjSevLvl1 += injSevLvl1;
             cumulativeinjSevLvl2 += injSevLvl2;
@@ -530,21 +576,20 @@ int PelicunPostProcessor::processDVResults(const QVector<QStringList>& DVResults
         }
 
         if(indexSRCagg != -1)
-            cumulativeSagg += objectToDouble(inputRow.at(indexSRCagg));
+            cumulativeSagg += value(indexSRCagg);
 
         if(indexNSRCagg != -1)
-            cumulativeNSagg += objectToDouble(inputRow.at(indexNSRCagg));
+            cumulativeNSagg += value(indexNSRCagg);
 
-        auto repairCost = objectToDouble(totalRepairCost);
         auto lossRatio = repairCost/replacementCost;
 
         cumulativeRepairCost += repairCost;
 
         theProbDist.addSample(repairCost);
 
-        auto IDItem = new TableNumberItem(IDStr);
-        auto RepCostItem = new TableNumberItem(totalRepairCost);
-        auto RepProbItem = new TableNumberItem(replaceMentProb);
+        auto IDItem = new TableNumberItem(QString::number(buildingID));
+        auto RepCostItem = new TableNumberItem(QString::number(repairCost));
+        auto RepProbItem = new TableNumberItem(QString::number(replaceMentProb));
         auto RepairTimeItem = new TableNumberItem(QString::number(repairTime));
         auto fatalitiesItem = new TableNumberItem(QString::number(fatalities));
         auto lossRatioItem = new TableNumberItem(QString::number(lossRatio));
@@ -556,19 +601,27 @@ int PelicunPostProcessor::processDVResults(const QVector<QStringList>& DVResults
         pelicunResultsTableWidget->setItem(count,4, fatalitiesItem);
         pelicunResultsTableWidget->setItem(count,5, lossRatioItem);
 
-        auto buildingFeature = building.ComponentFeature;
-
         auto atrb = "LossRatio";
         auto atrbVal = QVariant(lossRatio);
 
-        buildingFeature->attributes()->replaceAttribute("LossRatio",lossRatio);
-        buildingFeature->featureTable()->updateFeature(buildingFeature);
+        lossRatioIDs.push_back(buildingID);
+        lossRatioValues.push_back(atrbVal);
 
         // Get the feature UID
-        auto uid = building.UID;
+        auto uid = building.getUID();
         theVisualizationWidget->updateSelectedComponent("BUILDINGS",uid,atrb,atrbVal);
+
+        ++count;
     }
 
+    QString errMsg;
+    if(theBuildingDB->updateAttributes(lossRatioIDs, "LossRatio", lossRatioValues, errMsg) != 0)
+        throw errMsg;
+
+    // Large inventories are binned into hexagons when zoomed out, the hexagons are colored by the mean loss ratio once there are results
+    if(theVisualizationWidget->getComponentWidget("BUILDINGS")->updateAggregationLayer("MeanLossRatio", errMsg) != 0)
+        throw errMsg;
+
     //  CASUALTIES
     QBarSet *casualtiesSet = new QBarSet("Casualties");
 
@@ -609,8 +662,29 @@ int PelicunPostProcessor::processDVResults(const QVector<QStringList>& DVResults
     chartsDock1->setWidget(casualtiesChartView);
     chartsDock2->setWidget(lossesChartView);
     chartsDock3->setWidget(lossesRFDiagram);
+}
 
-    return 0;
+
+ComponentDatabase* PelicunPostProcessor::getBuildingDatabase(void)
+{
+    auto buildingsWidget = theVisualizationWidget->getComponentWidget("BUILDINGS");
+
+    if(buildingsWidget == nullptr)
+    {
+        QString msg = "Error getting the building buildings widget from the visualization widget";
+        throw msg;
+    }
+
+    // Get the buildings database
+    auto theBuildingDB = buildingsWidget->getComponentDatabase();
+
+    if(theBuildingDB == nullptr)
+    {
+        QString msg = "Error getting the building database from the input widget!";
+        throw msg;
+    }
+
+    return theBuildingDB;
 }
 
 
@@ -792,62 +866,42 @@ int PelicunPostProcessor::printToPDF(const QString& outputPath)
 }
 
 
-void PelicunPostProcessor::processResultsSubset(const std::set<int>& selectedComponentIDs)
+void PelicunPostProcessor::processResultsSubset(const ComponentSelection& selectedComponentIDs)
 {
 
-    if(selectedComponentIDs.empty())
+    if(selectedComponentIDs.isEmpty())
         return;
 
-    if(DVdata.size() < numHeaderRows)
+    if(resultIndexes.isEmpty())
     {
         QString msg = "No results to import!";
         throw msg;
     }
 
-    if(DVdata.at(numHeaderRows).isEmpty() || DVdata.last().isEmpty())
-    {
-        QString msg = "No values in the cells";
-        throw msg;
-    }
+    auto theBuildingDB = this->getBuildingDatabase();
 
-    auto firstID = objectToInt(DVdata.at(numHeaderRows).at(0));
+    // The results of every building are already in the building database, only look up the rows of the selected IDs
+    QVector<int> rows;
+    rows.reserve(static_cast<int>(std::min(selectedComponentIDs.size(), static_cast<qint64>(rowsWithResults.size()))));
 
-    auto lastID = objectToInt(DVdata.last().at(0));
-
-    QVector<QStringList> DVsubset(&DVdata[0],&DVdata[numHeaderRows]);
-
-    for(auto&& id : selectedComponentIDs)
+    qint64 numMissing = 0;
+    for(auto&& ID : selectedComponentIDs)
     {
-        // Check that the ID falls within the bounds of the data
-        if(id<firstID || id>lastID)
-        {
-            QString msg = "ID " + QString::number(id) + " is out of bounds of the results";
-            throw msg;
-        }
+        auto row = theBuildingDB->getRow(ID);
 
-        auto found = false;
-        for(int i = numHeaderRows; i<DVdata.size(); ++i)
-        {
-            auto inputRow = DVdata.at(i);
+        if(row == -1 || static_cast<size_t>(row) >= rowsWithResults.size() || !rowsWithResults[static_cast<size_t>(row)])
+            ++numMissing;
+        else
+            rows.push_back(row);
+    }
 
-            auto buildingID = objectToInt(inputRow.at(0));
+    this->processResults(rows);
 
-            if(id == buildingID)
-            {
-                DVsubset << inputRow;
-                found = true;
-                break;
-            }
-        }
-
-        if(!found)
-        {
-            QString msg = "ID " + QString::number(id) + " cannot be found in the results";
-            throw msg;
-        }
+    if(numMissing != 0)
+    {
+        QString msg = QString::number(numMissing) + " of the selected IDs cannot be found in the results";
+        throw msg;
     }
-
-    this->processDVResults(DVsubset);
 }
 
 
@@ -1184,10 +1238,10 @@ void PelicunPostProcessor::setCurrentlyViewable(bool status){
 
 void PelicunPostProcessor::clear(void)
 {
-    DMdata.clear();
-    DVdata.clear();
-    EDPdata.clear();
-    buildingsVec.clear();
+    pathToDVResults.clear();
+    resultHeadings.clear();
+    resultIndexes.clear();
+    rowsWithResults.clear();
 
     outputFilePath.clear();
 
@@ -39,13 +39,16 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 // Written by: Stevan Gavrilovic
 
 #include "ComponentDatabase.h"
+#include "ComponentSelection.h"
 #include "EmbeddedMapViewWidget.h"
 
 #include <QString>
+#include <QStringList>
 #include <QMainWindow>
+#include <QVector>
 
 #include <memory>
-#include <set>
+#include <vector>
 
 class REmpiricalProbabilityDistribution;
 class EmbeddedMapViewWidget;
@@ -105,15 +108,16 @@ public:
     }
 
 
+    // Converts to a 64-bit integer so that it holds any asset ID
     template <typename T>
     auto objectToInt(T obj)
     {
         // Assume a zero value if the string is empty
         if(obj.isNull())
-            return 0;
+            return static_cast<qint64>(0);
 
         bool OK;
-        auto val = obj.toInt(&OK);
+        auto val = obj.toLongLong(&OK);
 
         if(!OK)
             throw QString("Could not convert the object to an integer");
@@ -121,7 +125,7 @@ public:
         return val;
     }
 
-    void processResultsSubset(const std::set<int>& selectedComponentIDs);
+    void processResultsSubset(const ComponentSelection& selectedComponentIDs);
 
     void setCurrentlyViewable(bool status);
 
@@ -139,11 +143,24 @@ private slots:
 
 private:
 
-    int processDVResults(const QVector<QStringList>& DVResults);
+    // Streams the DV results file into the results of the building database and processes all of the buildings in it
+    // Returns the number of buildings that were processed
+    int processDVResults(const QString& pathToDVFile);
 
-    QVector<QStringList> DMdata;
-    QVector<QStringList> DVdata;
-    QVector<QStringList> EDPdata;
+    // Fills the table, the totals, and the charts from the results of the given rows of the building database
+    void processResults(const QVector<int>& rows);
+
+    ComponentDatabase* getBuildingDatabase(void);
+
+    QString pathToDVResults;
+
+    // Headings of the columns of the DV results file, and the index of each column in the results of the building database
+    // A subset of the buildings is processed from the results in the database without reading the file again
+    QStringList resultHeadings;
+    QVector<int> resultIndexes;
+
+    // Flags of the rows of the building database that have results
+    std::vector<bool> rowsWithResults;
 
     QString outputFilePath;
 
@@ -191,8 +208,6 @@ private:
 
     int createCasualtiesChart(QtCharts::QBarSet *casualtiesSet);
 
-    QVector<Component> buildingsVec;
-
     QByteArray uiState;
 
     // The number of header rows in the Pelicun results file
@@ -0,0 +1,221 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "RTree.h"
+
+#include <algorithm>
+#include <cmath>
+
+double RTreeEnvelope::squaredDistance(const double x, const double y) const
+{
+    auto dx = std::max(std::max(xMin - x, 0.0), x - xMax);
+    auto dy = std::max(std::max(yMin - y, 0.0), y - yMax);
+
+    return dx*dx + dy*dy;
+}
+
+
+void RTreeEnvelope::expand(const RTreeEnvelope& other)
+{
+    xMin = std::min(xMin, other.xMin);
+    yMin = std::min(yMin, other.yMin);
+    xMax = std::max(xMax, other.xMax);
+    yMax = std::max(yMax, other.yMax);
+}
+
+
+RTree::RTree() : numLeaves(0)
+{
+
+}
+
+
+void RTree::build(const std::vector<RTreeEnvelope>& envelopes)
+{
+    this->clear();
+
+    if(envelopes.empty())
+        return;
+
+    std::vector<int> order;
+    std::vector<RTreeEnvelope> parentEnvelopes;
+    std::vector<int> firstChild;
+    std::vector<int> numChildren;
+
+    // Pack the items into the leaves
+    packLevel(envelopes, order, parentEnvelopes, firstChild, numChildren);
+
+    itemEnvelopes.resize(envelopes.size());
+    itemIDs = order;
+
+    for(size_t i = 0; i<order.size(); ++i)
+        itemEnvelopes[i] = envelopes[order[i]];
+
+    nodeEnvelopes = parentEnvelopes;
+    nodeFirstChild = firstChild;
+    nodeNumChildren = numChildren;
+
+    numLeaves = static_cast<int>(nodeEnvelopes.size());
+
+    // Pack the nodes of each level into the level above until there is only the root left
+    size_t levelStart = 0;
+
+    while(nodeEnvelopes.size() - levelStart > 1)
+    {
+        const size_t levelEnd = nodeEnvelopes.size();
+
+        std::vector<RTreeEnvelope> levelEnvelopes(nodeEnvelopes.begin() + levelStart, nodeEnvelopes.end());
+
+        packLevel(levelEnvelopes, order, parentEnvelopes, firstChild, numChildren);
+
+        // Reorder the nodes of this level so that the children of each parent are contiguous
+        std::vector<int> levelFirstChild(nodeFirstChild.begin() + levelStart, nodeFirstChild.end());
+        std::vector<int> levelNumChildren(nodeNumChildren.begin() + levelStart, nodeNumChildren.end());
+
+        for(size_t i = 0; i<order.size(); ++i)
+        {
+            nodeEnvelopes[levelStart + i] = levelEnvelopes[order[i]];
+            nodeFirstChild[levelStart + i] = levelFirstChild[order[i]];
+            nodeNumChildren[levelStart + i] = levelNumChildren[order[i]];
+        }
+
+        for(size_t i = 0; i<parentEnvelopes.size(); ++i)
+        {
+            nodeEnvelopes.push_back(parentEnvelopes[i]);
+            nodeFirstChild.push_back(static_cast<int>(levelStart) + firstChild[i]);
+            nodeNumChildren.push_back(numChildren[i]);
+        }
+
+        levelStart = levelEnd;
+    }
+}
+
+
+void RTree::clear(void)
+{
+    itemEnvelopes.clear();
+    itemIDs.clear();
+    nodeEnvelopes.clear();
+    nodeFirstChild.clear();
+    nodeNumChildren.clear();
+
+    numLeaves = 0;
+}
+
+
+bool RTree::isEmpty(void) const
+{
+    return itemIDs.empty();
+}
+
+
+int RTree::size(void) const
+{
+    return static_cast<int>(itemIDs.size());
+}
+
+
+void RTree::search(const RTreeEnvelope& searchEnvelope, std::vector<int>& items) const
+{
+    this->visit(searchEnvelope, [&](const int item, const RTreeEnvelope&)
+    {
+        items.push_back(item);
+        return true;
+    });
+}
+
+
+void RTree::searchRadius(const double x, const double y, const double radius, std::vector<int>& items) const
+{
+    RTreeEnvelope searchEnvelope{x - radius, y - radius, x + radius, y + radius};
+
+    const double squaredRadius = radius*radius;
+
+    this->visit(searchEnvelope, [&](const int item, const RTreeEnvelope& envelope)
+    {
+        if(envelope.squaredDistance(x, y) <= squaredRadius)
+            items.push_back(item);
+
+        return true;
+    });
+}
+
+
+void RTree::packLevel(const std::vector<RTreeEnvelope>& envelopes, std::vector<int>& order, std::vector<RTreeEnvelope>& parentEnvelopes, std::vector<int>& firstChild, std::vector<int>& numChildren)
+{
+    const int numEnvelopes = static_cast<int>(envelopes.size());
+
+    order.resize(numEnvelopes);
+    for(int i = 0; i<numEnvelopes; ++i)
+        order[i] = i;
+
+    parentEnvelopes.clear();
+    firstChild.clear();
+    numChildren.clear();
+
+    auto centerX = [&](const int i) { return envelopes[i].xMin + envelopes[i].xMax; };
+    auto centerY = [&](const int i) { return envelopes[i].yMin + envelopes[i].yMax; };
+
+    // Split the envelopes into vertical slices of sqrt(number of parents) parents each, sorted by x
+    const int numParents = (numEnvelopes + nodeCapacity - 1)/nodeCapacity;
+    const int numSlices = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(numParents))));
+    const int sliceSize = numSlices*nodeCapacity;
+
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return centerX(a) < centerX(b); });
+
+    for(int sliceStart = 0; sliceStart < numEnvelopes; sliceStart += sliceSize)
+    {
+        const int sliceEnd = std::min(sliceStart + sliceSize, numEnvelopes);
+
+        // Within a slice, sort by y and take the parents in runs of nodeCapacity
+        std::sort(order.begin() + sliceStart, order.begin() + sliceEnd, [&](int a, int b) { return centerY(a) < centerY(b); });
+
+        for(int start = sliceStart; start < sliceEnd; start += nodeCapacity)
+        {
+            const int end = std::min(start + nodeCapacity, sliceEnd);
+
+            auto envelope = envelopes[order[start]];
+            for(int i = start + 1; i<end; ++i)
+                envelope.expand(envelopes[order[i]]);
+
+            parentEnvelopes.push_back(envelope);
+            firstChild.push_back(start);
+            numChildren.push_back(end - start);
+        }
+    }
+}
@@ -0,0 +1,225 @@
+#ifndef RTREE_H
+#define RTREE_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+// Axis aligned bounding box of a geometry
+struct RTreeEnvelope
+{
+    double xMin;
+    double yMin;
+    double xMax;
+    double yMax;
+
+    bool intersects(const RTreeEnvelope& other) const
+    {
+        return xMin <= other.xMax && other.xMin <= xMax && yMin <= other.yMax && other.yMin <= yMax;
+    }
+
+    bool contains(const RTreeEnvelope& other) const
+    {
+        return xMin <= other.xMin && other.xMax <= xMax && yMin <= other.yMin && other.yMax <= yMax;
+    }
+
+    // Squared distance from the point to the closest point of the envelope, zero if the point is inside
+    double squaredDistance(const double x, const double y) const;
+
+    void expand(const RTreeEnvelope& other);
+};
+
+
+// Static R-tree over a set of envelopes, bulk loaded with Sort-Tile-Recursive (STR) packing
+// The tree is rebuilt as a whole, it does not support inserting or removing single items
+// The items are identified by their index in the vector of envelopes that the tree was built from
+class RTree
+{
+public:
+    RTree();
+
+    static const int nodeCapacity = 16;
+
+    // Builds the tree from the envelopes, replacing the existing tree
+    void build(const std::vector<RTreeEnvelope>& envelopes);
+
+    void clear(void);
+
+    bool isEmpty(void) const;
+
+    // Number of items in the tree
+    int size(void) const;
+
+    // Appends the items whose envelope intersects the search envelope
+    void search(const RTreeEnvelope& searchEnvelope, std::vector<int>& items) const;
+
+    // Appends the items whose envelope is within the given distance of the point
+    void searchRadius(const double x, const double y, const double radius, std::vector<int>& items) const;
+
+    // Calls the visitor for every item whose envelope intersects the search envelope, stops if the visitor returns false
+    template <typename Visitor>
+    void visit(const RTreeEnvelope& searchEnvelope, Visitor visitor) const
+    {
+        if(nodeEnvelopes.empty() || !nodeEnvelopes.back().intersects(searchEnvelope))
+            return;
+
+        std::vector<int> stack(1, static_cast<int>(nodeEnvelopes.size()) - 1);
+
+        while(!stack.empty())
+        {
+            auto node = stack.back();
+            stack.pop_back();
+
+            for(int i = nodeFirstChild[node], end = nodeFirstChild[node] + nodeNumChildren[node]; i<end; ++i)
+            {
+                if(node < numLeaves)
+                {
+                    if(itemEnvelopes[i].intersects(searchEnvelope) && !visitor(itemIDs[i], itemEnvelopes[i]))
+                        return;
+                }
+                else if(nodeEnvelopes[i].intersects(searchEnvelope))
+                {
+                    stack.push_back(i);
+                }
+            }
+        }
+    }
+
+    // Writes the tree through the writer, which is called with a pointer and a number of bytes and returns false if it fails
+    // Used to cache the tree, so that the tree of a large inventory does not have to be built again each time it is loaded
+    template <typename Writer>
+    bool write(Writer writeBytes) const
+    {
+        const long long sizes[3] = {static_cast<long long>(itemIDs.size()), static_cast<long long>(nodeEnvelopes.size()), numLeaves};
+
+        return writeBytes(sizes, sizeof(sizes)) &&
+                writeBytes(itemEnvelopes.data(), sizeof(RTreeEnvelope)*itemEnvelopes.size()) &&
+                writeBytes(itemIDs.data(), sizeof(int)*itemIDs.size()) &&
+                writeBytes(nodeEnvelopes.data(), sizeof(RTreeEnvelope)*nodeEnvelopes.size()) &&
+                writeBytes(nodeFirstChild.data(), sizeof(int)*nodeFirstChild.size()) &&
+                writeBytes(nodeNumChildren.data(), sizeof(int)*nodeNumChildren.size());
+    }
+
+    // Reads a tree that was written with write, where the reader returns a pointer to the next numBytes bytes, e.g., of a memory-mapped file, or nullptr if there are fewer bytes left
+    // Returns false and clears the tree if the data is truncated or the tree is not consistent, e.g., a child or item is out of range, so that a corrupt cache is never searched
+    template <typename Reader>
+    bool read(Reader readBytes)
+    {
+        this->clear();
+
+        long long sizes[3] = {0, 0, 0};
+
+        const char* sizeBytes = readBytes(static_cast<long long>(sizeof(sizes)));
+        if(sizeBytes == nullptr)
+            return false;
+
+        std::memcpy(sizes, sizeBytes, sizeof(sizes));
+
+        const long long maxSize = std::numeric_limits<int>::max();
+        if(sizes[0] < 0 || sizes[0] > maxSize || sizes[1] < 0 || sizes[1] > maxSize || sizes[2] < 0 || sizes[2] > sizes[1])
+            return false;
+
+        // The bytes are checked to be there before the array is allocated
+        auto readArray = [&readBytes](auto& values, const long long numValues)
+        {
+            const long long numBytes = static_cast<long long>(sizeof(typename std::decay<decltype(values)>::type::value_type))*numValues;
+
+            const char* bytes = readBytes(numBytes);
+            if(bytes == nullptr)
+                return false;
+
+            values.resize(static_cast<std::size_t>(numValues));
+
+            if(numBytes > 0)
+                std::memcpy(values.data(), bytes, static_cast<std::size_t>(numBytes));
+
+            return true;
+        };
+
+        const long long numItems = sizes[0];
+        const int numNodes = static_cast<int>(sizes[1]);
+        numLeaves = static_cast<int>(sizes[2]);
+
+        bool OK = readArray(itemEnvelopes, numItems) &&
+                readArray(itemIDs, numItems) &&
+                readArray(nodeEnvelopes, numNodes) &&
+                readArray(nodeFirstChild, numNodes) &&
+                readArray(nodeNumChildren, numNodes);
+
+        // The children of a leaf must be items and the children of any other node must be nodes below it, so that a search stays within the arrays and always ends
+        for(int node = 0; OK && node<numNodes; ++node)
+        {
+            const long long firstChild = nodeFirstChild[node];
+            const long long numChildren = nodeNumChildren[node];
+
+            OK = firstChild >= 0 && numChildren >= 0 && firstChild + numChildren <= (node < numLeaves ? numItems : node);
+        }
+
+        for(std::size_t i = 0; OK && i<itemIDs.size(); ++i)
+            OK = itemIDs[i] >= 0 && itemIDs[i] < numItems;
+
+        if(!OK)
+            this->clear();
+
+        return OK;
+    }
+
+private:
+
+    // Packs the envelopes into parents of up to nodeCapacity children with STR
+    // Returns the order of the children such that each parent covers a contiguous range of the reordered children, and for each parent its envelope, first child and number of children
+    static void packLevel(const std::vector<RTreeEnvelope>& envelopes, std::vector<int>& order, std::vector<RTreeEnvelope>& parentEnvelopes, std::vector<int>& firstChild, std::vector<int>& numChildren);
+
+    // The items in leaf order
+    std::vector<RTreeEnvelope> itemEnvelopes;
+    std::vector<int> itemIDs;
+
+    // The nodes of all levels, from the leaves up to the root which is the last node
+    // The children of a leaf are items, the children of the other nodes are nodes
+    std::vector<RTreeEnvelope> nodeEnvelopes;
+    std::vector<int> nodeFirstChild;
+    std::vector<int> nodeNumChildren;
+
+    int numLeaves;
+};
+
+#endif // RTREE_H
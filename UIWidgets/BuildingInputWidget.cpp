@@ -1,5 +1,7 @@
 #include "BuildingInputWidget.h"
+#include "ComponentAggregator.h"
 
+#include "Envelope.h"
 #include "Field.h"
 #include "GroupLayer.h"
 #include "FeatureCollection.h"
@@ -9,14 +11,27 @@
 #include "ClassBreaksRenderer.h"
 #include "SimpleFillSymbol.h"
 #include "SimpleLineSymbol.h"
+#include "SimpleMarkerSymbol.h"
+#include "SimCenterMapGraphicsView.h"
+#include "GeometryEngine.h"
+#include "MultipointBuilder.h"
 
-#include <QTableWidget>
+#include <QTimer>
+#include <QVector>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
 
 using namespace Esri::ArcGISRuntime;
 
 BuildingInputWidget::BuildingInputWidget(QWidget *parent, QString componentType, QString appType) : ComponentInputWidget(parent, componentType, appType)
 {
+    viewpointTimer = new QTimer(this);
+    viewpointTimer->setSingleShot(true);
+    viewpointTimer->setInterval(250);
 
+    connect(viewpointTimer, &QTimer::timeout, this, &BuildingInputWidget::handleViewpointChanged);
 }
 
 
@@ -35,12 +50,12 @@ int BuildingInputWidget::loadComponentVisualization()
 
     QString columnFilter = "OccupancyClass";
 
+    auto headers = this->getTableHorizontalHeadings();
+
     // Set the table headers as fields in the table
-    for(int i = 1; i<componentTableWidget->columnCount(); ++i)
+    for(int i = 1; i<headers.size(); ++i)
     {
-        auto headerItem = componentTableWidget->horizontalHeaderItem(i);
-
-        auto fieldText = headerItem->text();
+        auto fieldText = headers.at(i);
 
         if(fieldText.compare(columnFilter) == 0)
             columnToMapLayers = i;
@@ -60,18 +75,45 @@ int BuildingInputWidget::loadComponentVisualization()
         return -1;
     }
 
-    auto nRows = componentTableWidget->rowCount();
+    buildingsGroupLayer = buildingLayer;
+    buildingsTreeItem = buildingsItem;
+
+    // The buildings and their attributes were added to the database when the file was loaded
+    auto nRows = theComponentDb.getNumberOfComponents();
+
+    QStringList layerNames;
+
+    // The rows of the buildings in each layer, buildings without a layer value are left out
+    QVector<QVector<int>> layerRows;
+
+    if(columnToMapLayers == 0)
+    {
+        // Without a layer column, all of the buildings are drawn in a single layer with a single symbol
+        layerAttribute = -1;
+
+        QVector<int> rows(nRows);
+        std::iota(rows.begin(), rows.end(), 0);
 
-    std::vector<std::string> vecLayerItems;
-    for(int i = 0; i<nRows; ++i)
+        layerNames.append("All Buildings");
+        layerRows.append(rows);
+    }
+    else
     {
-        // Organize the layers according to occupancy type
-        auto occupancyType = componentTableWidget->item(i,columnToMapLayers)->data(0).toString().toStdString();
+        // The column that defines the layers is stored as categories, so that the buildings can be grouped by their category code
+        layerAttribute = theComponentDb.addCategoricalAttribute(headers.at(columnToMapLayers));
 
-        vecLayerItems.push_back(occupancyType);
+        layerNames = theComponentDb.getCategories(layerAttribute);
+        layerRows = theComponentDb.groupBy(layerAttribute);
     }
 
-    this->uniqueVec<std::string>(vecLayerItems);
+    // The heading of the layer names in the building locations
+    auto layerHeading = columnToMapLayers == 0 ? QString("Layer") : headers.at(columnToMapLayers);
+
+    // Organize the layers according to occupancy type, only the unique values are sorted and not the rows
+
+    QVector<int> layerOrder(layerNames.size());
+    std::iota(layerOrder.begin(), layerOrder.end(), 0);
+    std::sort(layerOrder.begin(), layerOrder.end(), [&](int a, int b) { return layerNames.at(a) < layerNames.at(b); });
 
     auto selectedBuildingsFeatureCollection = new FeatureCollection(this);
     selectedBuildingsTable = new FeatureCollectionTable(fields, GeometryType::Polygon, SpatialReference::wgs84(),this);
@@ -81,9 +123,15 @@ int BuildingInputWidget::loadComponentVisualization()
     selectedBuildingsLayer->setAutoFetchLegendInfos(true);
     selectedBuildingsTable->setRenderer(this->createSelectedBuildingRenderer(1.5));
 
-    // Map to hold the feature tables
-    std::map<std::string, FeatureCollectionTable*> tablesMap;
-    for(auto&& it : vecLayerItems)
+    auto useLevelOfDetail = nRows > maxFootprintsAtLoad;
+
+    // Like the footprints, the selected buildings are only drawn when zoomed in
+    if(useLevelOfDetail)
+        selectedBuildingsLayer->setMinScale(footprintScale);
+
+    layerTables.fill(nullptr, layerNames.size());
+    onDemandRows.clear();
+    for(auto&& code : layerOrder)
     {
         auto featureCollection = new FeatureCollection(this);
 
@@ -93,156 +141,369 @@ int BuildingInputWidget::loadComponentVisualization()
 
         auto newBuildingLayer = new FeatureCollectionLayer(featureCollection,this);
 
-        newBuildingLayer->setName(QString::fromStdString(it));
+        newBuildingLayer->setName(layerNames.at(code));
 
         newBuildingLayer->setAutoFetchLegendInfos(true);
 
         featureCollectionTable->setRenderer(this->createBuildingRenderer());
 
-        tablesMap.insert(std::make_pair(it,featureCollectionTable));
+        // The footprints are hidden when zoomed out
+        if(useLevelOfDetail)
+            newBuildingLayer->setMinScale(footprintScale);
+
+        layerTables[code] = featureCollectionTable;
 
         theVisualizationWidget->addLayerToMap(newBuildingLayer,buildingsItem,buildingLayer);
     }
 
-    auto headers = this->getTableHorizontalHeadings();
+    int numGroupedRows = 0;
+    for(auto&& rows : layerRows)
+        numGroupedRows += rows.size();
+
+    if(numGroupedRows != nRows)
+    {
+        for(int row = 0; row<nRows; ++row)
+        {
+            if(this->getLayerCode(row) == -1)
+            {
+                this->errorMessage("Missing the layer value of the building "+QString::number(theComponentDb.getID(row)));
+                return -1;
+            }
+        }
+    }
+
+    // The feature attributes are the columns from the input file, they are built on worker threads
+    featureHeadings = headers.mid(1);
+
+    featureConstantAttributes.clear();
+    featureConstantAttributes.insert("LossRatio", 0.0);
+    featureConstantAttributes.insert("AssetType", "BUILDINGS");
+
+    QObject::disconnect(viewpointConnection);
+
+    if(!useLevelOfDetail)
+    {
+        // The footprint geometries were built while the file was loading
+        for(int code = 0; code<layerRows.size(); ++code)
+        {
+            auto featureAttributes = this->createFeatureAttributes(layerRows.at(code), featureHeadings, featureConstantAttributes);
+
+            this->addComponentFeatures(layerTables.at(code), layerRows.at(code), featureAttributes);
+        }
+    }
+    else
+    {
+        // When zoomed out, the buildings of each layer are drawn as one multipoint of their centroids
+        QList<Field> locationFields;
+        locationFields.append(Field::createText(layerHeading, "NULL",4));
+        locationFields.append(Field::createText("NumberOfBuildings", "NULL",4));
+        locationFields.append(Field::createText("AssetType", "NULL",4));
+        locationFields.append(Field::createText("TabName", "NULL",4));
+
+        auto locationsFeatureCollection = new FeatureCollection(this);
+        auto locationsTable = new FeatureCollectionTable(locationFields, GeometryType::Multipoint, SpatialReference::wgs84(),this);
+        locationsFeatureCollection->tables()->append(locationsTable);
+
+        auto locationsLayer = new FeatureCollectionLayer(locationsFeatureCollection,this);
+        locationsLayer->setName("Building Locations");
+        locationsLayer->setAutoFetchLegendInfos(true);
+        locationsLayer->setMaxScale(footprintScale);
+        locationsLayer->setMinScale(aggregationScale);
+        locationsTable->setRenderer(this->createBuildingLocationRenderer());
+
+        QList<Feature*> locationFeatures;
+        for(auto&& code : layerOrder)
+        {
+            MultipointBuilder multipointBuilder(SpatialReference::wgs84());
+
+            auto points = multipointBuilder.points();
+
+            for(auto&& row : layerRows.at(code))
+            {
+                // The centroid of the footprint
+                auto envelope = theComponentDb.getEnvelope(row);
+
+                if(!std::isnan(envelope.xMin))
+                    points->addPoint(0.5*(envelope.xMin + envelope.xMax), 0.5*(envelope.yMin + envelope.yMax));
+            }
+
+            QMap<QString, QVariant> locationAttributes;
+            locationAttributes.insert(layerHeading, layerNames.at(code));
+            locationAttributes.insert("NumberOfBuildings", QString::number(layerRows.at(code).size()));
+            locationAttributes.insert("AssetType", "BUILDINGS");
+            locationAttributes.insert("TabName", layerNames.at(code));
+
+            locationFeatures.append(locationsTable->createFeature(locationAttributes, multipointBuilder.toGeometry(), this));
+        }
+
+        locationsTable->addFeatures(locationFeatures);
+
+        theVisualizationWidget->addLayerToMap(locationsLayer,buildingsItem,buildingLayer);
+
+        // At regional scale the buildings are counted in hexagons
+        QString err;
+        if(this->createAggregationLayer("NumberOfBuildings", err) != 0)
+        {
+            this->errorMessage(err);
+            return -1;
+        }
+
+        // The footprints are created as the buildings come into view
+        auto mapView = theVisualizationWidget->getMapViewWidget();
+        viewpointConnection = connect(mapView, &MapGraphicsView::viewpointChanged, viewpointTimer, QOverload<>::of(&QTimer::start));
+    }
+
+    buildingLayer->load();
+
+    theVisualizationWidget->zoomToLayer(buildingLayer->layerId());
 
-    // First check if a footprint was provided
-    auto indexFootprint = headers.indexOf("Footprint");
-    auto indexLatitude = headers.indexOf("Latitude");
-    auto indexLongitude = headers.indexOf("Longitude");
+    return 0;
+}
+
+
+Geometry BuildingInputWidget::createComponentGeometry(const ComponentDatabase& database, const int row, QString& err) const
+{
+    auto indexLatitude = database.getAttributeIndex("Latitude");
+    auto indexLongitude = database.getAttributeIndex("Longitude");
 
     if(indexLongitude == -1 || indexLatitude == -1)
     {
-        this->errorMessage("Could not find latitude and longitude in the header columns");
-        return -1;
+        err = "Could not find latitude and longitude in the header columns";
+        return Geometry();
     }
 
-    for(int i = 0; i<nRows; ++i)
+    auto latitude = database.getAttributeValue(row, indexLatitude).toDouble();
+    auto longitude = database.getAttributeValue(row, indexLongitude).toDouble();
+
+    Point point(longitude,latitude);
+
+    Geometry geom;
+
+    // If a footprint is given use that, the footprints are decoded into the footprint store when the file is loaded so only the buildings without one ("NA") get here
+    if(database.getFootprints().hasFootprint(row))
+    {
+        geom = database.getFootprints().getGeometry(row);
+    }
+    else if(database.getAttributeIndex("Footprint") != -1)
+    {
+        geom = VisualizationWidget::getRectGeometryFromPoint(point, 0.0005,0.0005);
+    }
+    else
     {
-        // create the feature attributes
-        QMap<QString, QVariant> featureAttributes;
+        geom = VisualizationWidget::getRectGeometryFromPoint(point, 0.00015,0.00015);
+    }
+
+    if(geom.isEmpty())
+        err = "Error getting the footprint geometry of the building " + QString::number(database.getID(row));
 
-        // Create a new building
-        Component building;
+    return geom;
+}
 
-        QString buildingIDStr = componentTableWidget->item(i,0)->data(0).toString();
 
-        int buildingID = buildingIDStr.toInt();
+int BuildingInputWidget::updateAggregationLayer(const QString& rendererField, QString& err)
+{
+    // Only the inventories that are drawn with a level of detail have an aggregation layer
+    if(aggregationLayer == nullptr)
+        return 0;
 
-        building.ID = buildingID;
+    return this->createAggregationLayer(rendererField, err);
+}
 
-        QMap<QString, QVariant> buildingAttributeMap;
 
-        // The feature attributes are the columns from the table
-        for(int j = 1; j<componentTableWidget->columnCount(); ++j)
-        {
-            auto attrbText = componentTableWidget->horizontalHeaderItem(j)->text();
-            auto attrbVal = componentTableWidget->item(i,j)->data(0);
+int BuildingInputWidget::createAggregationLayer(const QString& rendererField, QString& err)
+{
+    ComponentAggregator aggregator(ComponentAggregator::Hexagon);
 
-            buildingAttributeMap.insert(attrbText,attrbVal);
+    aggregator.addField("NumberOfBuildings", ComponentAggregator::Count);
 
-            featureAttributes.insert(attrbText,attrbVal);
-        }
+    if(theComponentDb.getAttributeIndex("ReplacementCost") != -1)
+        aggregator.addField("ReplacementCost", ComponentAggregator::Sum, "ReplacementCost");
+
+    // The loss ratios are added to the buildings when the results are imported
+    if(theComponentDb.getAttributeIndex("LossRatio") != -1)
+        aggregator.addField("MeanLossRatio", ComponentAggregator::Mean, "LossRatio");
+
+    if(aggregator.setDatabase(theComponentDb, err) != 0)
+        return -1;
+
+    if(aggregationLayer != nullptr)
+    {
+        theVisualizationWidget->removeLayerFromMapAndTree(aggregationLayer->layerId());
+        aggregationLayer = nullptr;
+    }
 
-        // Create a unique ID for the building
-        auto uid = theVisualizationWidget->createUniqueID();
+    aggregationLayer = theVisualizationWidget->createAndAddAggregationLayer(aggregator, aggregationScale, numAggregationLevels, rendererField, "Building Density", buildingsTreeItem, buildingsGroupLayer);
 
-        building.ComponentAttributes = buildingAttributeMap;
+    if(aggregationLayer == nullptr)
+    {
+        err = "Error creating the aggregation layer of the buildings";
+        return -1;
+    }
 
-        featureAttributes.insert("ID", buildingIDStr);
-        featureAttributes.insert("LossRatio", 0.0);
-        featureAttributes.insert("AssetType", "BUILDINGS");
-        featureAttributes.insert("TabName", buildingIDStr);
-        featureAttributes.insert("UID", uid);
+    return 0;
+}
 
-        auto latitude = componentTableWidget->item(i,indexLatitude)->data(0).toDouble();
-        auto longitude = componentTableWidget->item(i,indexLongitude)->data(0).toDouble();
 
-        // Get the feature collection table for this layer
-        auto layerTag = componentTableWidget->item(i,columnToMapLayers)->data(0).toString().toStdString();
+void BuildingInputWidget::createFeaturesOnDemand(const QVector<int>& rows)
+{
+    if(layerTables.isEmpty())
+        return;
 
-        auto featureCollectionTable = tablesMap.at(layerTag);
+    // Group the buildings that do not have a footprint feature yet by their layer
+    QVector<QVector<int>> layerRows(layerTables.size());
 
-        Feature* feature = nullptr;
+    for(auto&& row : rows)
+    {
+        if(row == -1 || theComponentDb.getFeature(row) != nullptr)
+            continue;
 
-        // If a footprint is given use that
-        if(indexFootprint != -1)
-        {
-            QString footprint = componentTableWidget->item(i,indexFootprint)->data(0).toString();
+        auto code = this->getLayerCode(row);
 
-            if(footprint.compare("NA") == 0)
-            {
-                Point point(longitude,latitude);
-                auto geom = theVisualizationWidget->getRectGeometryFromPoint(point, 0.0005,0.0005);
-                if(geom.isEmpty())
-                {
-                    qDebug()<<"Error getting the building footprint geometry";
-                    return -1;
-                }
+        if(code != -1)
+            layerRows[code].append(row);
+    }
 
-                feature = featureCollectionTable->createFeature(featureAttributes, geom, this);
+    for(int code = 0; code<layerRows.size(); ++code)
+    {
+        if(layerRows.at(code).isEmpty())
+            continue;
 
-                featureCollectionTable->addFeature(feature);
-            }
-            else
-            {
-                auto geom = theVisualizationWidget->getPolygonGeometryFromJson(footprint);
+        auto featureAttributes = this->createFeatureAttributes(layerRows.at(code), featureHeadings, featureConstantAttributes);
 
-                if(geom.isEmpty())
-                {
-                    qDebug()<<"Error getting the building footprint geometry";
-                    return -1;
-                }
+        this->addComponentFeatures(layerTables.at(code), layerRows.at(code), featureAttributes);
 
-                feature = featureCollectionTable->createFeature(featureAttributes, geom, this);
+        onDemandRows.append(layerRows.at(code));
+    }
+}
 
-                featureCollectionTable->addFeature(feature);
-            }
 
-        }
-        else
-        {
-            Point point(longitude,latitude);
-            auto geom = theVisualizationWidget->getRectGeometryFromPoint(point, 0.00015,0.00015);
-            if(geom.isEmpty())
-            {
-                qDebug()<<"Error getting the building footprint geometry";
-                return -1;
-            }
+int BuildingInputWidget::getLayerCode(const int row) const
+{
+    // Without a layer column all of the buildings are in the one layer
+    if(layerAttribute == -1)
+        return 0;
+
+    return theComponentDb.getCategoryCode(row, layerAttribute);
+}
+
+
+void BuildingInputWidget::releaseFeatures(const std::vector<int>& rowsToKeep)
+{
+    if(onDemandRows.isEmpty())
+        return;
+
+    std::vector<quint8> isKept(static_cast<size_t>(theComponentDb.getNumberOfComponents()), 0);
+    for(auto&& row : rowsToKeep)
+        isKept[row] = 1;
 
-            feature = featureCollectionTable->createFeature(featureAttributes, geom, this);
+    // Group the features to release by their layer
+    QVector<QList<Feature*>> layerFeatures(layerTables.size());
+    QVector<int> keptRows;
 
-            featureCollectionTable->addFeature(feature);
+    for(auto&& row : onDemandRows)
+    {
+        auto feature = theComponentDb.getFeature(row);
+
+        if(feature == nullptr)
+            continue;
+
+        if(isKept[row])
+        {
+            keptRows.append(row);
+            continue;
         }
 
-        building.UID = uid;
-        building.ComponentFeature = feature;
+        auto code = this->getLayerCode(row);
+
+        layerFeatures[code].append(feature);
 
-        theComponentDb.addComponent(buildingID, building);
+        theComponentDb.setFeature(row, nullptr);
     }
 
-    buildingLayer->load();
+    onDemandRows.swap(keptRows);
 
-    theVisualizationWidget->zoomToLayer(buildingLayer->layerId());
+    for(int code = 0; code<layerFeatures.size(); ++code)
+    {
+        if(layerFeatures.at(code).isEmpty())
+            continue;
 
-    return 0;
+        this->removeFeaturesFromTable(layerTables.at(code), layerFeatures.at(code));
+    }
 }
 
 
-Feature* BuildingInputWidget::addFeatureToSelectedLayer(QMap<QString, QVariant>& featureAttributes, Geometry& geom)
+void BuildingInputWidget::handleViewpointChanged(void)
 {
-    Feature* feat = selectedBuildingsTable->createFeature(featureAttributes,geom,this);
-    selectedBuildingsTable->addFeature(feat);
+    auto mapView = theVisualizationWidget->getMapViewWidget();
 
-    return feat;
+    if(layerTables.isEmpty() || mapView == nullptr)
+        return;
+
+    // The footprints are not shown when zoomed out, so none of them are kept
+    if(mapView->mapScale() >= footprintScale)
+    {
+        this->releaseFeatures(std::vector<int>());
+        this->updateSelectedFeatures(QVector<int>());
+        return;
+    }
+
+    // The envelopes of the buildings are in the spatial reference of the footprints
+    auto visibleArea = GeometryEngine::project(mapView->visibleArea(), SpatialReference::wgs84());
+
+    if(visibleArea.isEmpty())
+        return;
+
+    auto extent = visibleArea.extent();
+
+    auto rows = theComponentDb.getRowsInEnvelope(RTreeEnvelope{extent.xMin(), extent.yMin(), extent.xMax(), extent.yMax()});
+    auto rowsInView = QVector<int>(rows.begin(), rows.end());
+
+    // Keep the footprints around the view as well, so that a small pan does not release and create the same footprints again
+    auto marginX = 0.5*(extent.xMax() - extent.xMin());
+    auto marginY = 0.5*(extent.yMax() - extent.yMin());
+
+    this->releaseFeatures(theComponentDb.getRowsInEnvelope(RTreeEnvelope{extent.xMin() - marginX, extent.yMin() - marginY, extent.xMax() + marginX, extent.yMax() + marginY}));
+
+    this->createFeaturesOnDemand(rowsInView);
+
+    this->updateSelectedFeatures(rowsInView);
 }
 
 
-int BuildingInputWidget::removeFeatureFromSelectedLayer(Esri::ArcGISRuntime::Feature* feat)
+QVector<int> BuildingInputWidget::getRowsInView(void) const
 {
-    selectedBuildingsTable->deleteFeature(feat);
+    // The viewpoint is only followed with a level of detail, otherwise all of the footprints are drawn
+    if(!viewpointConnection)
+        return ComponentInputWidget::getRowsInView();
 
-    return 0;
+    auto mapView = theVisualizationWidget->getMapViewWidget();
+
+    if(mapView == nullptr || mapView->mapScale() >= footprintScale)
+        return QVector<int>();
+
+    auto visibleArea = GeometryEngine::project(mapView->visibleArea(), SpatialReference::wgs84());
+
+    if(visibleArea.isEmpty())
+        return QVector<int>();
+
+    auto extent = visibleArea.extent();
+
+    auto rows = theComponentDb.getRowsInEnvelope(RTreeEnvelope{extent.xMin(), extent.yMin(), extent.xMax(), extent.yMax()});
+
+    return QVector<int>(rows.begin(), rows.end());
+}
+
+
+QStringList BuildingInputWidget::getCategoricalAttributes(void) const
+{
+    // The occupancy class defines the building layers
+    return QStringList{"OccupancyClass"};
+}
+
+
+QString BuildingInputWidget::getFootprintAttribute(void) const
+{
+    return "Footprint";
 }
 
 
@@ -258,12 +519,30 @@ SimpleRenderer* BuildingInputWidget::createBuildingRenderer(void)
 }
 
 
+SimpleRenderer* BuildingInputWidget::createBuildingLocationRenderer(void)
+{
+    SimpleMarkerSymbol* markerSymbol = new SimpleMarkerSymbol(SimpleMarkerSymbolStyle::Circle, QColor(0, 0, 255, 125), 3.0, this);
+
+    SimpleRenderer* pointRenderer = new SimpleRenderer(markerSymbol, this);
+
+    pointRenderer->setLabel("Building location");
+
+    return pointRenderer;
+}
+
+
 Esri::ArcGISRuntime::FeatureCollectionLayer* BuildingInputWidget::getSelectedFeatureLayer(void)
 {
     return selectedBuildingsLayer;
 }
 
 
+Esri::ArcGISRuntime::FeatureCollectionTable* BuildingInputWidget::getSelectedFeatureTable(void)
+{
+    return selectedBuildingsTable;
+}
+
+
 void BuildingInputWidget::clear()
 {
     delete selectedBuildingsLayer;
@@ -272,6 +551,17 @@ void BuildingInputWidget::clear()
     selectedBuildingsLayer = nullptr;
     selectedBuildingsTable = nullptr;
 
+    viewpointTimer->stop();
+    QObject::disconnect(viewpointConnection);
+
+    layerTables.clear();
+    onDemandRows.clear();
+    layerAttribute = -1;
+
+    buildingsGroupLayer = nullptr;
+    buildingsTreeItem = nullptr;
+    aggregationLayer = nullptr;
+
     ComponentInputWidget::clear();
 }
 
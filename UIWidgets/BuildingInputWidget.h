@@ -3,6 +3,10 @@
 
 #include "ComponentInputWidget.h"
 
+#include <vector>
+
+class QTimer;
+
 namespace Esri
 {
 namespace ArcGISRuntime
@@ -10,6 +14,7 @@ namespace ArcGISRuntime
 class ClassBreaksRenderer;
 class SimpleRenderer;
 class Feature;
+class FeatureCollectionTable;
 class Geometry;
 }
 }
@@ -21,19 +26,71 @@ public:
 
     int loadComponentVisualization();
 
-    Esri::ArcGISRuntime::Feature* addFeatureToSelectedLayer(QMap<QString, QVariant>& featureAttributes, Esri::ArcGISRuntime::Geometry& geom);
-    int removeFeatureFromSelectedLayer(Esri::ArcGISRuntime::Feature* feat);
     Esri::ArcGISRuntime::FeatureCollectionLayer* getSelectedFeatureLayer(void);
 
+    int updateAggregationLayer(const QString& rendererField, QString& err);
+
     void clear();
 
+protected:
+
+    QStringList getCategoricalAttributes(void) const;
+    QString getFootprintAttribute(void) const;
+
+    Esri::ArcGISRuntime::Geometry createComponentGeometry(const ComponentDatabase& database, const int row, QString& err) const;
+
+    void createFeaturesOnDemand(const QVector<int>& rows);
+
+    Esri::ArcGISRuntime::FeatureCollectionTable* getSelectedFeatureTable(void);
+
+    // With a level of detail, only the buildings in view are drawn when zoomed in past the footprint scale
+    QVector<int> getRowsInView(void) const;
+
 private:
 
     Esri::ArcGISRuntime::SimpleRenderer* createBuildingRenderer(void);
+    Esri::ArcGISRuntime::SimpleRenderer* createBuildingLocationRenderer(void);
     Esri::ArcGISRuntime::ClassBreaksRenderer* createSelectedBuildingRenderer(double outlineWidth = 0.0);
 
+    // Creates the footprints of the buildings in view once the map is zoomed in past the footprint scale, and releases the footprints that went out of view
+    void handleViewpointChanged(void);
+
+    // Removes the footprints that were created on demand from their tables, except for the given rows
+    void releaseFeatures(const std::vector<int>& rowsToKeep);
+
+    // Returns the index of the layer of the building, -1 if the building is missing its layer value
+    int getLayerCode(const int row) const;
+
+    // Adds the layer that bins the buildings into hexagons when zoomed out past the aggregation scale, replacing the previous one
+    int createAggregationLayer(const QString& rendererField, QString& err);
+
+    // Inventories with more buildings are drawn as one multipoint of the building centroids per layer when zoomed out
+    // The footprints are only shown when zoomed in, and are only created for the buildings that come into view
+    // Further zoomed out, the buildings are counted in hexagons instead
+    static const int maxFootprintsAtLoad = 20000;
+    static constexpr double footprintScale = 50000.0;
+    static constexpr double aggregationScale = 200000.0;
+    static const int numAggregationLevels = 4;
+
     Esri::ArcGISRuntime::FeatureCollectionLayer* selectedBuildingsLayer = nullptr;
     Esri::ArcGISRuntime::FeatureCollectionTable* selectedBuildingsTable = nullptr;
+
+    // The footprint feature table of each layer, indexed by the category code of the layer, see getLayerCode
+    QVector<Esri::ArcGISRuntime::FeatureCollectionTable*> layerTables;
+
+    // The buildings group layer and the aggregation layer within it
+    Esri::ArcGISRuntime::GroupLayer* buildingsGroupLayer = nullptr;
+    LayerTreeItem* buildingsTreeItem = nullptr;
+    Esri::ArcGISRuntime::GroupLayer* aggregationLayer = nullptr;
+    // The categorical attribute that defines the layers, -1 if there is no layer column and the buildings are in a single layer
+    int layerAttribute = -1;
+
+    // Waits for the map to settle after a pan or zoom before creating footprints
+    QTimer* viewpointTimer = nullptr;
+    QMetaObject::Connection viewpointConnection;
+
+    // The rows of the footprints that were created on demand, these are released once they are out of view
+    QVector<int> onDemandRows;
 };
 
 #endif // BUILDINGINPUTWIDGET_H
@@ -37,15 +37,22 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 // Written by: Stevan Gavrilovic
 
 #include "AssetInputDelegate.h"
+#include "ComponentFilter.h"
 #include "ComponentInputWidget.h"
+#include "ComponentLoader.h"
+#include "ComponentSelection.h"
+#include "ComponentSelectionProxyModel.h"
+#include "ComponentTableModel.h"
 #include "VisualizationWidget.h"
 #include "CSVReaderWriter.h"
+#include "CSVWriter.h"
+#include "GzipInputDevice.h"
+#include "MappedCSVFile.h"
 
 #include <QCoreApplication>
-#include <QApplication>
 #include <QFileDialog>
 #include <QLineEdit>
-#include <QTableWidget>
+#include <QTableView>
 #include <QLabel>
 #include <QGroupBox>
 #include <QGridLayout>
@@ -53,15 +60,78 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QHeaderView>
 #include <QFileInfo>
 #include <QJsonObject>
+#include <QSet>
+#include <QTimer>
+#include <QUuid>
+#include <QtConcurrent/QtConcurrentMap>
 
 #include "FeatureCollectionLayer.h"
+#include "FeatureCollectionTable.h"
 
 // Std library headers
 #include <string>
 #include <algorithm>
+#include <memory>
+#include <numeric>
+
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
 
 using namespace Esri::ArcGISRuntime;
 
+namespace {
+
+// Copies the file, on file systems that support it the copy shares the data of the source file (a reflink) until either file is changed
+int cloneFile(const QString& source, const QString& destination, QString& err)
+{
+    if(QFile::exists(destination) && !QFile::remove(destination))
+    {
+        err = "Error removing the existing file: " + destination;
+        return -1;
+    }
+
+#if defined(Q_OS_LINUX) && defined(FICLONE)
+    auto sourceFd = ::open(QFile::encodeName(source).constData(), O_RDONLY);
+
+    if(sourceFd != -1)
+    {
+        auto destinationFd = ::open(QFile::encodeName(destination).constData(), O_WRONLY | O_CREAT | O_EXCL, 0666);
+
+        if(destinationFd != -1)
+        {
+            auto res = ::ioctl(destinationFd, FICLONE, sourceFd);
+
+            ::close(destinationFd);
+
+            if(res == 0)
+            {
+                ::close(sourceFd);
+                return 0;
+            }
+
+            QFile::remove(destination);
+        }
+
+        ::close(sourceFd);
+    }
+#endif
+
+    // Plain copy if the file system cannot share the data
+    if(!QFile::copy(source, destination))
+    {
+        err = "Error copying the file " + source + " to " + destination;
+        return -1;
+    }
+
+    return 0;
+}
+
+}
+
 ComponentInputWidget::ComponentInputWidget(QWidget *parent, QString componentType, QString appType) : SimCenterAppWidget(parent), componentType(componentType), appType(appType)
 {
     label1 = "Load information from a CSV file";
@@ -73,6 +143,21 @@ ComponentInputWidget::ComponentInputWidget(QWidget *parent, QString componentTyp
     pathToComponentInfoFile = "NULL";
     componentGroupBox = nullptr;
     theVisualizationWidget = nullptr;
+
+    // The loader runs on a worker thread and reports back through signals
+    componentLoader = new ComponentLoader(this);
+
+    // The geometries are built by the subclasses, on the threads of the loader
+    componentLoader->setGeometryBuilder([this](const ComponentDatabase& database, const int row, QString& err)
+    {
+        return this->createComponentGeometry(database, row, err);
+    });
+
+    connect(componentLoader,&ComponentLoader::progressChanged,this,&ComponentInputWidget::handleComponentLoadProgress);
+    connect(componentLoader,&ComponentLoader::finished,this,&ComponentInputWidget::handleComponentDataLoaded);
+    connect(componentLoader,&ComponentLoader::failed,this,&ComponentInputWidget::handleComponentLoadFailed);
+    connect(componentLoader,&ComponentLoader::cancelled,this,&ComponentInputWidget::handleComponentLoadCancelled);
+
     this->createComponentsBox();
 }
 
@@ -85,12 +170,18 @@ ComponentInputWidget::~ComponentInputWidget()
 
 void ComponentInputWidget::loadComponentData(void)
 {
-    // Ask for the file path if the file path has not yet been set, and return if it is still null
+    // Ask for the file path if the file path has not yet been set, the dialog loads the file once it is chosen
     if(pathToComponentInfoFile.compare("NULL") == 0)
+    {
         this->chooseComponentInfoFileDialog();
+        return;
+    }
 
-    if(pathToComponentInfoFile.compare("NULL") == 0)
+    if(componentLoader->isRunning())
+    {
+        this->errorMessage("A file is already being loaded, cancel the load before loading another file");
         return;
+    }
 
     // Check if the directory exists
     QFile file(pathToComponentInfoFile);
@@ -112,111 +203,105 @@ void ComponentInputWidget::loadComponentData(void)
         }
     }
 
-    CSVReaderWriter csvTool;
+    // The file is parsed, validated, and indexed, and the geometries are built on a worker thread, the features are added to the map once the loader is finished
+    componentSelectionProxyModel->clearSelection();
+    componentTableModel->clear();
+    theComponentDb.clear();
+    inventoryIDs.clear();
+    componentGeometries.clear();
 
-    QString err;
-    QVector<QStringList> data = csvTool.parseCSVFile(pathToComponentInfoFile,err);
+    // The export reuses the rows of the file as long as the file does not change
+    componentFileLastModified = QFileInfo(pathToComponentInfoFile).lastModified();
+
+    componentLoader->setCategoricalAttributes(this->getCategoricalAttributes());
+    componentLoader->setFootprintAttribute(this->getFootprintAttribute());
 
-    if(!err.isEmpty())
+    QString err;
+    if(componentLoader->start(pathToComponentInfoFile, err) != 0)
     {
         this->errorMessage(err);
         return;
     }
 
-    if(data.empty())
-    {
-        this->errorMessage("Input file is empty");
-        return;
-    }
+    cancelLoadButton->show();
 
-    // Get the header file
-    QStringList tableHeadings = data.first();
+    this->statusMessage("Loading assets from " + pathToComponentInfoFile);
+
+    return;
+}
 
-    tableHorizontalHeadings = tableHeadings;
 
-    // Pop off the row that contains the header information
-    data.pop_front();
+void ComponentInputWidget::handleComponentLoadProgress(const QString& stage, const int done, const int total)
+{
+    this->statusMessage(stage + ": " + QString::number(done) + " of " + QString::number(total));
+}
 
-    auto numRows = data.size();
-    auto numCols = tableHeadings.size();
 
-    if(numRows == 0)
-    {
-        this->errorMessage("Input file is empty");
+void ComponentInputWidget::handleComponentDataLoaded(const int generation)
+{
+    // The signal of an earlier load that arrived after a new load was started
+    if(generation != componentLoader->getGeneration())
         return;
-    }
-    else{
-        this->statusMessage("Loading " + QString::number(numRows)+ " assets");
-        QApplication::processEvents();
-    }
 
-    auto firstRow = data.first();
+    cancelLoadButton->hide();
 
-    if(firstRow.empty())
-    {
-        this->errorMessage("First row is empty");
+    // The load was cancelled or cleared after the loader finished
+    if(componentLoader->takeResults(theComponentDb, componentGeometries) != 0)
         return;
-    }
 
-    auto initialID = firstRow.first().toInt();
+    tableHorizontalHeadings = componentLoader->getHeadings();
 
-    componentTableWidget->clear();
-    componentTableWidget->setRowCount(numRows);
-    componentTableWidget->setColumnCount(numCols);
-    componentTableWidget->setHorizontalHeaderLabels(tableHeadings);
+    inventoryIDs = theComponentDb.getIDs();
 
-    // Fill in the cells
-    for(int i = 0; i<numRows; ++i)
-    {
+    componentTableModel->setHeadings(tableHorizontalHeadings);
 
-        // Display a status message every n assets
-        if((i+1)%1000 == 0)
-        {
-            this->statusMessage("Loading asset number: " + QString::number(i+1));
-            QApplication::processEvents();
-        }
+    componentInfoText->show();
+    componentTableView->show();
 
-        auto rowStringList = data[i];
+    emit componentDataLoaded();
 
-        if(rowStringList.size() != numCols)
-        {
-            this->statusMessage("Error, the number of items in row " + QString::number(i+1) + " does not equal number of headings in the file");
-            return;
-        }
+    this->statusMessage("Adding " + QString::number(theComponentDb.getNumberOfComponents()) + " assets to the map");
 
-        auto currID = rowStringList.first().toInt();
+    this->loadComponentVisualization();
 
-        if(initialID+i != currID)
-        {
-            this->statusMessage("Error, the asset IDs must be sequential");
-            return;
-        }
+    // Apply a selection that was given while the file was loading
+    if(!pendingFilterString.isEmpty())
+    {
+        this->setFilterString(pendingFilterString);
+        pendingFilterString.clear();
+    }
 
-        for(int j = 0; j<numCols; ++j)
-        {
-            auto cellData = rowStringList[j];
+    this->statusMessage("Done loading assets");
+}
 
-            auto item = new QTableWidgetItem(cellData);
 
-            // Make the first three columns (ID, lat, lon) uneditable
-            if(j < 3)
-                item->setFlags(item->flags() ^ (Qt::ItemIsEditable | Qt::ItemIsEnabled));
+void ComponentInputWidget::handleComponentLoadFailed(const int generation, const QString& err)
+{
+    if(generation != componentLoader->getGeneration())
+        return;
 
-            componentTableWidget->setItem(i,j, item);
-        }
-    }
+    cancelLoadButton->hide();
+    pendingFilterString.clear();
 
-    componentInfoText->show();
-    componentTableWidget->show();
+    this->errorMessage(err);
+}
 
-    emit componentDataLoaded();
 
-    this->loadComponentVisualization();
+void ComponentInputWidget::handleComponentLoadCancelled(const int generation)
+{
+    if(generation != componentLoader->getGeneration())
+        return;
 
-    this->statusMessage("Done loading assets");
-    QApplication::processEvents();
+    cancelLoadButton->hide();
+    pendingFilterString.clear();
 
-    return;
+    this->statusMessage("Loading of the assets was cancelled");
+}
+
+
+void ComponentInputWidget::cancelComponentLoad(void)
+{
+    componentLoader->cancel();
 }
 
 
@@ -248,9 +333,39 @@ int ComponentInputWidget::loadComponentVisualization()
 }
 
 
-QTableWidget *ComponentInputWidget::getTableWidget() const
+QTableView *ComponentInputWidget::getTableView() const
 {
-    return componentTableWidget;
+    return componentTableView;
+}
+
+
+QStringList ComponentInputWidget::getCategoricalAttributes(void) const
+{
+    return QStringList();
+}
+
+
+QString ComponentInputWidget::getFootprintAttribute(void) const
+{
+    return QString();
+}
+
+
+Geometry ComponentInputWidget::getComponentGeometry(const int row) const
+{
+    const auto& footprints = theComponentDb.getFootprints();
+
+    if(footprints.hasFootprint(row))
+        return footprints.getGeometry(row);
+
+    return componentGeometries.at(row);
+}
+
+
+// Implement in subclass
+Geometry ComponentInputWidget::createComponentGeometry(const ComponentDatabase& /*database*/, const int /*row*/, QString& /*err*/) const
+{
+    return Geometry();
 }
 
 
@@ -290,6 +405,14 @@ void ComponentInputWidget::createComponentsBox(void)
 
     connect(browseFileButton,SIGNAL(clicked()),this,SLOT(chooseComponentInfoFileDialog()));
 
+    // Cancels a file that is being loaded, only shown during the load
+    cancelLoadButton = new QPushButton();
+    cancelLoadButton->setText(tr("Cancel"));
+    cancelLoadButton->setMaximumWidth(150);
+    cancelLoadButton->hide();
+
+    connect(cancelLoadButton,&QPushButton::clicked,this,&ComponentInputWidget::cancelComponentLoad);
+
     // Add a horizontal spacer after the browse and load buttons
     auto hspacer = new QSpacerItem(0,0,QSizePolicy::Expanding, QSizePolicy::Minimum);
 
@@ -311,22 +434,59 @@ void ComponentInputWidget::createComponentsBox(void)
 
     connect(clearSelectionButton,SIGNAL(clicked()),this,SLOT(clearComponentSelection()));
 
+    // Selection by the attributes of the components
+    QLabel* attributeFilterText = new QLabel();
+    attributeFilterText->setText("Or select the " + componentType.toLower() + " by their attributes, e.g., YearBuilt < 1940 && NumberOfStories >= 3 && OccupancyClass in {RES3, COM1}");
+
+    attributeFilterLineEdit = new QLineEdit();
+    attributeFilterLineEdit->setMaximumWidth(1000);
+    attributeFilterLineEdit->setMinimumWidth(400);
+    attributeFilterLineEdit->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Minimum);
+    attributeFilterLineEdit->setPlaceholderText("e.g., YearBuilt < 1940 && OccupancyClass in {RES3, COM1}");
+
+    attributeFilterStatusLabel = new QLabel();
+
+    attributeFilterTimer = new QTimer(this);
+    attributeFilterTimer->setSingleShot(true);
+    attributeFilterTimer->setInterval(250);
+
+    connect(attributeFilterLineEdit,&QLineEdit::textChanged,this,&ComponentInputWidget::handleAttributeFilterChanged);
+    connect(attributeFilterLineEdit,&QLineEdit::returnPressed,this,&ComponentInputWidget::selectComponentsByAttributes);
+    connect(attributeFilterTimer,&QTimer::timeout,this,&ComponentInputWidget::previewAttributeFilter);
+
+    QPushButton *selectByAttributesButton = new QPushButton();
+    selectByAttributesButton->setText(tr("Select"));
+    selectByAttributesButton->setMaximumWidth(150);
+
+    connect(selectByAttributesButton,&QPushButton::clicked,this,&ComponentInputWidget::selectComponentsByAttributes);
+
     // Text label for Component information
     componentInfoText = new QLabel(label3);
     componentInfoText->setStyleSheet("font-weight: bold; color: black");
     componentInfoText->hide();
 
-    // Create the table that will show the Component information
-    componentTableWidget = new QTableWidget();
-    componentTableWidget->hide();
-    componentTableWidget->setToolTip("Component details");
-    componentTableWidget->verticalHeader()->setVisible(false);
-    componentTableWidget->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    // Create the table that will show the Component information, the model reads the cells from the component database
+    componentTableModel = new ComponentTableModel(&theComponentDb, this);
+
+    // The view is filtered through the selection of components
+    componentSelectionProxyModel = new ComponentSelectionProxyModel(&theComponentDb, this);
+    componentSelectionProxyModel->setSourceModel(componentTableModel);
 
-    componentTableWidget->setSizeAdjustPolicy(QAbstractScrollArea::SizeAdjustPolicy::AdjustToContents);
-    componentTableWidget->setSizePolicy(QSizePolicy::Maximum,QSizePolicy::Expanding);
+    componentTableView = new QTableView();
+    componentTableView->setModel(componentSelectionProxyModel);
+    componentTableView->hide();
+    componentTableView->setToolTip("Component details");
+    componentTableView->verticalHeader()->setVisible(false);
 
-    connect(componentTableWidget, &QTableWidget::cellChanged, this, &ComponentInputWidget::handleCellChanged);
+    // Resizing to the contents would format every cell in the table, size the columns from the visible rows only
+    componentTableView->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
+    componentTableView->horizontalHeader()->setResizeContentsPrecision(100);
+    connect(componentTableModel, &QAbstractItemModel::modelReset, componentTableView, &QTableView::resizeColumnsToContents);
+
+    componentTableView->setSizeAdjustPolicy(QAbstractScrollArea::SizeAdjustPolicy::AdjustToContents);
+    componentTableView->setSizePolicy(QSizePolicy::Maximum,QSizePolicy::Expanding);
+
+    connect(componentTableModel, &QAbstractItemModel::dataChanged, this, &ComponentInputWidget::handleCellChanged);
 
     // Add a vertical spacer at the bottom to push everything up
     gridLayout->addItem(smallVSpacer,0,0,1,5);
@@ -334,15 +494,20 @@ void ComponentInputWidget::createComponentsBox(void)
     gridLayout->addWidget(pathText,2,0);
     gridLayout->addWidget(componentFileLineEdit,2,1);
     gridLayout->addWidget(browseFileButton,2,2);
+    gridLayout->addWidget(cancelLoadButton,2,3);
     gridLayout->addItem(hspacer, 2, 4);
     gridLayout->addWidget(selectComponentsText, 3, 0, 1, 4);
     gridLayout->addWidget(selectComponentsLineEdit, 4, 0, 1, 2);
     gridLayout->addWidget(selectComponentsButton, 4, 2);
     gridLayout->addWidget(clearSelectionButton, 4, 3);
-    gridLayout->addItem(smallVSpacer,5,0,1,5);
-    gridLayout->addWidget(componentInfoText,6,0,1,5,Qt::AlignCenter);
-    gridLayout->addWidget(componentTableWidget, 7, 0, 1, 5,Qt::AlignCenter);
-    gridLayout->setRowStretch(8, 1);
+    gridLayout->addWidget(attributeFilterText, 5, 0, 1, 4);
+    gridLayout->addWidget(attributeFilterLineEdit, 6, 0, 1, 2);
+    gridLayout->addWidget(selectByAttributesButton, 6, 2);
+    gridLayout->addWidget(attributeFilterStatusLabel, 6, 3);
+    gridLayout->addItem(smallVSpacer,7,0,1,5);
+    gridLayout->addWidget(componentInfoText,8,0,1,5,Qt::AlignCenter);
+    gridLayout->addWidget(componentTableView, 9, 0, 1, 5,Qt::AlignCenter);
+    gridLayout->setRowStretch(10, 1);
     this->setLayout(gridLayout);
 }
 
@@ -369,130 +534,276 @@ void ComponentInputWidget::selectComponents(void)
 void ComponentInputWidget::handleComponentSelection(void)
 {
 
-    auto nRows = componentTableWidget->rowCount();
+    auto nRows = componentTableModel->rowCount();
 
     if(nRows == 0)
         return;
 
-    // Get the ID of the first and last component
-    bool OK;
-    auto firstID = componentTableWidget->item(0,0)->data(0).toInt(&OK);
-
-    if(!OK)
-    {
-        QString msg = "Error in getting the component ID in " + QString(__FUNCTION__);
-        this->errorMessage(msg);
+    if(selectComponentsLineEdit->getSelectedComponentIDs().isEmpty())
         return;
-    }
 
-    auto lastID = componentTableWidget->item(nRows-1,0)->data(0).toInt(&OK);
+    // The IDs do not have to be sequential, so a range of IDs may include IDs that are not in the inventory. Only the IDs that are in the inventory are kept
+    auto selectedComponentIDs = selectComponentsLineEdit->getSelectedComponentIDs();
+
+    auto numRequested = selectedComponentIDs.size();
 
-    if(!OK)
+    selectedComponentIDs.intersect(inventoryIDs);
+
+    if(selectedComponentIDs.isEmpty())
     {
-        QString msg = "Error in getting the component ID in " + QString(__FUNCTION__);
+        QString msg = "None of the selected component IDs are in the components provided";
         this->errorMessage(msg);
+        selectComponentsLineEdit->clear();
         return;
     }
 
-    auto selectedComponentIDs = selectComponentsLineEdit->getSelectedComponentIDs();
-
-    // First check that all of the selected IDs are within range
-    for(auto&& it : selectedComponentIDs)
+    if(selectedComponentIDs.size() != numRequested)
     {
-        if(it<firstID || it>lastID)
-        {
-            QString msg = "The component ID " + QString::number(it) + " is out of range of the components provided";
-            this->errorMessage(msg);
-            selectComponentsLineEdit->clear();
-            return;
-        }
+        this->statusMessage(QString::number(numRequested - selectedComponentIDs.size()) + " of the selected component IDs are not in the components provided and were left out");
+        selectComponentsLineEdit->setSelectedComponentIDs(selectedComponentIDs);
     }
 
-    // Hide all rows in the table
-    for(int i = 0; i<nRows; ++i)
-        componentTableWidget->setRowHidden(i,true);
-
-    // Unhide the selected rows
-    for(auto&& it : selectedComponentIDs)
-        componentTableWidget->setRowHidden(it - firstID,false);
+    // Only show the selected rows in the table
+    componentSelectionProxyModel->setSelection(selectedComponentIDs);
 
     auto numAssets = selectedComponentIDs.size();
     QString msg = "A total of "+ QString::number(numAssets) + " " + componentType.toLower() + " are selected for analysis";
     this->statusMessage(msg);
 
-    for(auto&& it : selectedComponentIDs)
+    // Only the selected components that are in view are drawn in the selected layer, the rest are drawn as they come into view
+    this->updateSelectedFeatures(this->getRowsInView());
+
+    auto selecFeatLayer = this->getSelectedFeatureLayer();
+
+    if(selecFeatLayer == nullptr)
     {
-        auto component = theComponentDb.getComponent(it);
+        QString err = "Error in getting the selected feature layer";
+        qDebug()<<err;
+        return;
+    }
 
-        auto feature = component.ComponentFeature;
+    // Add the layer to the map if it does not already exist
+    auto layerExists = theVisualizationWidget->getLayer(selecFeatLayer->layerId());
+
+    if(layerExists == nullptr)
+        theVisualizationWidget->addSelectedFeatureLayerToMap(selecFeatLayer);
+}
+
+
+void ComponentInputWidget::clearLayerSelectedForAnalysis(void)
+{
+    if(selectedFeaturesForAnalysis.empty())
+        return;
+
+    auto selectedTable = this->getSelectedFeatureTable();
+
+    if(selectedTable != nullptr)
+        this->removeFeaturesFromTable(selectedTable, selectedFeaturesForAnalysis.values());
+
+    selectedFeaturesForAnalysis.clear();
+}
 
-        if(feature == nullptr)
-            continue;
 
-        auto atrb = feature->attributes()->attributesMap();
-        auto id = atrb.value("UID").toString();
+void ComponentInputWidget::updateSelectedFeatures(const QVector<int>& rows)
+{
+    auto selectedTable = this->getSelectedFeatureTable();
+
+    if(selectedTable == nullptr)
+        return;
 
-        if(selectedFeaturesForAnalysis.contains(id))
+    const auto& selectedComponentIDs = selectComponentsLineEdit->getSelectedComponentIDs();
+
+    // The selected components among the rows, and those that do not have a selected feature yet
+    QSet<QString> shownUIDs;
+    QVector<int> newRows;
+
+    for(auto&& row : rows)
+    {
+        if(!selectedComponentIDs.contains(theComponentDb.getID(row)))
             continue;
 
-        auto atrVals = atrb.values();
-        auto atrKeys = atrb.keys();
+        auto uid = theComponentDb.getUID(row);
+
+        shownUIDs.insert(uid);
+
+        if(!selectedFeaturesForAnalysis.contains(uid))
+            newRows.append(row);
+    }
 
-        // qDebug()<<"Num atributes: "<<atrb.size();
+    // Remove the selected features that went out of view or are no longer selected
+    QList<Feature*> removedFeatures;
 
-        QMap<QString, QVariant> featureAttributes;
-        for(int i = 0; i<atrb.size();++i)
+    for(auto it = selectedFeaturesForAnalysis.begin(); it != selectedFeaturesForAnalysis.end();)
+    {
+        if(shownUIDs.contains(it.key()))
         {
-            auto key = atrKeys.at(i);
-            auto val = atrVals.at(i);
+            ++it;
+            continue;
+        }
 
-            // Including the ObjectID causes a crash!!! Do not include it when creating an object
-            if(key == "ObjectID")
-                continue;
+        removedFeatures.append(it.value());
+        it = selectedFeaturesForAnalysis.erase(it);
+    }
 
-            // qDebug()<< nid<<"-key:"<<key<<"-value:"<<atrVals.at(i).toString();
+    if(!removedFeatures.isEmpty())
+        this->removeFeaturesFromTable(selectedTable, removedFeatures);
 
-            featureAttributes[key] = val;
-        }
+    if(newRows.isEmpty())
+        return;
+
+    // The attributes come from the database, so the results that were added to the components are shown as well
+    auto featureAttributes = this->createFeatureAttributes(newRows, featureHeadings, featureConstantAttributes);
+
+    QList<Feature*> newFeatures;
+    newFeatures.reserve(newRows.size());
+
+    for(int i = 0; i<newRows.size(); ++i)
+    {
+        auto row = newRows.at(i);
 
-        auto geom = feature->geometry();
+        // The table owns the features, so that they are deleted with the layer
+        auto feature = selectedTable->createFeature(featureAttributes.at(i), this->getComponentGeometry(row), selectedTable);
 
-        auto feat = this->addFeatureToSelectedLayer(featureAttributes,geom);
+        newFeatures.append(feature);
 
-        if(feat)
-            selectedFeaturesForAnalysis.insert(id,feat);
+        selectedFeaturesForAnalysis.insert(theComponentDb.getUID(row), feature);
     }
 
-    auto selecFeatLayer = this->getSelectedFeatureLayer();
+    selectedTable->addFeatures(newFeatures);
+}
 
-    if(selecFeatLayer == nullptr)
+
+void ComponentInputWidget::removeFeaturesFromTable(FeatureTable* table, const QList<Feature*>& features)
+{
+    auto taskWatcher = table->deleteFeatures(features);
+
+    if (!taskWatcher.isValid())
     {
-        QString err = "Error in getting the selected feature layer";
-        qDebug()<<err;
+        qDebug() <<"Error, task not valid in "<<__FUNCTION__;
         return;
     }
 
-    // Add the layer to the map if it does not already exist
-    auto layerExists = theVisualizationWidget->getLayer(selecFeatLayer->layerId());
+    // Delete the features once the table no longer holds them
+    auto taskID = taskWatcher.taskId();
+    auto connection = std::make_shared<QMetaObject::Connection>();
 
-    if(layerExists == nullptr)
-        theVisualizationWidget->addSelectedFeatureLayerToMap(selecFeatLayer);
+    *connection = connect(table, &FeatureTable::deleteFeaturesCompleted, this, [connection, taskID, features](QUuid completedTaskID, bool /*success*/)
+    {
+        if(completedTaskID != taskID)
+            return;
+
+        QObject::disconnect(*connection);
+
+        qDeleteAll(features);
+    });
 }
 
 
-void ComponentInputWidget::clearLayerSelectedForAnalysis(void)
+std::vector<QMap<QString, QVariant>> ComponentInputWidget::createFeatureAttributes(const QVector<int>& rows, const QStringList& headings, const QMap<QString, QVariant>& constantAttributes) const
 {
-    if(selectedFeaturesForAnalysis.empty())
-        return;
+    const int numRows = rows.size();
+
+    std::vector<QMap<QString, QVariant>> featureAttributes(numRows);
+
+    // Look up the attribute columns in the database once, the ID column is not an attribute in the database
+    QVector<int> attributeIndexes(headings.size(), -1);
+    for(int j = 0; j<headings.size(); ++j)
+        attributeIndexes[j] = theComponentDb.getAttributeIndex(headings.at(j));
+
+    // A constant attribute that is also in the database, e.g., a result that was added to the components, takes its value from the database
+    auto constantKeys = constantAttributes.keys();
+
+    QVector<int> constantIndexes(constantKeys.size(), -1);
+    for(int j = 0; j<constantKeys.size(); ++j)
+        constantIndexes[j] = theComponentDb.getAttributeIndex(constantKeys.at(j));
 
-    for(auto&& it : selectedFeaturesForAnalysis)
+    // Each thread fills the maps of a contiguous chunk of rows, the database is only read
+    const int chunkSize = 4096;
+
+    std::vector<int> chunkStarts;
+    for(int start = 0; start<numRows; start += chunkSize)
+        chunkStarts.push_back(start);
+
+    QtConcurrent::blockingMap(chunkStarts, [&](const int start)
     {
-        this->removeFeatureFromSelectedLayer(it);
+        auto end = std::min(start + chunkSize, numRows);
+
+        for(int i = start; i<end; ++i)
+        {
+            auto row = rows.at(i);
+
+            auto& attributes = featureAttributes[i];
+
+            attributes = constantAttributes;
+
+            for(int j = 0; j<constantKeys.size(); ++j)
+            {
+                if(constantIndexes.at(j) == -1)
+                    continue;
+
+                auto value = theComponentDb.getAttributeValue(row, constantIndexes.at(j));
+
+                if(value.isValid())
+                    attributes.insert(constantKeys.at(j), value);
+            }
+
+            auto IDStr = QString::number(theComponentDb.getID(row));
+
+            // The feature fields are text
+            for(int j = 0; j<headings.size(); ++j)
+            {
+                auto attribute = attributeIndexes.at(j);
+
+                attributes.insert(headings.at(j), attribute == -1 ? IDStr : theComponentDb.getAttributeText(row, attribute));
+            }
+
+            attributes.insert("ID", IDStr);
+            attributes.insert("TabName", IDStr);
+            attributes.insert("UID", theComponentDb.getUID(row));
+        }
+    });
+
+    return featureAttributes;
+}
+
+
+void ComponentInputWidget::addComponentFeatures(FeatureTable* table, const QVector<int>& rows, const std::vector<QMap<QString, QVariant>>& featureAttributes)
+{
+    // The features are added in large batches, adding them one at a time is the slowest part of building a large layer
+    const int batchSize = 50000;
+
+    QList<Feature*> batch;
+    batch.reserve(std::min(batchSize, rows.size()));
+
+    for(int i = 0; i<rows.size(); ++i)
+    {
+        auto row = rows.at(i);
+
+        auto feature = table->createFeature(featureAttributes.at(i), this->getComponentGeometry(row), this);
+
+        theComponentDb.setFeature(row, feature);
+
+        batch.append(feature);
+
+        if(batch.size() == batchSize)
+        {
+            table->addFeatures(batch);
+            batch.clear();
+        }
     }
 
-    selectedFeaturesForAnalysis.clear();
+    if(!batch.isEmpty())
+        table->addFeatures(batch);
+}
+
+
+// Implement in subclass, the features of the other widgets are all created when the components are loaded
+void ComponentInputWidget::createFeaturesOnDemand(const QVector<int>& /*rows*/)
+{
+
 }
 
+
 QStringList ComponentInputWidget::getTableHorizontalHeadings() const
 {
     return tableHorizontalHeadings;
@@ -501,31 +812,77 @@ QStringList ComponentInputWidget::getTableHorizontalHeadings() const
 
 void ComponentInputWidget::clearComponentSelection(void)
 {
-    auto selectedComponentIDs = selectComponentsLineEdit->getSelectedComponentIDs();
+    this->clearLayerSelectedForAnalysis();
+
+    // Show all rows in the table
+    componentSelectionProxyModel->clearSelection();
+
+    selectComponentsLineEdit->clear();
+
+}
 
-    QList<Esri::ArcGISRuntime::Feature*> selectedFeatures;
-    for(auto&& it : selectedComponentIDs)
+
+void ComponentInputWidget::handleAttributeFilterChanged(void)
+{
+    // Restart the timer so that the filter is only evaluated once the user pauses typing
+    attributeFilterTimer->start();
+}
+
+
+void ComponentInputWidget::previewAttributeFilter(void)
+{
+    auto expression = attributeFilterLineEdit->text();
+
+    if(expression.trimmed().isEmpty())
     {
-        auto component = theComponentDb.getComponent(it);
+        attributeFilterStatusLabel->clear();
+        return;
+    }
 
-        auto feature = component.ComponentFeature;
+    ComponentFilter filter;
 
-        selectedFeatures<<feature;
+    QString err;
+    if(filter.compile(expression, theComponentDb, err) != 0)
+    {
+        attributeFilterStatusLabel->setText("Invalid filter");
+        attributeFilterStatusLabel->setToolTip(err);
+        return;
     }
 
-    this->clearLayerSelectedForAnalysis();
+    auto mask = filter.evaluateMask(theComponentDb);
+    auto numMatches = std::count(mask.begin(), mask.end(), 1);
+
+    attributeFilterStatusLabel->setText(QString::number(numMatches) + " of " + QString::number(mask.size()) + " match");
+    attributeFilterStatusLabel->setToolTip(QString());
+}
+
 
+void ComponentInputWidget::selectComponentsByAttributes(void)
+{
+    attributeFilterTimer->stop();
 
-    auto nRows = componentTableWidget->rowCount();
+    ComponentFilter filter;
 
-    // Hide all rows in the table
-    for(int i = 0; i<nRows; ++i)
+    QString err;
+    if(filter.compile(attributeFilterLineEdit->text(), theComponentDb, err) != 0)
     {
-        componentTableWidget->setRowHidden(i,false);
+        this->errorMessage(err);
+        return;
     }
 
-    selectComponentsLineEdit->clear();
+    if(filter.isEmpty())
+        return;
 
+    auto componentIDs = filter.evaluate(theComponentDb);
+
+    // The filter replaces the current selection
+    this->clearComponentSelection();
+
+    selectComponentsLineEdit->insertSelectedComponents(componentIDs);
+
+    this->handleComponentSelection();
+
+    this->previewAttributeFilter();
 }
 
 
@@ -559,12 +916,18 @@ void ComponentInputWidget::setComponentType(const QString &value)
 }
 
 
-void ComponentInputWidget::insertSelectedComponent(const int ComponentID)
+void ComponentInputWidget::insertSelectedComponent(const qint64 ComponentID)
 {
     selectComponentsLineEdit->insertSelectedCompoonent(ComponentID);
 }
 
 
+void ComponentInputWidget::insertSelectedComponents(const std::vector<qint64>& ComponentIDs)
+{
+    selectComponentsLineEdit->insertSelectedComponents(ComponentIDs);
+}
+
+
 int ComponentInputWidget::numberComponentsSelected(void)
 {
     return selectComponentsLineEdit->size();
@@ -698,6 +1061,13 @@ bool ComponentInputWidget::inputAppDataFromJSON(QJsonObject &jsonObject)
 
 void ComponentInputWidget::setFilterString(const QString& filter)
 {
+    // The components are selected once the file is loaded
+    if(componentLoader->isRunning())
+    {
+        pendingFilterString = filter;
+        return;
+    }
+
     selectComponentsLineEdit->setText(filter);
     selectComponentsLineEdit->selectComponents();
 }
@@ -734,95 +1104,184 @@ bool ComponentInputWidget::copyFiles(QString &destName)
     if (!componentFile.exists())
         return false;
 
-    // Do not copy the file, output a new csv which will have the changes that the user makes in the table
-    //        if (componentFile.exists()) {
-    //            return this->copyFile(componentFileLineEdit->text(), destName);
-    //        }
-
     auto pathToSaveFile = destName + QDir::separator() + componentFile.fileName();
 
-    auto nRows = componentTableWidget->rowCount();
-    auto nCols = componentTableWidget->columnCount();
+    if(componentTableModel->rowCount() == 0)
+        return false;
 
-    if(nRows == 0)
+    // Output a new csv which will have the changes that the user makes in the table
+    QString err;
+    if(this->exportComponents(pathToSaveFile, err) != 0)
+    {
+        this->errorMessage(err);
         return false;
+    }
 
+    return true;
+}
 
-    QVector<QStringList> data(nRows+1);
 
-    QStringList headerInfo;
+int ComponentInputWidget::exportComponents(const QString& pathToFile, QString& err)
+{
+    auto headings = componentTableModel->getHeadings();
 
-    for(int i = 0; i<nCols; ++i)
+    bool isEdited = false;
+    for(auto&& it : headings)
     {
-        auto headerText = componentTableWidget->horizontalHeaderItem(i)->data(0).toString();
-        headerInfo << headerText;
+        auto attribute = theComponentDb.getAttributeIndex(it);
+
+        if(attribute != -1 && theComponentDb.isAttributeDirty(attribute))
+        {
+            isEdited = true;
+            break;
+        }
     }
 
-    data[0] = headerInfo;
+    // Copy the input file if none of the exported attributes were edited, writing the file is the fallback if the copy fails
+    // A compressed input file is not copied, the workflow reads the exported file as a plain CSV file
+    QString copyErr;
+    if(!isEdited && this->isComponentFileUnchanged() && !GzipInputDevice::isCompressed(pathToComponentInfoFile) && cloneFile(pathToComponentInfoFile, pathToFile, copyErr) == 0)
+        return 0;
+
+    return this->writeComponents(pathToFile, nullptr, err);
+}
+
 
-    for(int i = 0; i<nRows; ++i)
+int ComponentInputWidget::exportSelectedComponents(const QString& pathToFile, QString& err)
+{
+    const auto& selectedIDs = selectComponentsLineEdit->getSelectedComponentIDs();
+
+    if(selectedIDs.isEmpty())
     {
-        QStringList rowData;
-        rowData.reserve(nCols);
+        err = "No " + componentType.toLower() + " are selected for analysis";
+        return -1;
+    }
 
-        for(int j = 0; j<nCols; ++j)
-        {
-            auto item = componentTableWidget->item(i,j)->data(0).toString();
+    return this->writeComponents(pathToFile, &selectedIDs, err);
+}
 
-            rowData<<item;
-        }
-        data[i+1] = rowData;
+
+bool ComponentInputWidget::isComponentFileUnchanged(void) const
+{
+    QFileInfo fileInfo(pathToComponentInfoFile);
+
+    return componentFileLastModified.isValid() && fileInfo.exists() && fileInfo.lastModified() == componentFileLastModified;
+}
+
+
+int ComponentInputWidget::writeComponents(const QString& pathToFile, const ComponentSelection* selection, QString& err)
+{
+    auto headings = componentTableModel->getHeadings();
+
+    auto numRows = theComponentDb.getNumberOfComponents();
+    auto numCols = headings.size();
+
+    // Only the attributes that are written out decide if a component was edited
+    QVector<int> exportedAttributes;
+    for(auto&& it : headings)
+    {
+        auto attribute = theComponentDb.getAttributeIndex(it);
+
+        if(attribute != -1)
+            exportedAttributes.append(attribute);
     }
 
-    CSVReaderWriter csvTool;
+    // The text of the footprints is not kept in the database, the footprints that were not edited are read from the input file
+    auto footprintColumn = this->getFootprintAttribute().isEmpty() ? -1 : headings.indexOf(this->getFootprintAttribute());
 
-    QString err;
-    csvTool.saveCSVFile(data,pathToSaveFile,err);
+    // The rows of the components that were not edited are copied from the input file as they are, without formatting the values again
+    // The input file is only used if it still holds one row per component with the same headings
+    MappedCSVFile inputFile;
+    QString inputErr;
 
-    if(!err.isEmpty())
-        return false;
+    auto useInputFile = theComponentDb.getNumberOfDirtyRows(exportedAttributes) < numRows;
 
+    auto isInputFileValid = (useInputFile || footprintColumn != -1) && this->isComponentFileUnchanged() &&
+            inputFile.open(pathToComponentInfoFile, inputErr, true) == 0 && inputFile.numRows() == numRows+1 && inputFile.rowStrings(0) == headings;
+
+    if(footprintColumn != -1 && !isInputFileValid)
+    {
+        err = "Error, the footprints are read from the input file " + pathToComponentInfoFile + " which was changed after it was loaded. Please load the file again";
+        return -1;
+    }
 
-    // For testing, creates a csv file of only the selected components
-    //    qDebug()<<"Saving selected components to .csv";
-    //    auto selectedIDs = selectComponentsLineEdit->getSelectedComponentIDs();
+    useInputFile = useInputFile && isInputFileValid;
 
-    //    QVector<QStringList> selectedData(selectedIDs.size()+1);
+    // Stream the components straight into the file
+    CSVWriter csvWriter;
 
-    //    selectedData[0] = headerInfo;
+    if(csvWriter.open(pathToFile, err) != 0)
+        return -1;
 
-    //    int i = 0;
-    //    for(auto&& rowID : selectedIDs)
-    //    {
-    //        QStringList rowData;
-    //        rowData.reserve(nCols);
+    csvWriter.writeRow(headings);
+
+    auto writeComponent = [&](const int row)
+    {
+        if(useInputFile && !theComponentDb.isRowDirty(row, exportedAttributes))
+        {
+            auto inputRow = inputFile.row(row+1);
+
+            csvWriter.writeRawRow(inputFile.data() + inputRow.rowStart(), inputRow.rowEnd() - inputRow.rowStart());
+            return;
+        }
 
-    //        for(int j = 0; j<nCols; ++j)
-    //        {
-    //            auto item = componentTableWidget->item(rowID-1,j)->data(0).toString();
+        for(int j = 0; j<numCols; ++j)
+        {
+            auto value = componentTableModel->getValue(row,j);
 
-    //            rowData<<item;
-    //        }
-    //        selectedData[i+1] = rowData;
+            if(j == footprintColumn && !value.isValid())
+                csvWriter.writeField(inputFile.field(row+1,j));
+            else
+                csvWriter.writeField(ComponentDatabase::toText(value));
+        }
 
-    //        ++i;
-    //    }
+        csvWriter.endRow();
+    };
 
-    //    csvTool.saveCSVFile(selectedData,"/Users/steve/Desktop/Selected.csv",err);
+    if(selection == nullptr)
+    {
+        for(int i = 0; i<numRows; ++i)
+            writeComponent(i);
+    }
+    else
+    {
+        for(auto&& ID : *selection)
+        {
+            auto row = theComponentDb.getRow(ID);
 
-    return true;
+            if(row != -1)
+                writeComponent(row);
+        }
+    }
+
+    return csvWriter.close(err);
 }
 
 
 void ComponentInputWidget::clear(void)
 {
+    // Stop a load that is in progress, the results of the load are discarded
+    componentLoader->cancel();
+    pendingFilterString.clear();
+
+    componentSelectionProxyModel->clearSelection();
+    componentTableModel->clear();
     theComponentDb.clear();
+    componentGeometries.clear();
+    inventoryIDs.clear();
+    componentFileLastModified = QDateTime();
     pathToComponentInfoFile.clear();
     componentFileLineEdit->clear();
     selectComponentsLineEdit->clear();
-    componentTableWidget->clear();
-    componentTableWidget->hide();
+    attributeFilterLineEdit->clear();
+    attributeFilterStatusLabel->clear();
+    componentTableView->hide();
     tableHorizontalHeadings.clear();
+    featureHeadings.clear();
+    featureConstantAttributes.clear();
+
+    // The selected features were owned by the table of the selected layer, which the widgets delete when they are cleared
+    selectedFeaturesForAnalysis.clear();
 }
 
 
@@ -832,56 +1291,59 @@ ComponentDatabase* ComponentInputWidget::getComponentDatabase()
 }
 
 
-void ComponentInputWidget::handleCellChanged(int row, int column)
+void ComponentInputWidget::handleCellChanged(const QModelIndex& topLeft, const QModelIndex& /*bottomRight*/)
 {
+    // The model only changes a single cell at a time, when the user edits it
+    auto row = topLeft.row();
+    auto column = topLeft.column();
+
     // Cannot change the ID, lat, or long
     if(column < 3)
         return;
 
-    auto item = componentTableWidget->item(row,column);
+    // The database and the component feature, if there is one, were already updated by the model
+    // The feature in the selected layer does not depend on a feature in the main layer, which may not exist with a level of detail or with features created on demand
+    auto uid = theComponentDb.getUID(row);
 
-    // Only update when the user selects the cell and changes it, inefficient to update programatically
-    if(!item->isSelected())
+    if(!selectedFeaturesForAnalysis.contains(uid))
         return;
 
-    auto ID = componentTableWidget->item(row,0)->data(0).toInt();
-
-    auto attrib = componentTableWidget->horizontalHeaderItem(column)->data(0).toString();
-
-    auto attribVal = item->data(0);
-
-    theComponentDb.updateComponentAttribute(ID,attrib,attribVal);
+    auto attrib = componentTableModel->getHeadings().at(column);
 
-    auto component = theComponentDb.getComponent(ID);
+    auto attribVal = componentTableModel->getValue(row,column);
 
-    if(!component.isValid())
-        return;
-
-    auto uid = component.UID;
     this->updateSelectedComponentAttribute(uid,attrib,attribVal);
+}
 
+
+Esri::ArcGISRuntime::FeatureCollectionLayer* ComponentInputWidget::getSelectedFeatureLayer(void)
+{
+    return nullptr;
 }
 
 
-Feature* ComponentInputWidget::addFeatureToSelectedLayer(QMap<QString, QVariant>& /*featureAttributes*/, Geometry& /*geom*/)
+Esri::ArcGISRuntime::FeatureCollectionTable* ComponentInputWidget::getSelectedFeatureTable(void)
 {
     return nullptr;
 }
 
 
-int ComponentInputWidget::removeFeatureFromSelectedLayer(Esri::ArcGISRuntime::Feature* /*feat*/)
+QVector<int> ComponentInputWidget::getRowsInView(void) const
 {
-    return -1;
+    QVector<int> rows(theComponentDb.getNumberOfComponents());
+    std::iota(rows.begin(), rows.end(), 0);
+
+    return rows;
 }
 
 
-Esri::ArcGISRuntime::FeatureCollectionLayer* ComponentInputWidget::getSelectedFeatureLayer(void)
+int ComponentInputWidget::updateAggregationLayer(const QString& /*rendererField*/, QString& /*err*/)
 {
-    return nullptr;
+    return 0;
 }
 
 
-void ComponentInputWidget::updateComponentAttribute(const int uid, const QString& attribute, const QVariant& value)
+void ComponentInputWidget::updateComponentAttribute(const qint64 uid, const QString& attribute, const QVariant& value)
 {
     theComponentDb.updateComponentAttribute(uid,attribute,value);
 }
@@ -40,14 +40,24 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 #include "SimCenterAppWidget.h"
 #include "ComponentDatabase.h"
+#include "ComponentSelection.h"
 #include "VisualizationWidget.h"
 
+#include <Geometry.h>
+
 #include <set>
+#include <vector>
 
+#include <QDateTime>
 #include <QString>
 #include <QObject>
+#include <QModelIndex>
 
 class AssetInputDelegate;
+class ComponentLoader;
+class ComponentSelectionProxyModel;
+class ComponentTableModel;
+class QTimer;
 
 namespace Esri
 {
@@ -56,13 +66,16 @@ namespace ArcGISRuntime
 class ClassBreaksRenderer;
 class SimpleRenderer;
 class Feature;
+class FeatureCollectionTable;
+class FeatureTable;
 class Geometry;
 }
 }
 
 class QGroupBox;
 class QLineEdit;
-class QTableWidget;
+class QPushButton;
+class QTableView;
 class QLabel;
 
 class ComponentInputWidget : public  SimCenterAppWidget
@@ -75,26 +88,28 @@ public:
 
     virtual int loadComponentVisualization();
 
-    virtual Esri::ArcGISRuntime::Feature*  addFeatureToSelectedLayer(QMap<QString, QVariant>& featureAttributes, Esri::ArcGISRuntime::Geometry& geom);
-    virtual int removeFeatureFromSelectedLayer(Esri::ArcGISRuntime::Feature* feat);
-
     virtual Esri::ArcGISRuntime::FeatureCollectionLayer* getSelectedFeatureLayer(void);
 
+    // Bins the components into cells again and colors the cells by the given field, e.g., once results were added to the components
+    // Widgets that draw their components in an aggregation layer when zoomed out rebuild the layer here, see ComponentAggregator
+    virtual int updateAggregationLayer(const QString& rendererField, QString& err);
+
     QGroupBox* getComponentsWidget(void);
 
-    QTableWidget *getTableWidget() const;
+    QTableView *getTableView() const;
 
     // Set the filter string and select the components
     void setFilterString(const QString& filter);
     QString getFilterString(void);
 
-    void insertSelectedComponent(const int ComponentID);
+    void insertSelectedComponent(const qint64 ComponentID);
+    void insertSelectedComponents(const std::vector<qint64>& ComponentIDs);
 
     int numberComponentsSelected(void);
 
     ComponentDatabase* getComponentDatabase();
 
-    void updateComponentAttribute(const int ID, const QString& attribute, const QVariant& value);
+    void updateComponentAttribute(const qint64 ID, const QString& attribute, const QVariant& value);
     void updateSelectedComponentAttribute(const QString& uid, const QString& attribute, const QVariant& value);
 
     // Set custom labels in widget
@@ -112,6 +127,13 @@ public:
     bool inputFromJSON(QJsonObject &rvObject);
     bool copyFiles(QString &destName);
 
+    // Writes the components to a CSV file, returns 0 on success
+    // If nothing was edited, the input file is copied as is, otherwise only the edited components are formatted and the other rows are copied from the input file
+    int exportComponents(const QString& pathToFile, QString& err);
+
+    // Writes only the components that are selected for analysis, returns 0 on success
+    int exportSelectedComponents(const QString& pathToFile, QString& err);
+
     QString getPathToComponentFile(void) const;
 
     virtual void clear(void);
@@ -125,7 +147,7 @@ signals:
 
 public slots:
     void handleComponentSelection(void);
-    void handleCellChanged(int row, int column);
+    void handleCellChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight);
 
 private slots:
     void selectComponents(void);
@@ -134,11 +156,70 @@ private slots:
     void clearComponentSelection(void);
     void clearLayerSelectedForAnalysis(void);
 
+    // Selection of the components by an expression over their attributes, see ComponentFilter
+    void handleAttributeFilterChanged(void);
+    void previewAttributeFilter(void);
+    void selectComponentsByAttributes(void);
+
+    // Loading of the file on the worker thread, see ComponentLoader
+    void handleComponentLoadProgress(const QString& stage, const int done, const int total);
+    void handleComponentDataLoaded(const int generation);
+    void handleComponentLoadFailed(const int generation, const QString& err);
+    void handleComponentLoadCancelled(const int generation);
+    void cancelComponentLoad(void);
+
 protected:
     VisualizationWidget* theVisualizationWidget;
-    QTableWidget* componentTableWidget;
+    QTableView* componentTableView;
+    ComponentTableModel* componentTableModel;
+    ComponentSelectionProxyModel* componentSelectionProxyModel;
     ComponentDatabase theComponentDb;
 
+    // Columns of the input file whose values are stored as categories in the database, even if the values are numbers
+    virtual QStringList getCategoricalAttributes(void) const;
+
+    // Column of the input file holding the GeoJSON footprints of the components, empty if the components have no footprints
+    // The footprints are decoded once when the file is loaded, see FootprintStore
+    virtual QString getFootprintAttribute(void) const;
+
+    // Builds the geometry of the component at the given row while the file is loading. Runs on a worker thread, so it must not touch any GUI objects
+    // Sets the error if the geometry cannot be built
+    virtual Esri::ArcGISRuntime::Geometry createComponentGeometry(const ComponentDatabase& database, const int row, QString& err) const;
+
+    // The geometry of each component (row) in the database, kept until the components are cleared so that features can be created on demand
+    // The components with a footprint have an empty geometry here, their geometry is built from the footprint store of the database
+    std::vector<Esri::ArcGISRuntime::Geometry> componentGeometries;
+
+    Esri::ArcGISRuntime::Geometry getComponentGeometry(const int row) const;
+
+    // Builds the feature attributes of the components at the given rows on worker threads, one map per row in the same order as the rows
+    // Each map holds the values of the given columns as text, where the ID column gets the ID, the ID, TabName, and UID of the component, and the constant attributes
+    std::vector<QMap<QString, QVariant>> createFeatureAttributes(const QVector<int>& rows, const QStringList& headings, const QMap<QString, QVariant>& constantAttributes) const;
+
+    // Creates the features of the components at the given rows from their attributes and geometries, and adds them to the table in batches
+    // The features are stored in the database
+    void addComponentFeatures(Esri::ArcGISRuntime::FeatureTable* table, const QVector<int>& rows, const std::vector<QMap<QString, QVariant>>& featureAttributes);
+
+    // Makes sure that the components at the given rows have a feature, widgets that create their features on demand create the missing features here
+    virtual void createFeaturesOnDemand(const QVector<int>& rows);
+
+    // The table of the layer that shows the selected components, nullptr if the widget does not have one
+    virtual Esri::ArcGISRuntime::FeatureCollectionTable* getSelectedFeatureTable(void);
+
+    // Rows of the components that are in view, only these get a feature in the selected layer. By default all of the components are drawn
+    virtual QVector<int> getRowsInView(void) const;
+
+    // Shows the selected components among the given rows in the selected layer, and removes the selected features of the other rows
+    // The selected features are built from the database, so the components do not need a feature of their own
+    void updateSelectedFeatures(const QVector<int>& rows);
+
+    // Removes the features from the table and deletes them once the table no longer holds them
+    void removeFeaturesFromTable(Esri::ArcGISRuntime::FeatureTable* table, const QList<Esri::ArcGISRuntime::Feature*>& features);
+
+    // The attributes given to the component features, the selected features get the same attributes
+    QStringList featureHeadings;
+    QMap<QString, QVariant> featureConstantAttributes;
+
     // Returns a vector of sorted items that are unique
     template <typename T>
     void uniqueVec(std::vector<T>& vec)
@@ -156,6 +237,12 @@ private:
     QString pathToComponentInfoFile;
     QLineEdit* componentFileLineEdit;
     AssetInputDelegate* selectComponentsLineEdit;
+    QPushButton* cancelLoadButton;
+    QLineEdit* attributeFilterLineEdit;
+    QLabel* attributeFilterStatusLabel;
+
+    // Delays the preview of the attribute filter until the user pauses typing
+    QTimer* attributeFilterTimer;
     QLabel* componentInfoText;
     QGroupBox* componentGroupBox;
 
@@ -167,9 +254,26 @@ private:
 
     QStringList tableHorizontalHeadings;
 
+    // All of the IDs in the inventory, the selections are checked against them
+    ComponentSelection inventoryIDs;
+
+    ComponentLoader* componentLoader;
+
+    // Filter that is applied once the file that is loading is loaded
+    QString pendingFilterString;
+
+    // Time the input file was last modified when it was loaded, the rows of the file are only reused on export if the file did not change since
+    QDateTime componentFileLastModified;
+
     void createComponentsBox(void);
 
-    // Map to store the selected features according to their UID
+    // True if the input file is the same as when it was loaded
+    bool isComponentFileUnchanged(void) const;
+
+    // Writes the header and the given components, or all of the components if the selection is null
+    int writeComponents(const QString& pathToFile, const ComponentSelection* selection, QString& err);
+
+    // Map to store the features of the selected components that are in view according to their UID
     QMap<QString, Esri::ArcGISRuntime::Feature*> selectedFeaturesForAnalysis;
 };
 
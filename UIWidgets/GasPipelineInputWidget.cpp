@@ -1,5 +1,7 @@
 #include "GasPipelineInputWidget.h"
+#include "GeometrySimplifier.h"
 
+#include "Envelope.h"
 #include "Field.h"
 #include "GroupLayer.h"
 #include "FeatureCollection.h"
@@ -11,7 +13,9 @@
 #include "SimpleLineSymbol.h"
 #include "PolylineBuilder.h"
 
-#include <QTableWidget>
+#include <QVector>
+
+#include <numeric>
 
 using namespace Esri::ArcGISRuntime;
 
@@ -35,11 +39,12 @@ int GasPipelineInputWidget::loadComponentVisualization()
     fields.append(Field::createText("TabName", "NULL",4));
     fields.append(Field::createText("UID", "NULL",4));
 
+    auto headers = this->getTableHorizontalHeadings();
+
     // Set the table headers as fields in the table
-    for(int i =0; i<componentTableWidget->columnCount(); ++i)
+    for(int i =0; i<headers.size(); ++i)
     {
-        auto headerItem = componentTableWidget->horizontalHeaderItem(i);
-        auto fieldText = headerItem->text();
+        auto fieldText = headers.at(i);
         fields.append(Field::createText(fieldText, fieldText,fieldText.size()));
     }
 
@@ -56,7 +61,8 @@ int GasPipelineInputWidget::loadComponentVisualization()
         return -1;
     }
 
-    auto nRows = componentTableWidget->rowCount();
+    // The pipelines and their attributes were added to the database when the file was loaded
+    auto nRows = theComponentDb.getNumberOfComponents();
 
     // Select a column that will define the layers
     //    int columnToMapLayers = 0;
@@ -82,6 +88,8 @@ int GasPipelineInputWidget::loadComponentVisualization()
     selectedFeaturesLayer->setAutoFetchLegendInfos(true);
     selectedFeaturesTable->setRenderer(this->createSelectedPipelineRenderer(1.5));
 
+    auto useSimplification = nRows > maxPipelinesAtFullDetail;
+
     // Map to hold the feature tables
     std::map<std::string, FeatureCollectionTable*> tablesMap;
     for(auto&& it : vecLayerItems)
@@ -100,128 +108,136 @@ int GasPipelineInputWidget::loadComponentVisualization()
 
         featureCollectionTable->setRenderer(this->createPipelineRenderer());
 
+        // The pipelines are only drawn one by one when zoomed in
+        if(useSimplification)
+            newpipelineLayer->setMinScale(simplificationScale);
+
         tablesMap.insert(std::make_pair(it,featureCollectionTable));
 
         theVisualizationWidget->addLayerToMap(newpipelineLayer,pipelinesItem, pipelineLayer);
     }
 
+    // The feature attributes are the columns from the input file, they are built on worker threads
+    featureHeadings = headers;
 
-    auto headers = this->getTableHorizontalHeadings();
-
-    auto indexLatStart = headers.indexOf("LAT_BEGIN");
-    auto indexLonStart = headers.indexOf("LONG_BEGIN");
-    auto indexLatEnd = headers.indexOf("LAT_END");
-    auto indexLonEnd = headers.indexOf("LONG_END");
-
-    if(indexLatStart == -1 || indexLonStart == -1 || indexLatEnd == -1 || indexLonEnd == -1)
-    {
-        errorMessage("Could not find the required lat./lon. header labels in the input file");
-        return -1;
-    }
-
-    for(int i = 0; i<nRows; ++i)
-    {
-
-        // create the feature attributes
-        QMap<QString, QVariant> featureAttributes;
+    featureConstantAttributes.clear();
+    featureConstantAttributes.insert("RepairRate", 0.0);
+    featureConstantAttributes.insert("AssetType", "GASPIPELINES");
 
-        // Create a new pipeline
-        Component pipeline;
+    // All of the pipelines are in one layer
+    QVector<int> rows(nRows);
+    std::iota(rows.begin(), rows.end(), 0);
 
-        QString pipelineIDStr = componentTableWidget->item(i,0)->data(0).toString();
+    auto featureAttributes = this->createFeatureAttributes(rows, featureHeadings, featureConstantAttributes);
 
-        int pipelineID =  pipelineIDStr.toInt();
+    // The polylines were built while the file was loading
+    this->addComponentFeatures(tablesMap.at("Pipeline Network"), rows, featureAttributes);
 
-        pipeline.ID = pipelineID;
+    if(useSimplification && this->createSimplifiedNetworkLayer(pipelinesItem, pipelineLayer) != 0)
+        return -1;
 
-        QMap<QString, QVariant> pipelineAttributeMap;
+    pipelineLayer->load();
 
-        // The feature attributes are the columns from the table
-        for(int j = 0; j<componentTableWidget->columnCount(); ++j)
-        {
-            auto attrbText = componentTableWidget->horizontalHeaderItem(j)->text();
-            auto attrbVal = componentTableWidget->item(i,j)->data(0);
+    theVisualizationWidget->zoomToLayer(pipelineLayer->layerId());
 
-            pipelineAttributeMap.insert(attrbText,attrbVal.toString());
+    return 0;
+}
 
-            featureAttributes.insert(attrbText,attrbVal);
-        }
 
-        // Create a unique ID for the pipeline
-        auto uid = theVisualizationWidget->createUniqueID();
+Geometry GasPipelineInputWidget::createComponentGeometry(const ComponentDatabase& database, const int row, QString& err) const
+{
+    auto indexLatStart = database.getAttributeIndex("LAT_BEGIN");
+    auto indexLonStart = database.getAttributeIndex("LONG_BEGIN");
+    auto indexLatEnd = database.getAttributeIndex("LAT_END");
+    auto indexLonEnd = database.getAttributeIndex("LONG_END");
 
-        pipeline.ComponentAttributes = pipelineAttributeMap;
+    if(indexLatStart == -1 || indexLonStart == -1 || indexLatEnd == -1 || indexLonEnd == -1)
+    {
+        err = "Could not find the required lat./lon. header labels in the input file";
+        return Geometry();
+    }
 
-        featureAttributes.insert("ID", pipelineIDStr);
-        featureAttributes.insert("RepairRate", 0.0);
-        featureAttributes.insert("AssetType", "GASPIPELINES");
-        featureAttributes.insert("TabName", componentTableWidget->item(i,0)->data(0).toString());
-        featureAttributes.insert("UID", uid);
+    auto latitudeStart = database.getAttributeValue(row, indexLatStart).toDouble();
+    auto longitudeStart = database.getAttributeValue(row, indexLonStart).toDouble();
 
-        // Get the feature collection table from the map
-        //        auto layerTag = pipelineTableWidget->item(i,columnToMapLayers)->data(0).toString().toStdString();
-        auto layerTag = "Pipeline Network";
+    auto latitudeEnd = database.getAttributeValue(row, indexLatEnd).toDouble();
+    auto longitudeEnd = database.getAttributeValue(row, indexLonEnd).toDouble();
 
-        auto featureCollectionTable = tablesMap.at(layerTag);
+    // Create the points and add it to the feature table
+    PolylineBuilder polylineBuilder(SpatialReference::wgs84());
 
-        auto latitudeStart = componentTableWidget->item(i,indexLatStart)->data(0).toDouble();
-        auto longitudeStart = componentTableWidget->item(i,indexLonStart)->data(0).toDouble();
+    // Get the two start and end points of the pipeline segment
 
-        auto latitudeEnd = componentTableWidget->item(i,indexLatEnd)->data(0).toDouble();
-        auto longitudeEnd = componentTableWidget->item(i,indexLonEnd)->data(0).toDouble();
+    Point point1(longitudeStart,latitudeStart);
 
-        // Create the points and add it to the feature table
-        PolylineBuilder polylineBuilder(SpatialReference::wgs84());
+    Point point2(longitudeEnd,latitudeEnd);
 
-        // Get the two start and end points of the pipeline segment
+    polylineBuilder.addPoint(point1);
+    polylineBuilder.addPoint(point2);
 
-        Point point1(longitudeStart,latitudeStart);
+    if(!polylineBuilder.isSketchValid())
+    {
+        err = "Error, cannot create a pipeline feature with the latitude and longitude provided";
+        return Geometry();
+    }
 
-        Point point2(longitudeEnd,latitudeEnd);
+    return polylineBuilder.toPolyline();
+}
 
-        polylineBuilder.addPoint(point1);
-        polylineBuilder.addPoint(point2);
 
-        if(!polylineBuilder.isSketchValid())
-        {
-            this->errorMessage("Error, cannot create a pipeline feature with the latitude and longitude provided");
-            return -1;
-        }
+int GasPipelineInputWidget::createSimplifiedNetworkLayer(LayerTreeItem* parentItem, GroupLayer* parentLayer)
+{
+    auto indexLatStart = theComponentDb.getAttributeIndex("LAT_BEGIN");
+    auto indexLonStart = theComponentDb.getAttributeIndex("LONG_BEGIN");
+    auto indexLatEnd = theComponentDb.getAttributeIndex("LAT_END");
+    auto indexLonEnd = theComponentDb.getAttributeIndex("LONG_END");
 
-        // Create the polyline feature
-        auto polyline =  polylineBuilder.toPolyline();
+    if(indexLatStart == -1 || indexLonStart == -1 || indexLatEnd == -1 || indexLonEnd == -1)
+    {
+        errorMessage("Could not find the required lat./lon. header labels in the input file");
+        return -1;
+    }
 
-        // Add the feature to the table
-        Feature* feature = featureCollectionTable->createFeature(featureAttributes, polyline, this);
+    // The segments are joined into chains between the junctions of the network, so that the chains can be simplified across the segments
+    GeometrySimplifier simplifier;
 
-        pipeline.UID = uid;
-        pipeline.ComponentFeature = feature;
+    auto nRows = theComponentDb.getNumberOfComponents();
+    for(int row = 0; row<nRows; ++row)
+    {
+        auto latitudeStart = theComponentDb.getAttributeValue(row, indexLatStart).toDouble();
+        auto longitudeStart = theComponentDb.getAttributeValue(row, indexLonStart).toDouble();
 
-        theComponentDb.addComponent(pipelineID, pipeline);
+        auto latitudeEnd = theComponentDb.getAttributeValue(row, indexLatEnd).toDouble();
+        auto longitudeEnd = theComponentDb.getAttributeValue(row, indexLonEnd).toDouble();
 
-        featureCollectionTable->addFeature(feature);
+        simplifier.addPath({longitudeStart, latitudeStart, longitudeEnd, latitudeEnd}, false);
     }
 
-    pipelineLayer->load();
+    simplifier.joinPaths();
 
-    theVisualizationWidget->zoomToLayer(pipelineLayer->layerId());
+    auto numChains = simplifier.getNumberOfPaths();
 
-    return 0;
-}
+    // A chain is not a component, so it only gets the attributes needed by the popup
+    QList<Field> fields;
+    fields.append(Field::createText("AssetType", "NULL",4));
+    fields.append(Field::createText("TabName", "NULL",4));
 
+    QMap<QString, QVariant> chainAttributes;
+    chainAttributes.insert("AssetType", "PIPELINE_OVERVIEW");
+    chainAttributes.insert("TabName", "Pipeline Network");
 
-Feature* GasPipelineInputWidget::addFeatureToSelectedLayer(QMap<QString, QVariant>& featureAttributes, Geometry& geom)
-{
-    Feature* feat = selectedFeaturesTable->createFeature(featureAttributes,geom,this);
-    selectedFeaturesTable->addFeature(feat);
+    std::vector<QMap<QString, QVariant>> featureAttributes(numChains, chainAttributes);
 
-    return feat;
-}
+    std::vector<int> featurePaths(numChains+1);
+    std::iota(featurePaths.begin(), featurePaths.end(), 0);
 
+    auto overviewLayer = theVisualizationWidget->createAndAddSimplifiedLayer(simplifier, GeometryType::Polyline, featurePaths, featureAttributes, fields, [this]()
+    {
+        return this->createPipelineRenderer();
+    }, simplificationScale, numSimplificationLevels, "Pipeline Network Overview", parentItem, parentLayer);
 
-int GasPipelineInputWidget::removeFeatureFromSelectedLayer(Esri::ArcGISRuntime::Feature* feat)
-{
-    selectedFeaturesTable->deleteFeature(feat);
+    if(overviewLayer == nullptr)
+        return -1;
 
     return 0;
 }
@@ -233,6 +249,12 @@ Esri::ArcGISRuntime::FeatureCollectionLayer* GasPipelineInputWidget::getSelected
 }
 
 
+Esri::ArcGISRuntime::FeatureCollectionTable* GasPipelineInputWidget::getSelectedFeatureTable(void)
+{
+    return selectedFeaturesTable;
+}
+
+
 void GasPipelineInputWidget::clear()
 {
     delete selectedFeaturesLayer;
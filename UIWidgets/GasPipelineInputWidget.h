@@ -11,6 +11,7 @@ class ClassBreaksRenderer;
 class Renderer;
 class SimpleRenderer;
 class Feature;
+class FeatureCollectionTable;
 class Geometry;
 }
 }
@@ -22,14 +23,25 @@ public:
 
     int loadComponentVisualization();
 
-    Esri::ArcGISRuntime::Feature* addFeatureToSelectedLayer(QMap<QString, QVariant>& featureAttributes, Esri::ArcGISRuntime::Geometry& geom);
-    int removeFeatureFromSelectedLayer(Esri::ArcGISRuntime::Feature* feat);
     Esri::ArcGISRuntime::FeatureCollectionLayer* getSelectedFeatureLayer(void);
 
     void clear();
 
+protected:
+    Esri::ArcGISRuntime::Geometry createComponentGeometry(const ComponentDatabase& database, const int row, QString& err) const;
+
+    Esri::ArcGISRuntime::FeatureCollectionTable* getSelectedFeatureTable(void);
+
 private:
 
+    // Networks with more pipelines than this are drawn as simplified chains of pipelines when zoomed out past the simplification scale, see GeometrySimplifier
+    static const int maxPipelinesAtFullDetail = 20000;
+    static constexpr double simplificationScale = 25000.0;
+    static const int numSimplificationLevels = 4;
+
+    // Adds the simplified chains of pipelines under the pipelines layer
+    int createSimplifiedNetworkLayer(LayerTreeItem* parentItem, Esri::ArcGISRuntime::GroupLayer* parentLayer);
+
     Esri::ArcGISRuntime::Renderer* createPipelineRenderer(void);
     Esri::ArcGISRuntime::Renderer* createSelectedPipelineRenderer(double outlineWidth = 0.0);
 
@@ -36,8 +36,9 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 // Written by: Stevan Gavrilovic
 
-#include "CSVReaderWriter.h"
+#include "CSVTable.h"
 #include "GroundMotionStation.h"
+#include "GzipInputDevice.h"
 
 #include <QFileInfo>
 #include <QString>
@@ -48,6 +49,8 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QJsonArray>
 #include <QFile>
 
+#include <cmath>
+
 GroundMotionStation::GroundMotionStation(QString path, double lat, double lon) : stationFilePath(path), latitude(lat), longitude(lon)
 {
 }
@@ -67,32 +70,55 @@ double GroundMotionStation::getLongitude() const
 
 void GroundMotionStation::importGroundMotions(void)
 {
-    CSVReaderWriter csvTool;
+    CSVTable stationTable;
+
+    // The file names are kept as strings even if they look like numbers
+    stationTable.setColumnType("GM_file", CSVColumn::Text);
 
     QString err;
-    QVector<QStringList> data = csvTool.parseCSVFile(stationFilePath,err);
+    auto res = stationTable.load(stationFilePath, err);
 
     // Return if there is an error or the data is empty
-    if(!err.isEmpty())
+    if(res != 0)
         throw err;
 
-    if(data.size() < 2)
+    if(stationTable.numRows() < 1)
         throw "The file " + stationFilePath + " is empty";
 
     // Get the header file
-    QStringList tableHeadings = data.first();
+    QStringList tableHeadings = stationTable.getHeaders();
 
-    // Pop off the row that contains the header information
-    data.pop_front();
-
-    auto numRows = data.size();
-    auto numCols = tableHeadings.size();
+    auto numRows = stationTable.numRows();
+    auto numCols = stationTable.numColumns();
 
     if(tableHeadings.at(0).compare("GM_file") == 0)
     {
         if(numCols != 2)
             throw "The number of columns in the header should be 2";
 
+        const auto& GMFiles = stationTable.column(0);
+        const auto& factors = stationTable.column(1);
+
+        // A column with a value that is not a number is loaded as text, find the value to give its row in the error
+        if(!factors.isNumeric())
+        {
+            for(int i = 0; i<numRows; ++i)
+            {
+                auto value = factors.toString(i).trimmed();
+
+                if(value.isEmpty())
+                    continue;
+
+                bool ok = false;
+                value.toDouble(&ok);
+
+                if(!ok)
+                    throw "Error converting the string " + value + " in row " + QString::number(i+2) + ", column " + factors.getName() + " to a double";
+            }
+
+            throw "Error converting the column " + factors.getName() + " to a double";
+        }
+
         QFileInfo stationInfo(stationFilePath);
 
         auto baseDir = stationInfo.dir().absolutePath();
@@ -100,18 +126,12 @@ void GroundMotionStation::importGroundMotions(void)
         // Get the data
         for(int i = 0; i<numRows; ++i)
         {
-            auto rowStringList = data[i];
-
-            if(rowStringList.size() != numCols)
-                throw "The number of columns in the row " + QString::number(i) + " should be " + QString::number(numCols);
+            auto GMFile = GMFiles.toString(i);
 
-            auto GMFile = rowStringList[0];
+            auto factor = factors.toDouble(i);
 
-            bool ok;
-            auto factor = rowStringList[1].toDouble(&ok);
-
-            if(!ok)
-                throw "Error converting the string " + rowStringList[1] + " to a double";
+            if(std::isnan(factor))
+                throw "Missing the scaling factor in row " + QString::number(i+2) + ", column " + factors.getName();
 
             auto GMFilePath = baseDir + QDir::separator() + GMFile + ".json";
 
@@ -124,20 +144,16 @@ void GroundMotionStation::importGroundMotions(void)
 
 void GroundMotionStation::importGroundMotionTimeHistory(const QString& filePath,const double scalingFactor)
 {
-    QFile file(filePath);
-    if (!file.open(QFile::ReadOnly | QFile::Text))
-        throw "Could not open the file at: "+ filePath;
+    // place contents of file into json object, the file is inflated if it is compressed
+    QString err;
+    auto fileData = GzipInputDevice::readFile(filePath, err);
 
+    if(!err.isEmpty())
+        throw "Could not open the file at: "+ filePath;
 
-    // place contents of file into json object
-    QString val;
-    val=file.readAll();
-    QJsonDocument doc = QJsonDocument::fromJson(val.toUtf8());
+    QJsonDocument doc = QJsonDocument::fromJson(fileData);
     QJsonObject jsonObj = doc.object();
 
-    // close file
-    file.close();
-
     // Get the name
     auto gmNameObj = jsonObj.value("name");
 
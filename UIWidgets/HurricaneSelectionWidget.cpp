@@ -71,6 +71,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QGroupBox>
 #include <QLabel>
 #include <QLineEdit>
+#include <QLocale>
 #include <QProgressBar>
 #include <QPushButton>
 #include <QSpinBox>
@@ -578,8 +579,13 @@ void HurricaneSelectionWidget::setCurrentlyViewable(bool status){
 void HurricaneSelectionWidget::loadHurricaneButtonClicked(void)
 {
 
-    auto pathToHurricaneDb = QCoreApplication::applicationDirPath() +
-            QDir::separator() + "Databases" + QDir::separator() + "ibtracs.last3years.list.v04r00.csv";
+    auto pathToDbDir = QCoreApplication::applicationDirPath() + QDir::separator() + "Databases" + QDir::separator();
+
+    // Use the full IBTrACS history if it is available, the file is streamed so its size is not an issue
+    auto pathToHurricaneDb = pathToDbDir + "ibtracs.ALL.list.v04r00.csv";
+
+    if(!QFile::exists(pathToHurricaneDb))
+        pathToHurricaneDb = pathToDbDir + "ibtracs.last3years.list.v04r00.csv";
 
     QFile file(pathToHurricaneDb);
 
@@ -756,7 +762,7 @@ void HurricaneSelectionWidget::createHurricaneVisuals(HurricaneObject* hurricane
     // Landfall
     if(!landfallData.empty())
     {
-        auto lfParams = hurricane->parameterLabels;
+        auto lfParams = hurricane->landfallLabels;
 
         QMap<QString, QVariant> featureAttributes;
         for(int i = 0; i < landfallData.size(); ++i)
@@ -1130,7 +1136,7 @@ void HurricaneSelectionWidget::runHazardSimulation(void)
 
     for(auto&& it : fullTrackData)
     {
-        QStringList latLonVals = {it.at(indexLat),it.at(indexLon)};
+        QStringList latLonVals = {QString::number(it.at(indexLat), 'g', QLocale::FloatingPointShortest),QString::number(it.at(indexLon), 'g', QLocale::FloatingPointShortest)};
 
         trackData.push_back(latLonVals);
     }
@@ -1665,9 +1671,10 @@ void HurricaneSelectionWidget::handleAreaSelected(void)
 
     HurricaneObject newHurricaneObj = selectedHurricaneObj;
 
-    QVector<QStringList>& hurricaneData = newHurricaneObj.getHurricaneData();
+    newHurricaneObj.getHurricaneData().clear();
+    newHurricaneObj.trackPointRows.clear();
 
-    hurricaneData.clear();
+    const bool hasRows = selectedHurricaneObj.hasTrackPointRows();
 
     // Save only the features that are track points
     QList<Feature*> featureList;
@@ -1702,15 +1709,19 @@ void HurricaneSelectionWidget::handleAreaSelected(void)
         auto lat = artbMap.value("LAT").toDouble();
         auto lon = artbMap.value("LON").toDouble();
 
-        QStringList trackPoint = selectedHurricaneObj.trackPointAtLatLon(lat,lon);
+        auto index = selectedHurricaneObj.trackPointIndexAtLatLon(lat,lon);
 
-        if(trackPoint.isEmpty())
+        if(index == -1)
         {
             this->errorMessage("Could not get the track point");
             return;
         }
 
-        hurricaneData.push_back(trackPoint);
+        // Keep the rows of the data file so that the new track points still have all of the columns
+        if(hasRows)
+            newHurricaneObj.push_back(selectedHurricaneObj[index], selectedHurricaneObj.trackPointRows.at(index));
+        else
+            newHurricaneObj.push_back(selectedHurricaneObj[index]);
     }
 
     // Delete the old hurricane layer
@@ -316,7 +316,7 @@ void ResultsWidget::handleComponentSelection(void)
     {
         if(DVApp.compare("Pelicun") == 0)
         {
-            auto IDSet = selectComponentsLineEdit->getSelectedComponentIDs();
+            const auto& IDSet = selectComponentsLineEdit->getSelectedComponentIDs();
             thePelicunPostProcessor->processResultsSubset(IDSet);
         }
 
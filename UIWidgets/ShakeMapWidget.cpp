@@ -57,6 +57,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "LayerTreeView.h"
 #include "LayerListModel.h"
 #include "SimpleRenderer.h"
+#include "UniqueValueRenderer.h"
 
 #include <QDirIterator>
 #include <QApplication>
@@ -438,15 +439,26 @@ int ShakeMapWidget::loadDataFromDirectory(const QString& dir)
                 // Get the renderer
                 Renderer* tableRenderer = table->renderer();
 
-                auto simpleRenderer = dynamic_cast<SimpleRenderer*>(tableRenderer);
-
-                if(simpleRenderer == nullptr)
-                    continue;
-
-                auto labelVal = simpleRenderer->label();
-
-                QString labelStr = "PGA (%g) " + labelVal;
-                simpleRenderer->setLabel(labelStr);
+                if(auto simpleRenderer = dynamic_cast<SimpleRenderer*>(tableRenderer))
+                {
+                    auto labelVal = simpleRenderer->label();
+
+                    QString labelStr = "PGA (%g) " + labelVal;
+                    simpleRenderer->setLabel(labelStr);
+                }
+                else if(auto uniqueValueRenderer = dynamic_cast<UniqueValueRenderer*>(tableRenderer))
+                {
+                    // The contours of all of the levels are in one table, each level is a unique value
+                    auto uniqueValues = uniqueValueRenderer->uniqueValues();
+
+                    for(int j = 0; j<uniqueValues->size(); ++j)
+                    {
+                        auto uniqueValue = uniqueValues->at(j);
+
+                        QString labelStr = "PGA (%g) " + uniqueValue->label();
+                        uniqueValue->setLabel(labelStr);
+                    }
+                }
             }
 
             inputShakeMap->pgaContourLayer = layer;
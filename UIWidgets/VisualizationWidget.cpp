@@ -43,9 +43,12 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "LayerTreeView.h"
 #include "LayerTreeModel.h"
 #include "VisualizationWidget.h"
+#include "ComponentAggregator.h"
 #include "ConvexHull.h"
 #include "PolygonBoundary.h"
 #include "LayerManagerDialog.h"
+#include "GeoJSONReader.h"
+#include "GeometrySimplifier.h"
 
 // GIS headers
 #include "ArcGISMapImageLayer.h"
@@ -81,6 +84,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "SimpleMarkerSymbol.h"
 #include "SimpleRenderer.h"
 #include "TransformationCatalog.h"
+#include "UniqueValueRenderer.h"
 #include "sectiontitle.h"
 // Convex Hull
 #include "GeometryEngine.h"
@@ -93,6 +97,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QFileInfo>
 #include <QJsonDocument>
 #include <QJsonArray>
+#include <QJsonObject>
 #include <QGridLayout>
 #include <QGroupBox>
 #include <QToolButton>
@@ -106,7 +111,10 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QTreeView>
 #include <QListView>
 #include <QUrl>
+#include <QtConcurrent/QtConcurrentMap>
 
+#include <algorithm>
+#include <cmath>
 #include <utility>
 
 using namespace Esri::ArcGISRuntime;
@@ -288,6 +296,14 @@ void VisualizationWidget::createVisualizationWidget(void)
     topText->setText("Enclose an area with points\nto select a subset of\nassets to analyze");
     topText->setStyleSheet("font-weight: bold; color: black; text-align: center");
 
+    // A rectangle is the extent of the points, a radius is centered on the first point and passes through the last point
+    selectionShapeCombo = new QComboBox();
+    selectionShapeCombo->addItem("Polygon");
+    selectionShapeCombo->addItem("Convex Hull");
+    selectionShapeCombo->addItem("Rectangle");
+    selectionShapeCombo->addItem("Radius");
+    selectionShapeCombo->setMaximumWidth(150);
+
     QPushButton *selectPointsButton = new QPushButton();
     selectPointsButton->setText(tr("Select Points"));
     selectPointsButton->setMaximumWidth(150);
@@ -306,7 +322,8 @@ void VisualizationWidget::createVisualizationWidget(void)
 
     connect(selectPointsButton,&QPushButton::clicked,this,&VisualizationWidget::handleSelectAreaMap);
     connect(clearButton,&QPushButton::clicked,this,&VisualizationWidget::handleClearSelectAreaMap);
-    connect(applyButton,SIGNAL(clicked()),thePolygonBoundaryTool.get(),SLOT(getItemsInPolygonBoundary()));
+    connect(applyButton,&QPushButton::clicked,this,&VisualizationWidget::handleApplySelectAreaMap);
+    connect(selectionShapeCombo,QOverload<int>::of(&QComboBox::currentIndexChanged),this,&VisualizationWidget::handleClearSelectAreaMap);
 
 
     // Add a vertical spacer at the bottom to push everything up
@@ -318,11 +335,12 @@ void VisualizationWidget::createVisualizationWidget(void)
     leftHandLayout->addItem(smallVSpacer,3,0);
     leftHandLayout->addWidget(layersTree,4,0);
     leftHandLayout->addWidget(topText,5,0);
-    leftHandLayout->addWidget(selectPointsButton,6,0);
-    leftHandLayout->addWidget(clearButton,7,0);
-    leftHandLayout->addWidget(bottomText,8,0);
-    leftHandLayout->addWidget(applyButton,9,0);
-    leftHandLayout->addItem(vspacer,10,0);
+    leftHandLayout->addWidget(selectionShapeCombo,6,0);
+    leftHandLayout->addWidget(selectPointsButton,7,0);
+    leftHandLayout->addWidget(clearButton,8,0);
+    leftHandLayout->addWidget(bottomText,9,0);
+    leftHandLayout->addWidget(applyButton,10,0);
+    leftHandLayout->addItem(vspacer,11,0);
 
     QWidget* subWidget = new QWidget(this);
     subWidget->setContentsMargins(0,0,0,0);
@@ -537,6 +555,243 @@ void VisualizationWidget::handlePlotColorChange(const QString& layerID)
 }
 
 
+GroupLayer* VisualizationWidget::createAndAddAggregationLayer(const ComponentAggregator& aggregator, const double minScale, const int numLevels, const QString& rendererField, const QString& layerName, LayerTreeItem* parentItem, GroupLayer* parentLayer)
+{
+    auto fieldNames = aggregator.getFieldNames();
+
+    auto rendererIndex = fieldNames.indexOf(rendererField);
+
+    if(rendererIndex == -1)
+    {
+        this->errorMessage("Could not find the field " + rendererField + " in the aggregation layer " + layerName);
+        return nullptr;
+    }
+
+    auto aggregationLayer = new GroupLayer(QList<Layer*>{},this);
+    aggregationLayer->setName(layerName);
+
+    auto aggregationItem = this->addLayerToMap(aggregationLayer, parentItem, parentLayer);
+
+    if(aggregationItem == nullptr)
+    {
+        this->errorMessage("Error adding the aggregation layer " + layerName + " to the map");
+        return nullptr;
+    }
+
+    QList<Field> fields;
+    fields.append(Field::createText("AssetType", "NULL",4));
+    fields.append(Field::createText("TabName", "NULL",4));
+
+    for(auto&& fieldName : fieldNames)
+        fields.append(Field::createDouble(fieldName, fieldName));
+
+    // Meters per pixel at a scale of one, for a screen of 96 dots per inch
+    const double metersPerPixel = 0.0254/96.0;
+    const double cellPixels = 24.0;
+
+    for(int level = 0; level<numLevels; ++level)
+    {
+        auto levelScale = minScale*std::pow(4.0, level);
+
+        // Sized for the middle of the range of scales of the level
+        auto cellSize = cellPixels*metersPerPixel*2.0*levelScale;
+
+        auto cells = aggregator.aggregate(cellSize);
+
+        auto levelName = QString::number(cellSize/1000.0, 'g', 3) + " km cells";
+
+        auto featureCollectionTable = new FeatureCollectionTable(fields, GeometryType::Polygon, SpatialReference::webMercator(),this);
+
+        std::vector<double> rendererValues;
+        rendererValues.reserve(cells.size());
+
+        QList<Feature*> features;
+        features.reserve(static_cast<int>(cells.size()));
+
+        for(auto&& cell : cells)
+        {
+            PolygonBuilder polygonBuilder(SpatialReference::webMercator());
+
+            for(auto&& corner : aggregator.getCellCorners(cell, cellSize))
+                polygonBuilder.addPoint(corner.x(), corner.y());
+
+            QMap<QString, QVariant> featureAttributes;
+            featureAttributes.insert("AssetType", "AGGREGATION");
+            featureAttributes.insert("TabName", layerName);
+
+            for(int k = 0; k<fieldNames.size(); ++k)
+                featureAttributes.insert(fieldNames.at(k), cell.values[k]);
+
+            rendererValues.push_back(cell.values[rendererIndex]);
+
+            features.append(featureCollectionTable->createFeature(featureAttributes, polygonBuilder.toGeometry(), this));
+        }
+
+        featureCollectionTable->addFeatures(features);
+
+        featureCollectionTable->setRenderer(this->createAggregationRenderer(rendererField, rendererValues));
+
+        auto featureCollection = new FeatureCollection(this);
+        featureCollection->tables()->append(featureCollectionTable);
+
+        auto levelLayer = new FeatureCollectionLayer(featureCollection,this);
+        levelLayer->setName(levelName);
+        levelLayer->setAutoFetchLegendInfos(true);
+
+        // The minimum scale is the most zoomed out scale at which the layer is shown
+        levelLayer->setMaxScale(levelScale);
+
+        if(level < numLevels-1)
+            levelLayer->setMinScale(4.0*levelScale);
+
+        this->addLayerToMap(levelLayer, aggregationItem, aggregationLayer);
+    }
+
+    return aggregationLayer;
+}
+
+
+GroupLayer* VisualizationWidget::createAndAddSimplifiedLayer(GeometrySimplifier& simplifier, const GeometryType geometryType, const std::vector<int>& featurePaths, const std::vector<QMap<QString, QVariant>>& featureAttributes, const QList<Field>& fields, const std::function<Renderer*(void)>& createRenderer, const double detailScale, const int numLevels, const QString& layerName, LayerTreeItem* parentItem, GroupLayer* parentLayer)
+{
+    auto numFeatures = static_cast<int>(featurePaths.size()) - 1;
+
+    if(numFeatures <= 0 || featureAttributes.size() != static_cast<size_t>(numFeatures))
+    {
+        this->errorMessage("The features and their attributes do not match in the simplified layer " + layerName);
+        return nullptr;
+    }
+
+    // Meters per pixel at a scale of one, for a screen of 96 dots per inch
+    const double metersPerPixel = 0.0254/96.0;
+    const double tolerancePixels = 0.5;
+
+    std::vector<double> tolerances;
+    for(int level = 0; level<numLevels; ++level)
+        tolerances.push_back(tolerancePixels*metersPerPixel*detailScale*std::pow(4.0, level));
+
+    simplifier.computeLevels(tolerances);
+
+    auto simplifiedLayer = new GroupLayer(QList<Layer*>{},this);
+    simplifiedLayer->setName(layerName);
+
+    auto simplifiedItem = this->addLayerToMap(simplifiedLayer, parentItem, parentLayer);
+
+    if(simplifiedItem == nullptr)
+    {
+        this->errorMessage("Error adding the simplified layer " + layerName + " to the map");
+        return nullptr;
+    }
+
+    // The geometries of a level are built on worker threads in chunks
+    const int chunkSize = 4096;
+
+    std::vector<int> chunkStarts;
+    for(int start = 0; start<numFeatures; start += chunkSize)
+        chunkStarts.push_back(start);
+
+    for(int level = 0; level<numLevels; ++level)
+    {
+        auto levelScale = detailScale*std::pow(4.0, level);
+
+        std::vector<Geometry> geometries(numFeatures);
+
+        QtConcurrent::blockingMap(chunkStarts, [&](const int chunkStart)
+        {
+            for(int i = chunkStart; i<std::min(chunkStart + chunkSize, numFeatures); ++i)
+            {
+                std::vector<std::vector<double>> paths;
+
+                for(int path = featurePaths[i]; path<featurePaths[i+1]; ++path)
+                {
+                    auto coordinates = simplifier.getPath(level, path);
+
+                    if(!coordinates.empty())
+                        paths.push_back(std::move(coordinates));
+                }
+
+                geometries[i] = getGeometryFromPaths(paths, geometryType);
+            }
+        });
+
+        auto featureCollectionTable = new FeatureCollectionTable(fields, geometryType, SpatialReference::wgs84(),this);
+
+        QList<Feature*> features;
+        features.reserve(numFeatures);
+
+        for(int i = 0; i<numFeatures; ++i)
+        {
+            if(geometries[i].isEmpty())
+                continue;
+
+            features.append(featureCollectionTable->createFeature(featureAttributes[i], geometries[i], this));
+        }
+
+        featureCollectionTable->addFeatures(features);
+
+        featureCollectionTable->setRenderer(createRenderer());
+
+        auto featureCollection = new FeatureCollection(this);
+        featureCollection->tables()->append(featureCollectionTable);
+
+        auto levelLayer = new FeatureCollectionLayer(featureCollection,this);
+        levelLayer->setName(QString::number(tolerances[level], 'g', 3) + " m tolerance");
+        levelLayer->setAutoFetchLegendInfos(true);
+
+        // The minimum scale is the most zoomed out scale at which the layer is shown
+        levelLayer->setMaxScale(levelScale);
+
+        if(level < numLevels-1)
+            levelLayer->setMinScale(4.0*levelScale);
+
+        this->addLayerToMap(levelLayer, simplifiedItem, simplifiedLayer);
+    }
+
+    return simplifiedLayer;
+}
+
+
+ClassBreaksRenderer* VisualizationWidget::createAggregationRenderer(const QString& field, std::vector<double> values)
+{
+    values.erase(std::remove_if(values.begin(), values.end(), [](const double value){ return std::isnan(value); }), values.end());
+
+    std::sort(values.begin(), values.end());
+
+    QList<QColor> colors{QColor(255,255,178,180), QColor(254,204,92,180), QColor(253,141,60,180), QColor(240,59,32,180), QColor(189,0,38,180)};
+
+    auto outlineSymbol = new SimpleLineSymbol(SimpleLineSymbolStyle::Solid, QColor(99, 99, 99, 120), 0.5, this);
+
+    QList<ClassBreak*> classBreaks;
+
+    double classMin = values.empty() ? 0.0 : values.front();
+
+    for(int k = 0; k<colors.size(); ++k)
+    {
+        // Repeated values can make the quantiles collapse, such breaks are left out
+        double classMax = values.empty() ? 0.0 : values[std::min(values.size()-1, static_cast<size_t>(k+1)*values.size()/static_cast<size_t>(colors.size()))];
+
+        if(k == colors.size()-1 && !values.empty())
+            classMax = values.back();
+
+        if(classMax <= classMin && !classBreaks.isEmpty())
+            continue;
+
+        auto label = QString::number(classMin, 'g', 3) + " - " + QString::number(classMax, 'g', 3);
+
+        auto symbol = new SimpleFillSymbol(SimpleFillSymbolStyle::Solid, colors.at(k), this);
+        symbol->setOutline(outlineSymbol);
+
+        // The first break starts just below the smallest value so that the smallest value is included
+        auto breakMin = classBreaks.isEmpty() ? classMin - 1.0e-9*std::max(1.0, std::abs(classMin)) : classMin;
+
+        classBreaks.append(new ClassBreak(label, field + " between " + label, breakMin, classMax, symbol, this));
+
+        classMin = classMax;
+    }
+
+    return new ClassBreaksRenderer(field, classBreaks, this);
+}
+
+
 Esri::ArcGISRuntime::Layer* VisualizationWidget::getLayer(const QString& layerID)
 {
     auto layers = mapGIS->operationalLayers();
@@ -620,53 +875,83 @@ void VisualizationWidget::handleArcGISError(Esri::ArcGISRuntime::Error error)
 
 void VisualizationWidget::handleSelectAreaMap(void)
 {
-    connect(this, &VisualizationWidget::taskSelectionComplete, this, &VisualizationWidget::handleSelectFeaturesForAnalysis);
-    thePolygonBoundaryTool->getPolygonBoundaryInputs();
+    // Stop any selection that is in progress with the other tool
+    this->handleClearSelectAreaMap();
+
+    selectingComponentsInArea = true;
+
+    auto shape = selectionShapeCombo->currentText();
+
+    if(shape == "Polygon")
+    {
+        thePolygonBoundaryTool->getPolygonBoundaryInputs();
+        return;
+    }
+
+    if(shape == "Rectangle")
+        theConvexHullTool->setSelectionShape(ConvexHull::Rectangle);
+    else if(shape == "Radius")
+        theConvexHullTool->setSelectionShape(ConvexHull::Radius);
+    else
+        theConvexHullTool->setSelectionShape(ConvexHull::Hull);
+
+    theConvexHullTool->getConvexHullInputs();
 }
 
 
 void VisualizationWidget::handleClearSelectAreaMap(void)
 {
     thePolygonBoundaryTool->resetPolygonBoundary();
-    disconnect(this, &VisualizationWidget::taskSelectionComplete, this, &VisualizationWidget::handleSelectFeaturesForAnalysis);
+    theConvexHullTool->resetConvexHull();
+    selectingComponentsInArea = false;
 }
 
 
-void VisualizationWidget::handleSelectFeaturesForAnalysis(void)
+void VisualizationWidget::handleApplySelectAreaMap(void)
 {
+    if(selectionShapeCombo->currentText() == "Polygon")
+        thePolygonBoundaryTool->getItemsInPolygonBoundary();
+    else
+        theConvexHullTool->getItemsInConvexHull();
+}
 
-    for(auto&& it : featuresFromQueryList)
-    {
-        FeatureIterator iter = it->iterator();
-        while (iter.hasNext())
-        {
-            Feature* feature = iter.next();
-
-            auto atrbList = feature->attributes();
 
-            auto artbMap = atrbList->attributesMap();
+bool VisualizationWidget::selectComponentsInPolygon(const QVector<QPointF>& polygon)
+{
+    return this->selectComponents([&](const ComponentDatabase* database)
+    {
+        return database->getIDsInPolygon(polygon);
+    });
+}
 
-            auto assetID = artbMap.value("ID").toInt();
 
-            auto assetType = artbMap.value("AssetType").toString();
+bool VisualizationWidget::selectComponentsInEnvelope(const RTreeEnvelope& envelope)
+{
+    return this->selectComponents([&](const ComponentDatabase* database)
+    {
+        return database->getIDsInEnvelope(envelope);
+    });
+}
 
-            auto componentWidget = componentWidgetsMap.value(assetType,nullptr);
 
-            if(componentWidget)
-                componentWidget->insertSelectedComponent(assetID);
-        }
-    }
+bool VisualizationWidget::selectComponents(const std::function<std::vector<qint64>(const ComponentDatabase*)>& query)
+{
+    if(!selectingComponentsInArea)
+        return false;
 
-    for(auto&& it :componentWidgetsMap)
-        it->handleComponentSelection();
+    selectingComponentsInArea = false;
 
-    // Delete the raw results and clear the selection list
-    qDeleteAll(featuresFromQueryList);
+    // The selection is resolved synchronously from the spatial index of each asset database instead of querying the feature tables
+    for(auto&& it : componentWidgetsMap)
+    {
+        auto componentIDs = query(it->getComponentDatabase());
 
-    featuresFromQueryList.clear();
+        it->insertSelectedComponents(componentIDs);
 
-    disconnect(this, &VisualizationWidget::taskSelectionComplete, this, &VisualizationWidget::handleSelectFeaturesForAnalysis);
+        it->handleComponentSelection();
+    }
 
+    return true;
 }
 
 
@@ -791,7 +1076,7 @@ void VisualizationWidget::identifyLayersCompleted(QUuid taskID, const QList<Iden
 
         for(auto&& atrb : listOfAttributes)
         {
-            if(QString::compare(atrb,"ObjectID") == 0 || QString::compare(atrb,"AssetType") == 0 || QString::compare(atrb,"TabName") == 0)
+            if(QString::compare(atrb,"ObjectID") == 0 || QString::compare(atrb,"AssetType") == 0 || QString::compare(atrb,"TabName") == 0 || QString::compare(atrb,"StyleID") == 0)
                 continue;
 
             auto atrbVal = elemAttrib->attributeValue(atrb).toString();
@@ -852,7 +1137,7 @@ void VisualizationWidget::identifyLayersCompleted(QUuid taskID, const QList<Iden
 void VisualizationWidget::onMouseClicked(QMouseEvent& mouseEvent)
 {
     // Do not show popups if the map is not loaded, or if selecting objects with an convex hull
-    if (mapGIS->loadStatus() != LoadStatus::Loaded || thePolygonBoundaryTool->getSelectingPoints() == true)
+    if (mapGIS->loadStatus() != LoadStatus::Loaded || thePolygonBoundaryTool->getSelectingPoints() == true || theConvexHullTool->getSelectingPoints() == true)
         return;
 
     constexpr double tolerance = 12;
@@ -1265,64 +1550,273 @@ FeatureLayer* VisualizationWidget::createAndAddShapefileLayer(const QString& fil
 
 Esri::ArcGISRuntime::FeatureCollectionLayer* VisualizationWidget::createAndAddJsonLayer(const QString& filePath, const QString& layerName, LayerTreeItem* parentItem, QColor color)
 {
-    QFile file(filePath);
+    // The features are streamed out of the file, the file is inflated if it is compressed
+    GeoJSONReader reader;
 
-    // Check if something at that path exists and cheack that it really is a file and not a directory
-    if (!file.open(QFile::ReadOnly | QFile::Text))
+    QString err;
+    if(reader.open(filePath, err) != 0)
     {
-        QString msg = QString("Cannot open the file:") + filePath;
-        this->errorMessage(msg);
+        this->errorMessage(err);
         return nullptr;
     }
 
-    // Place contents of file into json object
-    QString val;
-    val=file.readAll();
-    QJsonDocument doc = QJsonDocument::fromJson(val.toUtf8());
-    QJsonObject jsonObj = doc.object();
+    // The style of a feature is given by its color, weight, and value properties
+    struct JsonStyle
+    {
+        QString color;
+        double weight;
+        QString label;
+    };
+
+    // The features are grouped by the type of their geometry, each group goes into one table
+    struct FeatureGroup
+    {
+        QList<Geometry> geometries;
+        QList<QVariantMap> properties;
+        QList<int> styleIDs;
+
+        QList<JsonStyle> styles;
+        QHash<QString, int> styleIndex;
+
+        // The fields of the group, a field is numeric unless one of its values is not a number
+        QMap<QString, bool> numericFields;
 
-    // Extract the features
-    auto featureArray = jsonObj["features"].toArray();
+        // The paths of the lines and polygons, feature i is made of the paths featurePaths[i] to featurePaths[i+1]
+        GeometrySimplifier simplifier;
+        std::vector<int> featurePaths = {0};
+    };
+
+    QMap<GeometryType, FeatureGroup> featureGroups;
+
+    const QStringList reservedFields = {"AssetType", "TabName", "StyleID"};
+
+    // The features are read in batches, and the features of a batch are parsed on worker threads in chunks. Each chunk keeps the first error it finds
+    const int batchSize = 16384;
+    const int chunkSize = 1024;
+
+    struct Chunk
+    {
+        int start;
+        int end;
+        QString err;
+    };
+
+    QList<QByteArray> featureTexts;
+    std::vector<GeoJSONFeature> features;
+
+    while(true)
+    {
+        auto numRead = reader.readFeatures(batchSize, featureTexts, err);
+
+        if(numRead < 0)
+        {
+            this->errorMessage(err);
+            return nullptr;
+        }
+
+        if(numRead == 0)
+            break;
+
+        features.clear();
+        features.resize(numRead);
+
+        std::vector<Chunk> chunks;
+        for(int start = 0; start<numRead; start += chunkSize)
+            chunks.push_back(Chunk{start, std::min(start + chunkSize, numRead), QString()});
+
+        QtConcurrent::blockingMap(chunks, [&](Chunk& chunk)
+        {
+            for(int i = chunk.start; i<chunk.end; ++i)
+            {
+                if(GeoJSONReader::parseFeature(featureTexts.at(i), features[i], chunk.err) != 0)
+                    return;
+            }
+        });
+
+        for(auto&& chunk : chunks)
+        {
+            if(!chunk.err.isEmpty())
+            {
+                this->errorMessage(chunk.err + " in " + filePath);
+                return nullptr;
+            }
+        }
+
+        for(auto&& feature : features)
+        {
+            auto& group = featureGroups[feature.geometryType];
+
+            const auto& properties = feature.properties;
+
+            bool weightOk = false;
+            auto weight = properties.value("weight").toDouble(&weightOk);
+
+            JsonStyle style{properties.value("color").toString(), weightOk ? weight : 3.0, properties.value("value").toString()};
+
+            auto styleKey = style.color + "|" + QString::number(style.weight) + "|" + style.label;
+
+            auto styleIt = group.styleIndex.find(styleKey);
+            if(styleIt == group.styleIndex.end())
+            {
+                styleIt = group.styleIndex.insert(styleKey, group.styles.size());
+                group.styles.append(style);
+            }
+
+            for(auto it = properties.cbegin(); it != properties.cend(); ++it)
+            {
+                if(reservedFields.contains(it.key()))
+                    continue;
+
+                auto fieldIt = group.numericFields.find(it.key());
+                if(fieldIt == group.numericFields.end())
+                    fieldIt = group.numericFields.insert(it.key(), true);
+
+                auto type = it.value().type();
+                if(!it.value().isNull() && type != QVariant::Double && type != QVariant::Int && type != QVariant::LongLong)
+                    fieldIt.value() = false;
+            }
 
-    auto numFeat = featureArray.size();
+            group.geometries.append(feature.geometry);
+            group.properties.append(properties);
+            group.styleIDs.append(styleIt.value());
 
-    if(numFeat == 0)
+            for(auto&& part : feature.parts)
+                group.simplifier.addPath(part, feature.geometryType == GeometryType::Polygon);
+
+            group.featurePaths.push_back(group.simplifier.getNumberOfPaths());
+        }
+    }
+
+    if(featureGroups.isEmpty())
     {
-        QString msg = "Could find any features in: " + filePath;
+        QString msg = "Could not find any features in: " + filePath;
         this->errorMessage(msg);
         return nullptr;
     }
 
+    // Large layers of lines and polygons are drawn simplified when zoomed out, layers that also have points are always drawn in full
+    qint64 numPoints = 0;
+    auto hasPoints = false;
+    for(auto groupIt = featureGroups.cbegin(); groupIt != featureGroups.cend(); ++groupIt)
+    {
+        if(groupIt.key() == GeometryType::Point || groupIt.key() == GeometryType::Multipoint)
+            hasPoints = true;
+
+        numPoints += groupIt.value().simplifier.getNumberOfPoints();
+    }
+
+    auto simplify = !hasPoints && numPoints > maxPointsAtFullDetail;
+
     auto featureCollection = new FeatureCollection(this);
 
-    for(auto&& it : featureArray)
+    for(auto groupIt = featureGroups.begin(); groupIt != featureGroups.end(); ++groupIt)
     {
-        auto featObj = it.toObject();
-
-        auto geom = featObj["geometry"].toObject();
+        auto geometryType = groupIt.key();
+        auto& group = groupIt.value();
 
-        auto type = geom["type"].toString();
+        QList<Field> tableFields;
+        tableFields.append(Field::createText("AssetType", "NULL",4));
+        tableFields.append(Field::createText("TabName", "NULL",4));
+        tableFields.append(Field::createInteger("StyleID", "StyleID"));
 
-        FeatureCollectionTable* featureCollectionTable = nullptr;
-        if(type.compare("MultiLineString") == 0)
-            featureCollectionTable = this->getMultilineFeatureTable(geom,featObj,layerName, color);
-        else if (type.compare("MultiPolygon") == 0)
-            featureCollectionTable = this->getMultipolygonFeatureTable(geom,featObj,layerName, color);
-        else
+        for(auto it = group.numericFields.cbegin(); it != group.numericFields.cend(); ++it)
         {
-            QString msg ="Error, the import of the type of geometry "+type+" is not yet suppported for " + filePath;
-            this->errorMessage(msg);
-            delete featureCollection;
-            return nullptr;
+            if(it.value())
+                tableFields.append(Field::createDouble(it.key(), it.key()));
+            else
+                tableFields.append(Field::createText(it.key(), "NULL",4));
         }
 
-        if(featureCollectionTable == nullptr)
+        auto featureCollectionTable = new FeatureCollectionTable(tableFields, geometryType, SpatialReference::wgs84(),this);
+
+        std::vector<QMap<QString, QVariant>> attributesList;
+        attributesList.reserve(group.geometries.size());
+
+        QList<Feature*> tableFeatures;
+        tableFeatures.reserve(group.geometries.size());
+
+        for(int i = 0; i<group.geometries.size(); ++i)
         {
-            delete featureCollection;
-            return nullptr;
+            QMap<QString, QVariant> featureAttributes;
+            featureAttributes.insert("AssetType", "USER_GEOJSON");
+            featureAttributes.insert("TabName", layerName);
+            featureAttributes.insert("StyleID", group.styleIDs.at(i));
+
+            const auto& properties = group.properties.at(i);
+            for(auto it = properties.cbegin(); it != properties.cend(); ++it)
+            {
+                if(it.value().isNull() || reservedFields.contains(it.key()))
+                    continue;
+
+                if(group.numericFields.value(it.key()))
+                    featureAttributes.insert(it.key(), it.value().toDouble());
+                else
+                    featureAttributes.insert(it.key(), it.value().toString());
+            }
+
+            tableFeatures.append(featureCollectionTable->createFeature(featureAttributes, group.geometries.at(i), this));
+
+            if(simplify)
+                attributesList.push_back(std::move(featureAttributes));
         }
 
+        featureCollectionTable->addFeatures(tableFeatures);
+
+        // Lines and points without a color get one random color per layer
+        QColor defaultColor = color;
+        if(geometryType != GeometryType::Polygon && color.alpha() == 0)
+            defaultColor = QColor(rand() % 255,rand() % 255,rand() % 255);
+
+        auto createSymbol = [&](const JsonStyle& style) -> Symbol*
+        {
+            QColor featureColor = style.color.isEmpty() ? defaultColor : QColor(style.color);
+
+            if(geometryType == GeometryType::Polygon)
+                return new SimpleFillSymbol(SimpleFillSymbolStyle::Solid, featureColor, this);
+            else if(geometryType == GeometryType::Polyline)
+                return new SimpleLineSymbol(SimpleLineSymbolStyle::Solid, featureColor, style.weight, this);
+
+            return new SimpleMarkerSymbol(SimpleMarkerSymbolStyle::Circle, featureColor, 2.0*style.weight, this);
+        };
+
+        auto getLabel = [&](const JsonStyle& style)
+        {
+            return style.label.isEmpty() ? layerName : style.label;
+        };
+
+        // A table with a single style gets a simple renderer, otherwise the style of a feature is looked up from its style ID
+        auto createRenderer = [&]() -> Renderer*
+        {
+            if(group.styles.size() == 1)
+            {
+                auto simpleRenderer = new SimpleRenderer(createSymbol(group.styles.first()), this);
+                simpleRenderer->setLabel(getLabel(group.styles.first()));
+
+                return simpleRenderer;
+            }
+
+            QList<UniqueValue*> uniqueValues;
+            for(int k = 0; k<group.styles.size(); ++k)
+            {
+                auto label = getLabel(group.styles.at(k));
+                uniqueValues.append(new UniqueValue(label, label, QVariantList{k}, createSymbol(group.styles.at(k)), this));
+            }
+
+            return new UniqueValueRenderer(layerName, nullptr, QStringList{"StyleID"}, uniqueValues, this);
+        };
+
+        featureCollectionTable->setRenderer(createRenderer());
+
         featureCollection->tables()->append(featureCollectionTable);
+
+        if(simplify)
+        {
+            auto overviewName = layerName + " Overview";
+            if(featureGroups.size() > 1)
+                overviewName += geometryType == GeometryType::Polygon ? " (Polygons)" : " (Lines)";
+
+            this->createAndAddSimplifiedLayer(group.simplifier, geometryType, group.featurePaths, attributesList, tableFields, createRenderer, simplificationScale, numSimplificationLevels, overviewName, parentItem);
+        }
     }
 
     // New geo json layer
@@ -1332,6 +1826,10 @@ Esri::ArcGISRuntime::FeatureCollectionLayer* VisualizationWidget::createAndAddJs
 
     newGeojsonLayer->setAutoFetchLegendInfos(true);
 
+    // The full geometries are only drawn when zoomed in, the overview layers are drawn beyond
+    if(simplify)
+        newGeojsonLayer->setMinScale(simplificationScale);
+
     this->addLayerToMap(newGeojsonLayer,parentItem);
 
     return newGeojsonLayer;
@@ -1808,6 +2306,30 @@ Esri::ArcGISRuntime::Geometry VisualizationWidget::getPolygonGeometryFromJson(co
 }
 
 
+Esri::ArcGISRuntime::Geometry VisualizationWidget::getGeometryFromPaths(const std::vector<std::vector<double>>& paths, const GeometryType geometryType)
+{
+    if(paths.empty())
+        return Geometry();
+
+    // The paths are handed to the geometry in the Esri JSON format
+    QJsonArray jsonPaths;
+    for(auto&& path : paths)
+    {
+        QJsonArray jsonPath;
+        for(size_t i = 0; i+1<path.size(); i += 2)
+            jsonPath.append(QJsonArray{path[i], path[i+1]});
+
+        jsonPaths.append(jsonPath);
+    }
+
+    QJsonObject esriGeometry;
+    esriGeometry[geometryType == GeometryType::Polygon ? "rings" : "paths"] = jsonPaths;
+    esriGeometry["spatialReference"] = QJsonObject{{"wkid", 4326}};
+
+    return Geometry::fromJson(QString::fromUtf8(QJsonDocument(esriGeometry).toJson(QJsonDocument::Compact)));
+}
+
+
 Esri::ArcGISRuntime::Geometry VisualizationWidget::getMultilineStringGeometryFromJson(const QJsonArray& geoJson)
 {
     if(geoJson.size() == 0)
@@ -2064,149 +2586,6 @@ void VisualizationWidget::setViewElevation(double val)
 }
 
 
-Esri::ArcGISRuntime::FeatureCollectionTable* VisualizationWidget::getMultilineFeatureTable(const QJsonObject& geomObject, const QJsonObject& featObj, const QString& layerName, const QColor color)
-{
-    auto coordArray = geomObject["coordinates"].toArray();
-
-    Esri::ArcGISRuntime::Geometry featGeom = this->getMultilineStringGeometryFromJson(coordArray);
-
-    if(featGeom.isEmpty())
-    {
-        QString msg ="Error getting the feature geometry for " + layerName;
-        this->errorMessage(msg);
-        return nullptr;
-    }
-
-    auto properties = featObj["properties"].toObject();
-
-    QMap<QString, QVariant> featureAttributes;
-    featureAttributes.insert("AssetType", "USER_GEOJSON");
-    featureAttributes.insert("TabName", layerName);
-
-    auto propertiesMap = properties.toVariantMap();
-
-    featureAttributes.insert(propertiesMap);
-
-    QList<Field> tableFields;
-    tableFields.append(Field::createText("AssetType", "NULL",4));
-    tableFields.append(Field::createText("TabName", "NULL",4));
-
-    // Use the property map from the first object to populate the fields.
-    auto keys = propertiesMap.keys();
-    for(auto&& it : keys)
-        tableFields.append(Field::createText(it, "NULL",4));
-
-    auto featureCollectionTable = new FeatureCollectionTable(tableFields, GeometryType::Polyline, SpatialReference::wgs84(),this);
-
-    // Try to get the color if there is one
-    auto colorStr =  properties["color"].toString();
-
-    QColor featureColor;
-
-    if(color.alpha() == 0)
-        featureColor = QColor(rand() % 255,rand() % 255,rand() % 255);
-    else
-        featureColor = color;
-
-    if(!colorStr.isEmpty())
-        featureColor = QColor(colorStr);
-
-    auto weight = properties["weight"].toDouble(3.0);
-
-    auto legendLabel = layerName;
-
-    QVariant valueVar = properties["value"].toVariant();
-
-    if(!valueVar.toString().isEmpty())
-        legendLabel = valueVar.toString();
-    else if(properties["value"].toDouble(-1.0) == -1.0)
-        legendLabel = QString::number(valueVar.toDouble());
-
-    if(legendLabel.isEmpty())
-        legendLabel = layerName;
-
-    SimpleLineSymbol* lineSymbol = new SimpleLineSymbol(SimpleLineSymbolStyle::Solid, featureColor, weight, this);
-    SimpleRenderer* lineRenderer = new SimpleRenderer(lineSymbol, this);
-    lineRenderer->setLabel(legendLabel);
-
-    featureCollectionTable->setRenderer(lineRenderer);
-
-    auto feature = featureCollectionTable->createFeature(featureAttributes, featGeom, this);
-
-    featureCollectionTable->addFeature(feature);
-
-    return featureCollectionTable;
-}
-
-
-Esri::ArcGISRuntime::FeatureCollectionTable* VisualizationWidget::getMultipolygonFeatureTable(const QJsonObject& geomObject, const QJsonObject& featObj, const QString& layerName, const QColor color)
-{
-    auto coordArray = geomObject["coordinates"].toArray();
-
-    Esri::ArcGISRuntime::Geometry featGeom = this->getMultiPolygonGeometryFromJson(coordArray);
-
-    if(featGeom.isEmpty())
-    {
-        QString msg ="Error getting the feature geometry for " + layerName;
-        this->errorMessage(msg);
-        return nullptr;
-    }
-
-    auto properties = featObj["properties"].toObject();
-
-    QMap<QString, QVariant> featureAttributes;
-    featureAttributes.insert("AssetType", "USER_GEOJSON");
-    featureAttributes.insert("TabName", layerName);
-
-    auto propertiesMap = properties.toVariantMap();
-
-    featureAttributes.insert(propertiesMap);
-
-    QList<Field> tableFields;
-    tableFields.append(Field::createText("AssetType", "NULL",4));
-    tableFields.append(Field::createText("TabName", "NULL",4));
-
-    // Use the property map from the first object to populate the fields.
-    auto keys = propertiesMap.keys();
-    for(auto&& it : keys)
-        tableFields.append(Field::createText(it, "NULL",4));
-
-    auto featureCollectionTable = new FeatureCollectionTable(tableFields, GeometryType::Polygon, SpatialReference::wgs84(),this);
-
-    // Try to get the color if there is one
-    auto colorStr =  properties["color"].toString();
-
-    // Black color by default
-    QColor featureColor = color;
-
-    if(!colorStr.isEmpty())
-        featureColor = QColor(colorStr);
-
-    auto legendLabel = layerName;
-
-    QVariant valueVar = properties["value"].toVariant();
-
-    if(!valueVar.toString().isEmpty())
-        legendLabel = valueVar.toString();
-    else if(properties["value"].toDouble(-1.0) == -1.0)
-        legendLabel = QString::number(valueVar.toDouble());
-
-    if(legendLabel.isEmpty())
-        legendLabel = layerName;
-
-    SimpleFillSymbol* lineSymbol = new SimpleFillSymbol(SimpleFillSymbolStyle::Solid, featureColor, this);
-    SimpleRenderer* lineRenderer = new SimpleRenderer(lineSymbol, this);
-    lineRenderer->setLabel(legendLabel);
-
-    featureCollectionTable->setRenderer(lineRenderer);
-
-    auto feature = featureCollectionTable->createFeature(featureAttributes, featGeom, this);
-
-    featureCollectionTable->addFeature(feature);
-
-    return featureCollectionTable;
-}
-
 //     connect to the mouse clicked signal on the MapQuickView
 //     This code snippet adds a point to where the mouse click is
 //        connect(mapViewWidget, &MapGraphicsView::mouseClicked, this, [this](QMouseEvent& mouseEvent)
@@ -46,6 +46,10 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QMap>
 #include <QObject>
 #include <QUuid>
+#include <QVector>
+
+#include <functional>
+#include <vector>
 
 namespace Esri
 {
@@ -65,22 +69,30 @@ class IdentifyLayerResult;
 class FeatureQueryResult;
 class ClassBreaksRenderer;
 class SimpleRenderer;
+class Renderer;
+class Field;
 class GroupLayer;
 class KmlLayer;
 class Layer;
 class Point;
 enum class LoadStatus;
+enum class GeometryType;
 class ArcGISMapImageLayer;
 class RasterLayer;
 }
 }
 
+class ComponentAggregator;
+class ComponentDatabase;
 class ConvexHull;
+class GeometrySimplifier;
 class PolygonBoundary;
 class ComponentInputWidget;
 class LayerTreeView;
 class LayerTreeItem;
 class SimCenterMapGraphicsView;
+
+struct RTreeEnvelope;
 class TreeModel;
 
 class QGroupBox;
@@ -107,6 +119,7 @@ public:
     // Add component to 'selected layer'
     LayerTreeItem* addSelectedFeatureLayerToMap(Esri::ArcGISRuntime::Layer* featLayer);
 
+    // Streams the features of a GeoJSON file into a layer, with one table for each type of geometry
     Esri::ArcGISRuntime::FeatureCollectionLayer* createAndAddJsonLayer(const QString& filePath, const QString& layerName, LayerTreeItem* parentItem, QColor color = QColor(0,0,0,0));
 
     // Adds a raster layer to the map
@@ -124,6 +137,16 @@ public:
     // Create a layer from a map server URL
     Esri::ArcGISRuntime::ArcGISMapImageLayer* createAndAddMapServerLayer(const QString& url, const QString& layerName, LayerTreeItem* parentItem);
 
+    // Bins the components of the aggregator into cells and adds one layer per level of detail under a new group layer
+    // Level k is shown from a map scale of minScale*4^k to minScale*4^(k+1), with cells of about 24 pixels on the screen, and the last level is shown at all of the scales beyond
+    // Each layer has one feature table, colored by class breaks over the given field that can be edited in the layer manager like any other class breaks renderer
+    Esri::ArcGISRuntime::GroupLayer* createAndAddAggregationLayer(const ComponentAggregator& aggregator, const double minScale, const int numLevels, const QString& rendererField, const QString& layerName, LayerTreeItem* parentItem = nullptr, Esri::ArcGISRuntime::GroupLayer* parentLayer = nullptr);
+
+    // Simplifies the paths of the simplifier and adds one layer per level of detail under a new group layer, the full geometries are meant to be shown at the scales above detailScale
+    // Level k is shown from a map scale of detailScale*4^k to detailScale*4^(k+1), with a tolerance of half a pixel at the start of its range, and the last level is shown at all of the scales beyond
+    // Feature i is made of the paths featurePaths[i] to featurePaths[i+1] and gets the attributes at i, features whose paths all collapse at a level are left out of it
+    Esri::ArcGISRuntime::GroupLayer* createAndAddSimplifiedLayer(GeometrySimplifier& simplifier, const Esri::ArcGISRuntime::GeometryType geometryType, const std::vector<int>& featurePaths, const std::vector<QMap<QString, QVariant>>& featureAttributes, const QList<Esri::ArcGISRuntime::Field>& fields, const std::function<Esri::ArcGISRuntime::Renderer*(void)>& createRenderer, const double detailScale, const int numLevels, const QString& layerName, LayerTreeItem* parentItem = nullptr, Esri::ArcGISRuntime::GroupLayer* parentLayer = nullptr);
+
     Esri::ArcGISRuntime::Layer* getLayer(const QString& layerID);
 
     // Get the visualization widget
@@ -168,19 +191,20 @@ public:
     QList<Esri::ArcGISRuntime::Feature *> getSelectedFeaturesList() const;
 
     // Returns a rectangular geometry item of dimensions x and y around a center point
-    Esri::ArcGISRuntime::Geometry getRectGeometryFromPoint(const Esri::ArcGISRuntime::Point& pnt, const double sizeX, double sizeY = 0);
+    // The geometry functions that are static do not use the map, they can be called from a worker thread
+    static Esri::ArcGISRuntime::Geometry getRectGeometryFromPoint(const Esri::ArcGISRuntime::Point& pnt, const double sizeX, double sizeY = 0);
 
     // Returns a geometry from the geojson format
-    Esri::ArcGISRuntime::Geometry getPolygonGeometryFromJson(const QString& geoJson);
-    Esri::ArcGISRuntime::Geometry getPolygonGeometryFromJson(const QJsonArray& geoJson);
+    static Esri::ArcGISRuntime::Geometry getPolygonGeometryFromJson(const QString& geoJson);
+    static Esri::ArcGISRuntime::Geometry getPolygonGeometryFromJson(const QJsonArray& geoJson);
+
+    // Returns a line or a polygon made of the longitude and latitude pairs of each path
+    static Esri::ArcGISRuntime::Geometry getGeometryFromPaths(const std::vector<std::vector<double>>& paths, const Esri::ArcGISRuntime::GeometryType geometryType);
 
     Esri::ArcGISRuntime::Geometry getMultilineStringGeometryFromJson(const QString& geoJson);
     Esri::ArcGISRuntime::Geometry getMultilineStringGeometryFromJson(const QJsonArray& geoJson);
     Esri::ArcGISRuntime::Geometry getMultiPolygonGeometryFromJson(const QJsonArray& geoJson);
 
-    Esri::ArcGISRuntime::FeatureCollectionTable* getMultilineFeatureTable(const QJsonObject& geomObject, const QJsonObject& featObj, const QString& layerName, const QColor color);
-    Esri::ArcGISRuntime::FeatureCollectionTable* getMultipolygonFeatureTable(const QJsonObject& geomObject, const QJsonObject& featObj, const QString& layerName, const QColor color);
-
     // Programatically set the visibility of a layer
     void setLayerVisibility(const QString& layerID, const bool val);
 
@@ -190,6 +214,13 @@ public:
     // Returns the tool to select a polygon boundary
     PolygonBoundary* getThePolygonBoundaryTool(void) const;
 
+    // Selects the assets whose geometry lies within the polygon, given in longitude and latitude, using the spatial index of each asset database
+    // Returns false if no asset selection was started, e.g., when the polygon tool is selecting other items
+    bool selectComponentsInPolygon(const QVector<QPointF>& polygon);
+
+    // Selects the assets whose geometry intersects the rectangle, given in longitude and latitude
+    bool selectComponentsInEnvelope(const RTreeEnvelope& envelope);
+
     // Get the list of features saved from the latest query
     QList<Esri::ArcGISRuntime::FeatureQueryResult *> getFeaturesFromQueryList() const;
 
@@ -234,7 +265,7 @@ private slots:
     // Asset selection
     void handleSelectAreaMap(void);
     void handleClearSelectAreaMap(void);
-    void handleSelectFeaturesForAnalysis(void);
+    void handleApplySelectAreaMap(void);
 
 private:
 
@@ -245,6 +276,9 @@ private:
 
     QComboBox* baseMapCombo;
 
+    // The shape used to select assets on the map, i.e., a polygon, the convex hull of the points, a rectangle, or a radius around a point
+    QComboBox* selectionShapeCombo;
+
     // This function runs a query on all features in a table
     // It returns the all of the features in the table where the text in the field "FieldName" matches the search text
     void runFieldQuery(const QString& fieldName, const QString& searchText);
@@ -264,6 +298,14 @@ private:
 
     Esri::ArcGISRuntime::ClassBreaksRenderer* createPointRenderer(void);
 
+    // GeoJSON layers of lines and polygons with more points than this are drawn simplified when zoomed out past the simplification scale
+    static const int maxPointsAtFullDetail = 200000;
+    static constexpr double simplificationScale = 25000.0;
+    static const int numSimplificationLevels = 4;
+
+    // Five class breaks at the quantiles of the values
+    Esri::ArcGISRuntime::ClassBreaksRenderer* createAggregationRenderer(const QString& field, std::vector<double> values);
+
     Esri::ArcGISRuntime::GroupLayer* selectedObjectsLayer = nullptr;
     LayerTreeItem* selectedObjectsTreeItem = nullptr;
 
@@ -279,6 +321,12 @@ private:
 
     std::unique_ptr<ConvexHull> theConvexHullTool;
     std::unique_ptr<PolygonBoundary> thePolygonBoundaryTool;
+
+    // True while the polygon or the convex hull tool is selecting assets for the analysis
+    bool selectingComponentsInArea = false;
+
+    // Runs the query on the spatial index of each asset database and selects the assets that are returned
+    bool selectComponents(const std::function<std::vector<qint64>(const ComponentDatabase*)>& query);
 };
 
 #endif // VISUALIZATIONWIDGET_H
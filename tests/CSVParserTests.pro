@@ -0,0 +1,58 @@
+#*****************************************************************************
+# Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice, this
+#    list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# The views and conclusions contained in the software and documentation are those
+# of the authors and should not be interpreted as representing official policies,
+# either expressed or implied, of the FreeBSD Project.
+#
+# REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+# THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+# THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+# PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+# UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+#
+#***************************************************************************
+
+# Written by: Stevan Gavrilovic
+
+# Randomized equivalence tests and microbenchmarks of the CSV scanner and tokenizer against the line parser they replaced
+# Build and run with: qmake CSVParserTests.pro && make check
+# Run only the benchmarks in release mode with, e.g.: ./TestCSVParser benchmarkTokenizer benchmarkLegacyParser
+
+QT += core testlib
+QT -= gui
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+TARGET = TestCSVParser
+TEMPLATE = app
+
+# Full optimization on release
+QMAKE_CXXFLAGS_RELEASE += -O3
+
+INCLUDEPATH += $$PWD/../TOOLS
+
+SOURCES +=  TestCSVParser.cpp             LegacyCSVParser.cpp             ../TOOLS/CSVScanner.cpp             ../TOOLS/CSVTokenizer.cpp 
+HEADERS +=  LegacyCSVParser.h             ../TOOLS/CSVScanner.h             ../TOOLS/CSVTokenizer.h 
\ No newline at end of file
@@ -0,0 +1,150 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "LegacyCSVParser.h"
+
+#include <QByteArray>
+
+QVector<QStringList> LegacyCSVParser::parseCSVData(const QByteArray& data)
+{
+    QVector<QStringList> returnVec;
+
+    QStringList rowLines;
+    int pos = 0;
+    while (pos < data.size())
+    {
+        auto end = data.indexOf('\n', pos);
+        end = end == -1 ? data.size() : end + 1;
+
+        QString line = QString::fromUtf8(data.constData() + pos, end - pos);
+
+        rowLines << line;
+
+        pos = end;
+    }
+
+    returnVec.reserve(rowLines.size());
+
+    for(auto&& it: rowLines)
+    {
+        auto lineStr = this->parseLineCSV(it);
+
+        returnVec.push_back(lineStr);
+    }
+
+    return returnVec;
+}
+
+
+QStringList LegacyCSVParser::parseLineCSV(const QString &csvString)
+{
+    QStringList fields;
+    QString value;
+
+    bool hasQuote = false;
+
+    for (int i = 0; i < csvString.size(); ++i)
+    {
+        const QChar current = csvString.at(i);
+
+        // Normal state
+        if (hasQuote == false)
+        {
+            // Comma
+            if (current == ',')
+            {
+                // Save field
+                fields.append(value.trimmed());
+                value.clear();
+            }
+
+            // Double-quote
+            else if (current == '"')
+            {
+                hasQuote = true;
+                value += current;
+            }
+
+            // Other character
+            else
+                value += current;
+        }
+        else if (hasQuote)
+        {
+            // Check for another double-quote
+            if (current == '"')
+            {
+                if (i < csvString.size())
+                {
+                    // A double double-quote?
+                    if (i+1 < csvString.size() && csvString.at(i+1) == '"')
+                    {
+                        value += '"';
+
+                        // Skip a second quote character in a row
+                        i++;
+                    }
+                    else
+                    {
+                        hasQuote = false;
+                        value += '"';
+                    }
+                }
+            }
+
+            // Other character
+            else
+                value += current;
+        }
+    }
+
+    if (!value.isEmpty())
+        fields.append(value.trimmed());
+
+
+    // Remove quotes and whitespace around quotes
+    for (int i=0; i<fields.size(); ++i)
+        if (fields[i].length()>=1 && fields[i].left(1)=='"')
+        {
+            fields[i]=fields[i].mid(1);
+            if (fields[i].length()>=1 && fields[i].right(1)=='"')
+                fields[i]=fields[i].left(fields[i].length()-1);
+        }
+
+    return fields;
+}
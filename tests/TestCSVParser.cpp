@@ -0,0 +1,540 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "CSVScanner.h"
+#include "CSVTokenizer.h"
+#include "LegacyCSVParser.h"
+
+#include <QByteArray>
+#include <QStringList>
+#include <QVector>
+#include <QtTest>
+
+#include <algorithm>
+#include <random>
+
+// Randomized equivalence tests of the CSVScanner and CSVTokenizer against the line parser they replaced, and microbenchmarks of both on inventory-like and quote-heavy input
+class TestCSVParser : public QObject
+{
+    Q_OBJECT
+
+private slots:
+
+    void initTestCase();
+
+    void scanBlockMatchesScalar();
+    void prefixXorMatchesScalar();
+
+    void tokenizerMatchesLegacyParser_data();
+    void tokenizerMatchesLegacyParser();
+
+    void randomizedEquivalence();
+    void streamedRowsMatchWholeBuffer();
+
+    void benchmarkLegacyParser_data();
+    void benchmarkLegacyParser();
+
+    void benchmarkTokenizer_data();
+    void benchmarkTokenizer();
+
+    void benchmarkTokenizerIndexOnly_data();
+    void benchmarkTokenizerIndexOnly();
+
+private:
+
+    // Tokenizes all of the rows in the buffer and creates the strings of the fields
+    QVector<QStringList> tokenize(const char* data, const qint64 size);
+
+    // Splits the data into records on the newlines that are not in a quoted section and parses each record with the legacy line parser
+    // This is the legacy parser with the quoted newline handling of the tokenizer
+    QVector<QStringList> parseRecords(const QByteArray& data);
+
+    // Returns true if a newline is within a quoted section, which the legacy parser splits into two rows
+    bool hasQuotedNewline(const QByteArray& data);
+
+    // Random data from an alphabet of the characters that affect the parsing
+    QByteArray randomCSV(std::mt19937& rng);
+
+    // Rows like those of a building inventory, with a quoted footprint
+    QByteArray inventoryCSV(const int numRows);
+
+    // Rows where every field is quoted and contains commas and escaped double-quotes
+    QByteArray quotedCSV(const int numRows);
+
+    void addBenchmarkData(void);
+
+    // Printable version of the input for the failure messages
+    QByteArray escaped(const QByteArray& data);
+
+    const int numBenchmarkRows = 20000;
+};
+
+
+void TestCSVParser::initTestCase()
+{
+    qInfo() << "CSVScanner instruction set:" << CSVScanner::instructionSet();
+}
+
+
+void TestCSVParser::scanBlockMatchesScalar()
+{
+    std::mt19937 rng(12345);
+
+    // Mostly the special characters, with the remainder from all byte values including those with the top bit set
+    const char special[] = {'"', ',', '\n', '\r', ' ', 'a'};
+
+    char block[CSVScanner::blockSize];
+
+    for(int test = 0; test < 100000; ++test)
+    {
+        for(int i = 0; i < CSVScanner::blockSize; ++i)
+        {
+            if(rng() % 4 == 0)
+                block[i] = static_cast<char>(rng() % 256);
+            else
+                block[i] = special[rng() % sizeof(special)];
+        }
+
+        CSVBlockMasks masks;
+        CSVScanner::scanBlock(block, masks);
+
+        CSVBlockMasks expected = {0, 0, 0};
+        for(int i = 0; i < CSVScanner::blockSize; ++i)
+        {
+            const quint64 bit = quint64(1) << i;
+
+            if(block[i] == '"')
+                expected.quotes |= bit;
+            else if(block[i] == ',')
+                expected.commas |= bit;
+            else if(block[i] == '\n')
+                expected.newlines |= bit;
+        }
+
+        QCOMPARE(masks.quotes, expected.quotes);
+        QCOMPARE(masks.commas, expected.commas);
+        QCOMPARE(masks.newlines, expected.newlines);
+    }
+}
+
+
+void TestCSVParser::prefixXorMatchesScalar()
+{
+    std::mt19937_64 rng(12345);
+
+    for(int test = 0; test < 100000; ++test)
+    {
+        const quint64 mask = rng() & rng();
+
+        quint64 expected = 0;
+        bool parity = false;
+        for(int i = 0; i < 64; ++i)
+        {
+            if((mask >> i) & 1)
+                parity = !parity;
+
+            if(parity)
+                expected |= quint64(1) << i;
+        }
+
+        QCOMPARE(CSVScanner::prefixXor(mask), expected);
+
+        if(mask != 0)
+            QCOMPARE((mask >> CSVScanner::lowestBit(mask)) & 1, quint64(1));
+    }
+}
+
+
+void TestCSVParser::tokenizerMatchesLegacyParser_data()
+{
+    QTest::addColumn<QByteArray>("csv");
+
+    QTest::newRow("inventory") << this->inventoryCSV(1000);
+    QTest::newRow("quoted") << this->quotedCSV(1000);
+    QTest::newRow("no trailing newline") << this->inventoryCSV(10).chopped(1);
+    QTest::newRow("trailing comma") << QByteArray("a,b,\nc,d,");
+    QTest::newRow("crlf") << QByteArray("ID,Name\r\n1,\" A \"\r\n2,\"B,\"\"C\"\"\"\r\n");
+    QTest::newRow("empty lines") << QByteArray("\n\na,b\n\n");
+}
+
+
+void TestCSVParser::tokenizerMatchesLegacyParser()
+{
+    QFETCH(QByteArray, csv);
+
+    LegacyCSVParser parser;
+
+    QVERIFY2(this->tokenize(csv.constData(), csv.size()) == parser.parseCSVData(csv), this->escaped(csv).constData());
+}
+
+
+void TestCSVParser::randomizedEquivalence()
+{
+    std::mt19937 rng(12345);
+
+    LegacyCSVParser parser;
+
+    int numLegacyChecks = 0;
+
+    for(int test = 0; test < 20000; ++test)
+    {
+        const auto csv = this->randomCSV(rng);
+
+        // Place the data at a random alignment so that the block boundaries fall at different positions in the data
+        const int offset = static_cast<int>(rng() % CSVScanner::blockSize);
+        const QByteArray buffer = QByteArray(offset, 'x') + csv;
+
+        const auto rows = this->tokenize(buffer.constData() + offset, csv.size());
+
+        QVERIFY2(rows == this->parseRecords(csv), this->escaped(csv).constData());
+
+        // Without quoted newlines the result must be identical to the legacy parser
+        if(!this->hasQuotedNewline(csv))
+        {
+            QVERIFY2(rows == parser.parseCSVData(csv), this->escaped(csv).constData());
+            ++numLegacyChecks;
+        }
+    }
+
+    QVERIFY(numLegacyChecks > 1000);
+}
+
+
+void TestCSVParser::streamedRowsMatchWholeBuffer()
+{
+    std::mt19937 rng(12345);
+
+    for(int test = 0; test < 2000; ++test)
+    {
+        QByteArray csv;
+        if(test % 2 == 0)
+            csv = this->randomCSV(rng);
+        else
+            csv = this->inventoryCSV(1 + static_cast<int>(rng() % 20));
+
+        // Append the data to the buffer in random sized chunks and hand off the complete rows, as CSVReaderWriter::parseCSVStream does
+        QVector<QStringList> rows;
+        std::vector<quint32> fieldOffsets;
+        QByteArray buffer;
+        int numRead = 0;
+        bool atEnd = false;
+
+        while(!atEnd)
+        {
+            const int chunkSize = std::min(static_cast<int>(rng() % 200), csv.size() - numRead);
+            buffer.append(csv.constData() + numRead, chunkSize);
+            numRead += chunkSize;
+            atEnd = numRead == csv.size();
+
+            qint64 pos = 0;
+            while(true)
+            {
+                fieldOffsets.clear();
+
+                auto rowStart = pos;
+                qint64 rowEnd = 0;
+
+                if(!CSVTokenizer::nextRow(buffer.constData(), buffer.size(), pos, atEnd, fieldOffsets, rowEnd))
+                    break;
+
+                CSVRow row(buffer.constData(), rowStart, rowEnd, fieldOffsets.data(), static_cast<int>(fieldOffsets.size()));
+                rows.push_back(row.toStringList());
+            }
+
+            buffer.remove(0, static_cast<int>(pos));
+        }
+
+        QVERIFY2(rows == this->tokenize(csv.constData(), csv.size()), this->escaped(csv).constData());
+    }
+}
+
+
+void TestCSVParser::benchmarkLegacyParser_data()
+{
+    this->addBenchmarkData();
+}
+
+
+void TestCSVParser::benchmarkLegacyParser()
+{
+    QFETCH(QByteArray, csv);
+
+    LegacyCSVParser parser;
+
+    QBENCHMARK
+    {
+        auto rows = parser.parseCSVData(csv);
+        QCOMPARE(rows.size(), numBenchmarkRows + 1);
+    }
+}
+
+
+void TestCSVParser::benchmarkTokenizer_data()
+{
+    this->addBenchmarkData();
+}
+
+
+void TestCSVParser::benchmarkTokenizer()
+{
+    QFETCH(QByteArray, csv);
+
+    QBENCHMARK
+    {
+        auto rows = this->tokenize(csv.constData(), csv.size());
+        QCOMPARE(rows.size(), numBenchmarkRows + 1);
+    }
+}
+
+
+void TestCSVParser::benchmarkTokenizerIndexOnly_data()
+{
+    this->addBenchmarkData();
+}
+
+
+void TestCSVParser::benchmarkTokenizerIndexOnly()
+{
+    QFETCH(QByteArray, csv);
+
+    // Only find the rows and fields without creating any strings, as MappedCSVFile does when it builds its index
+    std::vector<quint32> fieldOffsets;
+    fieldOffsets.reserve(static_cast<size_t>(numBenchmarkRows) * 16);
+
+    QBENCHMARK
+    {
+        fieldOffsets.clear();
+
+        int numRows = 0;
+        qint64 pos = 0;
+        qint64 rowEnd = 0;
+        while(CSVTokenizer::nextRow(csv.constData(), csv.size(), pos, true, fieldOffsets, rowEnd))
+            ++numRows;
+
+        QCOMPARE(numRows, numBenchmarkRows + 1);
+    }
+}
+
+
+QVector<QStringList> TestCSVParser::tokenize(const char* data, const qint64 size)
+{
+    QVector<QStringList> rows;
+    std::vector<quint32> fieldOffsets;
+
+    qint64 pos = 0;
+    while(true)
+    {
+        fieldOffsets.clear();
+
+        auto rowStart = pos;
+        qint64 rowEnd = 0;
+
+        if(!CSVTokenizer::nextRow(data, size, pos, true, fieldOffsets, rowEnd))
+            break;
+
+        CSVRow row(data, rowStart, rowEnd, fieldOffsets.data(), static_cast<int>(fieldOffsets.size()));
+        rows.push_back(row.toStringList());
+    }
+
+    return rows;
+}
+
+
+QVector<QStringList> TestCSVParser::parseRecords(const QByteArray& data)
+{
+    LegacyCSVParser parser;
+
+    QVector<QStringList> rows;
+
+    bool inQuotes = false;
+    int recordStart = 0;
+    for(int i = 0; i < data.size(); ++i)
+    {
+        if(data[i] == '"')
+            inQuotes = !inQuotes;
+        else if(data[i] == '\n' && !inQuotes)
+        {
+            rows.push_back(parser.parseLineCSV(QString::fromUtf8(data.constData() + recordStart, i + 1 - recordStart)));
+            recordStart = i + 1;
+        }
+    }
+
+    if(recordStart < data.size())
+        rows.push_back(parser.parseLineCSV(QString::fromUtf8(data.constData() + recordStart, data.size() - recordStart)));
+
+    return rows;
+}
+
+
+bool TestCSVParser::hasQuotedNewline(const QByteArray& data)
+{
+    bool inQuotes = false;
+    for(auto&& it : data)
+    {
+        if(it == '"')
+            inQuotes = !inQuotes;
+        else if(it == '\n' && inQuotes)
+            return true;
+    }
+
+    return false;
+}
+
+
+QByteArray TestCSVParser::randomCSV(std::mt19937& rng)
+{
+    // Includes a multi-byte UTF-8 character and whitespace that is trimmed from the fields
+    static const char* pieces[] = {"a", "b", "1", ".", " ", "\t", ",", ",", "\"", "\"\"", "\n", "\r\n", "\r", "\xC3\xA9"};
+    static const int numPieces = sizeof(pieces) / sizeof(pieces[0]);
+
+    // Up to a few blocks, so that rows cross the block boundaries and the scalar tail
+    const int length = static_cast<int>(rng() % 300);
+
+    QByteArray csv;
+    for(int i = 0; i < length; ++i)
+        csv.append(pieces[rng() % numPieces]);
+
+    return csv;
+}
+
+
+QByteArray TestCSVParser::inventoryCSV(const int numRows)
+{
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    static const char* occupancies[] = {"RES1", "RES3", "COM1", "IND2"};
+    static const char* structureTypes[] = {"W1", "C1", "S2", "URM"};
+
+    QByteArray csv("ID,Latitude,Longitude,OccupancyClass,StructureType,YearBuilt,NumberOfStories,PlanArea,ReplacementCost,Footprint\n");
+
+    for(int i = 0; i < numRows; ++i)
+    {
+        const double lat = 37.8 + 0.1 * unit(rng);
+        const double lon = -122.3 + 0.1 * unit(rng);
+
+        csv += QByteArray::number(i + 1) + ',';
+        csv += QByteArray::number(lat, 'f', 6) + ',';
+        csv += QByteArray::number(lon, 'f', 6) + ',';
+        csv += QByteArray(occupancies[rng() % 4]) + ',';
+        csv += QByteArray(structureTypes[rng() % 4]) + ',';
+        csv += QByteArray::number(1900 + static_cast<int>(rng() % 120)) + ',';
+        csv += QByteArray::number(1 + static_cast<int>(rng() % 10)) + ',';
+        csv += QByteArray::number(100.0 + 1000.0 * unit(rng), 'f', 2) + ',';
+        csv += QByteArray::number(1.0e5 + 1.0e6 * unit(rng), 'f', 2) + ',';
+
+        // The footprint polygon is quoted because of its commas
+        csv += "\"[";
+        for(int j = 0; j < 5; ++j)
+        {
+            if(j > 0)
+                csv += ',';
+
+            csv += '[' + QByteArray::number(lon + 0.0001 * j, 'f', 7) + ',' + QByteArray::number(lat + 0.0001 * j, 'f', 7) + ']';
+        }
+        csv += "]\"\n";
+    }
+
+    return csv;
+}
+
+
+QByteArray TestCSVParser::quotedCSV(const int numRows)
+{
+    std::mt19937 rng(12345);
+
+    const int numFields = 8;
+
+    QByteArray csv;
+    for(int j = 0; j < numFields; ++j)
+    {
+        if(j > 0)
+            csv += ',';
+
+        csv += "\"Field " + QByteArray::number(j) + '"';
+    }
+    csv += '\n';
+
+    for(int i = 0; i < numRows; ++i)
+    {
+        for(int j = 0; j < numFields; ++j)
+        {
+            if(j > 0)
+                csv += ',';
+
+            csv += " \"Name \"\"" + QByteArray::number(static_cast<int>(rng() % 1000)) + "\"\", Unit " + QByteArray::number(i) + ", \"\"A, B\"\"\" ";
+        }
+        csv += '\n';
+    }
+
+    return csv;
+}
+
+
+void TestCSVParser::addBenchmarkData(void)
+{
+    QTest::addColumn<QByteArray>("csv");
+
+    QTest::newRow("inventory") << this->inventoryCSV(numBenchmarkRows);
+    QTest::newRow("quoted") << this->quotedCSV(numBenchmarkRows);
+}
+
+
+QByteArray TestCSVParser::escaped(const QByteArray& data)
+{
+    QByteArray result("Input: ");
+
+    for(auto&& it : data)
+    {
+        if(it == '\n')
+            result += "\\n";
+        else if(it == '\r')
+            result += "\\r";
+        else if(it == '\t')
+            result += "\\t";
+        else
+            result += it;
+    }
+
+    return result;
+}
+
+
+QTEST_APPLESS_MAIN(TestCSVParser)
+
+#include "TestCSVParser.moc"